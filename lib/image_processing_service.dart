@@ -3,14 +3,15 @@
 // ==============================================================================
 //
 // KEY OPTIMIZATIONS:
-// 1. All heavy work runs in Isolate (non-blocking)
-// 2. Progress streaming for responsive UI
+// 1. All heavy work runs in a pool of Isolates (non-blocking, parallel)
+// 2. Real stage/tile progress streamed from the engine, with ETA
 // 3. Proper cleanup and disposal
 // 4. Async file operations
 // ==============================================================================
 
 import 'dart:async';
 import 'dart:io';
+import 'dart:ui' as ui;
 
 import 'package:flutter/services.dart' show rootBundle;
 import 'package:path/path.dart' as p;
@@ -39,7 +40,10 @@ class ProcessingProgress {
   final String message;
   final ProcessingState state;
 
-  ProcessingProgress(this.progress, this.message, this.state);
+  /// Estimated time remaining, once enough of the request has run.
+  final Duration? eta;
+
+  ProcessingProgress(this.progress, this.message, this.state, {this.eta});
 }
 
 // ==============================================================================
@@ -47,7 +51,7 @@ class ProcessingProgress {
 // ==============================================================================
 
 class ImageProcessingService {
-  NativeEngine? _engine;
+  NativeEnginePool? _engine;
   ProcessingState _state = ProcessingState.idle;
   String? _lastError;
 
@@ -60,13 +64,39 @@ class ImageProcessingService {
   String? get lastError => _lastError;
   String get engineVersion => _engine?.version ?? 'not initialized';
 
-  void _emit(double progress, String message, ProcessingState state) {
+  void _emit(double progress, String message, ProcessingState state, {Duration? eta}) {
     _state = state;
     if (!_progressController.isClosed) {
-      _progressController.add(ProcessingProgress(progress, message, state));
+      _progressController.add(ProcessingProgress(progress, message, state, eta: eta));
     }
   }
 
+  /// Turn engine events into monotonic progress with a linear ETA.
+  void Function(EngineProgress) _progressReporter(Stopwatch clock) {
+    var best = 0.0;
+    return (event) {
+      final fraction = event.fraction;
+      // Tile events arrive from several threads and may be reordered
+      if (fraction <= best) return;
+      best = fraction;
+
+      Duration? eta;
+      if (fraction >= 0.05) {
+        final elapsed = clock.elapsedMicroseconds;
+        eta = Duration(microseconds: (elapsed * (1 - fraction) / fraction).round());
+      }
+      _emit(fraction, _stageMessages[event.stageName] ?? 'Processing image...',
+          ProcessingState.processing, eta: eta);
+    };
+  }
+
+  static const _stageMessages = {
+    'decode': 'Decoding...',
+    'filter': 'Enhancing...',
+    'overlay': 'Annotating...',
+    'encode': 'Saving...',
+  };
+
   /// Initialize the service.
   /// Runs in background - does NOT block UI.
   Future<void> initialize({String? pythonHome}) async {
@@ -85,7 +115,7 @@ class ImageProcessingService {
       final assetsPath = p.dirname(libraryPath);
 
       _emit(0.6, 'Starting Python engine...', ProcessingState.initializing);
-      _engine = NativeEngine();
+      _engine = NativeEnginePool();
       await _engine!.initialize(
         libraryPath: libraryPath,
         pythonHome: pythonHome,
@@ -124,9 +154,11 @@ class ImageProcessingService {
 
   /// Process an image.
   /// Runs in background isolate - does NOT block UI!
+  /// [siblings] requests downscaled copies by name (see [ProcessingResult.siblings]).
   Future<ProcessingResult> processImage({
     required String inputPath,
     String? outputDir,
+    Map<String, int>? siblings,
   }) async {
     if (!isReady) {
       throw ImageProcessingException('Not ready');
@@ -140,10 +172,14 @@ class ImageProcessingService {
     _emit(0.0, 'Starting...', ProcessingState.processing);
 
     try {
-      _emit(0.3, 'Processing image...', ProcessingState.processing);
-
       // This runs in a separate Isolate - UI stays responsive!
-      final result = await _engine!.processImage(inputPath, outputDir: outputDir);
+      // Progress comes from the engine as stages and tiles complete.
+      final result = await _engine!.processImage(
+        inputPath,
+        outputDir: outputDir,
+        siblings: siblings,
+        onProgress: _progressReporter(Stopwatch()..start()),
+      );
 
       if (result.success) {
         _emit(1.0, 'Complete!', ProcessingState.completed);
@@ -167,6 +203,103 @@ class ImageProcessingService {
     }
   }
 
+  /// Process an image and decode the engine's output pixels directly into a
+  /// [ui.Image]: the pixels are viewed in engine memory (no FFI copy) and no
+  /// PNG has to be written and read back unless [writeFile] is set.
+  Future<(ProcessingResult, ui.Image)> processImageToImage({
+    required String inputPath,
+    String? outputDir,
+    bool writeFile = false,
+  }) async {
+    if (!isReady) {
+      throw ImageProcessingException('Not ready');
+    }
+
+    if (!await File(inputPath).exists()) {
+      throw ImageProcessingException('File not found: $inputPath');
+    }
+
+    _lastError = null;
+    _emit(0.0, 'Starting...', ProcessingState.processing);
+
+    try {
+      final processed = await _engine!.processImagePixels(
+        inputPath,
+        outputDir: outputDir,
+        writeFile: writeFile,
+        onProgress: _progressReporter(Stopwatch()..start()),
+      );
+
+      final completer = Completer<ui.Image>();
+      ui.decodeImageFromPixels(
+        processed.pixels,
+        processed.width,
+        processed.height,
+        ui.PixelFormat.rgba8888,
+        completer.complete,
+        rowBytes: processed.rowBytes,
+      );
+      final image = await completer.future;
+
+      _emit(1.0, 'Complete!', ProcessingState.completed);
+      Future.delayed(const Duration(milliseconds: 500), () {
+        if (_state == ProcessingState.completed) {
+          _emit(0.0, 'Ready', ProcessingState.ready);
+        }
+      });
+
+      return (processed.result, image);
+    } catch (e) {
+      _lastError = e.toString();
+      _emit(0.0, 'Error: $e', ProcessingState.error);
+      rethrow;
+    }
+  }
+
+  /// Process several images in parallel across the engine isolates.
+  /// Results come back in input order; failures are reported per image.
+  Future<List<ProcessingResult>> processImages({
+    required List<String> inputPaths,
+    String? outputDir,
+  }) async {
+    if (!isReady) {
+      throw ImageProcessingException('Not ready');
+    }
+    if (inputPaths.isEmpty) return const [];
+
+    _lastError = null;
+    _emit(0.0, 'Processing ${inputPaths.length} images...', ProcessingState.processing);
+
+    var done = 0;
+    final results = await Future.wait([
+      for (final path in inputPaths)
+        _engine!.processImage(path, outputDir: outputDir).catchError(
+          (Object e) => ProcessingResult(success: false, error: e.toString()),
+        ).then((result) {
+          done++;
+          _emit(done / inputPaths.length, 'Processed $done of ${inputPaths.length}',
+              ProcessingState.processing);
+          return result;
+        }),
+    ]);
+
+    final failed = results.where((r) => !r.success).length;
+    if (failed == 0) {
+      _emit(1.0, 'Complete!', ProcessingState.completed);
+    } else {
+      _lastError = results.firstWhere((r) => !r.success).error;
+      _emit(1.0, '$failed of ${inputPaths.length} failed', ProcessingState.error);
+    }
+
+    Future.delayed(const Duration(milliseconds: 500), () {
+      if (_state == ProcessingState.completed || _state == ProcessingState.error) {
+        _emit(0.0, 'Ready', ProcessingState.ready);
+      }
+    });
+
+    return results;
+  }
+
   /// Cleanup and dispose.
   Future<void> dispose() async {
     await _engine?.shutdown();
@@ -3,7 +3,7 @@
 // ==============================================================================
 //
 // KEY OPTIMIZATIONS:
-// 1. ResizeImage for memory-efficient display (NOT full resolution!)
+// 1. Engine-written display sibling + ResizeImage (NOT full resolution!)
 // 2. StreamBuilder for real-time progress (responsive UI)
 // 3. Proper image cache management
 // 4. No UI freezing - all heavy work in Isolate
@@ -133,14 +133,18 @@ class _ImageProcessorScreenState extends State<ImageProcessorScreen> {
     _log('⏳ Processing...');
 
     try {
-      final result = await _service.processImage(inputPath: _originalPath!);
+      // The preview box never exceeds 800px; let the engine write that size
+      final result = await _service.processImage(
+        inputPath: _originalPath!,
+        siblings: const {'display': 800},
+      );
 
       if (result.success) {
         // Evict old processed image
         if (_processedPath != null) _evictImage(_processedPath!);
 
         setState(() {
-          _processedPath = result.outputPath;
+          _processedPath = result.siblings?['display'] ?? result.outputPath;
           _processedKey = UniqueKey();
         });
 
@@ -249,6 +253,7 @@ class _ImageProcessorScreenState extends State<ImageProcessorScreen> {
         IconData icon;
         String msg;
         double progress = 0;
+        Duration? eta;
 
         if (p == null) {
           bg = const Color(0xFFEFF6FF);
@@ -258,6 +263,7 @@ class _ImageProcessorScreenState extends State<ImageProcessorScreen> {
         } else {
           progress = p.progress;
           msg = p.message;
+          eta = p.eta;
 
           switch (p.state) {
             case ProcessingState.idle:
@@ -296,7 +302,10 @@ class _ImageProcessorScreenState extends State<ImageProcessorScreen> {
                   const SizedBox(width: 8),
                   Expanded(child: Text(msg, style: TextStyle(color: fg))),
                   if (progress > 0 && progress < 1)
-                    Text('${(progress * 100).toInt()}%',
+                    Text(
+                        eta != null && eta.inSeconds > 0
+                            ? '${(progress * 100).toInt()}% · ${eta.inSeconds}s left'
+                            : '${(progress * 100).toInt()}%',
                         style: TextStyle(color: fg, fontWeight: FontWeight.bold)),
                 ],
               ),
@@ -3,16 +3,20 @@
 // ==============================================================================
 //
 // KEY OPTIMIZATIONS:
-// 1. Runs ALL FFI calls in a separate Isolate (non-blocking UI)
+// 1. Runs ALL FFI calls in background Isolates (non-blocking UI, pooled)
 // 2. Proper memory cleanup with free_string
 // 3. Path-only communication (no Base64, no raw bytes)
 // 4. Thread-safe design
+// 5. One long-lived reply port per isolate; requests matched by id
+// 6. Pixel results viewed in engine memory, released by a native finalizer
 // ==============================================================================
 
+import 'dart:async';
 import 'dart:ffi';
 import 'dart:io';
 import 'dart:convert';
 import 'dart:isolate';
+import 'dart:typed_data';
 
 import 'package:ffi/ffi.dart';
 
@@ -23,12 +27,46 @@ import 'package:ffi/ffi.dart';
 typedef _EngineInitC = Int32 Function(Pointer<Utf8>, Pointer<Utf8>);
 typedef _EngineInitDart = int Function(Pointer<Utf8>, Pointer<Utf8>);
 
+typedef _EngineInitExC = Int32 Function(Pointer<Utf8>, Pointer<Utf8>, Pointer<_EngineInitOptions>);
+typedef _EngineInitExDart = int Function(Pointer<Utf8>, Pointer<Utf8>, Pointer<_EngineInitOptions>);
+
 typedef _EngineIsInitializedC = Int32 Function();
 typedef _EngineIsInitializedDart = int Function();
 
 typedef _ProcessImageC = Pointer<Utf8> Function(Pointer<Utf8>);
 typedef _ProcessImageDart = Pointer<Utf8> Function(Pointer<Utf8>);
 
+typedef _ProgressCallbackC = Void Function(Pointer<Void>, Int32, Int32, Int32);
+typedef _ProgressCallbackPtr = Pointer<NativeFunction<_ProgressCallbackC>>;
+
+typedef _ProcessImageWithProgressC = Pointer<Utf8> Function(
+    Pointer<Utf8>, _ProgressCallbackPtr, Pointer<Void>);
+typedef _ProcessImageWithProgressDart = Pointer<Utf8> Function(
+    Pointer<Utf8>, _ProgressCallbackPtr, Pointer<Void>);
+
+typedef _ProcessImagePixelsC = Int32 Function(
+    Pointer<_EngineRequest>, Pointer<_EngineResult>, Pointer<_EngineFrame>);
+typedef _ProcessImagePixelsDart = int Function(
+    Pointer<_EngineRequest>, Pointer<_EngineResult>, Pointer<_EngineFrame>);
+
+typedef _ProcessImageBinaryC = Int32 Function(Pointer<_EngineRequest>, Pointer<_EngineResult>);
+typedef _ProcessImageBinaryDart = int Function(Pointer<_EngineRequest>, Pointer<_EngineResult>);
+
+typedef _SubmitManifestC = Int64 Function(Pointer<Utf8>, Pointer<Utf8>);
+typedef _SubmitManifestDart = int Function(Pointer<Utf8>, Pointer<Utf8>);
+
+typedef _BatchStatusC = Pointer<Utf8> Function(Int64);
+typedef _BatchStatusDart = Pointer<Utf8> Function(int);
+
+typedef _PrefetchC = Int64 Function(Pointer<Utf8>, Pointer<Utf8>);
+typedef _PrefetchDart = int Function(Pointer<Utf8>, Pointer<Utf8>);
+
+typedef _PrefetchCancelC = Int32 Function(Int64);
+typedef _PrefetchCancelDart = int Function(int);
+
+typedef _ProbeImagesC = Pointer<Utf8> Function(Pointer<Utf8>);
+typedef _ProbeImagesDart = Pointer<Utf8> Function(Pointer<Utf8>);
+
 typedef _FreeStringC = Void Function(Pointer<Utf8>);
 typedef _FreeStringDart = void Function(Pointer<Utf8>);
 
@@ -41,6 +79,165 @@ typedef _GetLastErrorDart = Pointer<Utf8> Function();
 typedef _GetVersionC = Pointer<Utf8> Function();
 typedef _GetVersionDart = Pointer<Utf8> Function();
 
+// ==============================================================================
+// Native Structs (mirror engine.h)
+// ==============================================================================
+
+const int _engineFlagHugePages = 0x1;
+
+/// Allocator installed behind the embedded interpreter (ENGINE_ALLOCATOR_*).
+enum EngineAllocator {
+  /// pymalloc + system malloc, untouched.
+  system(0),
+
+  /// mimalloc; the engine falls back to [tracked] when built without it.
+  mimalloc(1),
+
+  /// Existing allocators wrapped with statistics.
+  tracked(2);
+
+  final int code;
+  const EngineAllocator(this.code);
+}
+
+/// What a full job queue does with a new job (ENGINE_QUEUE_*).
+enum EngineQueuePolicy {
+  /// Manifest readers wait for room; preview follow-ups are rejected.
+  block(0),
+
+  /// The new job fails with a `retry_after_ms` hint.
+  reject(1),
+
+  /// The oldest queued job of the same kind fails to make room.
+  dropOldest(2);
+
+  final int code;
+  const EngineQueuePolicy(this.code);
+}
+
+final class _EngineInitOptions extends Struct {
+  @Uint32()
+  external int structSize;
+
+  @Uint32()
+  external int flags;
+
+  @Uint32()
+  external int allocator;
+
+  @Uint32()
+  external int jobWorkers;
+
+  @Uint64()
+  external int maxInputPixels;
+
+  external Pointer<Utf8> pluginDir;
+
+  @Uint32()
+  external int queueCapacity;
+
+  @Uint32()
+  external int queuePolicy;
+}
+
+const int _engineAbiVersion = 1;
+const int _enginePathMax = 1024;
+const int _engineErrorMax = 256;
+const int _engineRequestNoOverlay = 0x1;
+const int _engineRequestSkipEncode = 0x2;
+const int _engineStatusOk = 0;
+
+/// Stage names in EngineResult.stage_ms order.
+const List<String> engineStages = ['decode', 'filter', 'overlay', 'encode'];
+
+final class _EngineRequest extends Struct {
+  @Uint32()
+  external int structSize;
+
+  @Uint32()
+  external int abiVersion;
+
+  external Pointer<Utf8> inputPath;
+
+  external Pointer<Utf8> outputDir;
+
+  @Uint32()
+  external int flags;
+
+  @Float()
+  external double sharpness;
+
+  @Float()
+  external double contrast;
+
+  external _ProgressCallbackPtr progress;
+
+  external Pointer<Void> progressUserData;
+}
+
+final class _EngineFrame extends Struct {
+  @Uint32()
+  external int structSize;
+
+  @Int32()
+  external int width;
+
+  @Int32()
+  external int height;
+
+  @Uint32()
+  external int stride;
+
+  external Pointer<Uint8> pixels;
+
+  external Pointer<Void> handle;
+}
+
+final class _EngineResult extends Struct {
+  @Uint32()
+  external int structSize;
+
+  @Int32()
+  external int status;
+
+  @Int32()
+  external int originalWidth;
+
+  @Int32()
+  external int originalHeight;
+
+  @Int32()
+  external int outputWidth;
+
+  @Int32()
+  external int outputHeight;
+
+  @Uint64()
+  external int outputSizeBytes;
+
+  @Array(4)
+  external Array<Double> stageMs;
+
+  @Array(8)
+  external Array<Uint8> originalMode;
+
+  @Array(_enginePathMax)
+  external Array<Uint8> outputPath;
+
+  @Array(_engineErrorMax)
+  external Array<Uint8> error;
+}
+
+String _readFixedString(Array<Uint8> chars, int capacity) {
+  final bytes = <int>[];
+  for (var i = 0; i < capacity; i++) {
+    final c = chars[i];
+    if (c == 0) break;
+    bytes.add(c);
+  }
+  return utf8.decode(bytes, allowMalformed: true);
+}
+
 // ==============================================================================
 // Low-Level Bindings (Used inside Isolate)
 // ==============================================================================
@@ -49,8 +246,17 @@ class _RawBindings {
   final DynamicLibrary _lib;
 
   late final _EngineInitDart engineInit;
+  late final _EngineInitExDart engineInitEx;
   late final _EngineIsInitializedDart isInitialized;
   late final _ProcessImageDart processImage;
+  late final _ProcessImageWithProgressDart processImageWithProgress;
+  late final _ProcessImageBinaryDart processImageBinary;
+  late final _ProcessImagePixelsDart processImagePixels;
+  late final _SubmitManifestDart submitManifest;
+  late final _BatchStatusDart batchStatus;
+  late final _PrefetchDart prefetch;
+  late final _PrefetchCancelDart prefetchCancel;
+  late final _ProbeImagesDart probeImages;
   late final _FreeStringDart freeString;
   late final _EngineShutdownDart shutdown;
   late final _GetLastErrorDart getLastError;
@@ -58,8 +264,19 @@ class _RawBindings {
 
   _RawBindings(String libraryPath) : _lib = DynamicLibrary.open(libraryPath) {
     engineInit = _lib.lookup<NativeFunction<_EngineInitC>>('engine_init').asFunction();
+    engineInitEx = _lib.lookup<NativeFunction<_EngineInitExC>>('engine_init_ex').asFunction();
     isInitialized = _lib.lookup<NativeFunction<_EngineIsInitializedC>>('engine_is_initialized').asFunction();
     processImage = _lib.lookup<NativeFunction<_ProcessImageC>>('process_image').asFunction();
+    processImageWithProgress = _lib
+        .lookup<NativeFunction<_ProcessImageWithProgressC>>('process_image_with_progress')
+        .asFunction();
+    processImageBinary = _lib.lookup<NativeFunction<_ProcessImageBinaryC>>('process_image_binary').asFunction();
+    processImagePixels = _lib.lookup<NativeFunction<_ProcessImagePixelsC>>('process_image_pixels').asFunction();
+    submitManifest = _lib.lookup<NativeFunction<_SubmitManifestC>>('engine_submit_manifest').asFunction();
+    batchStatus = _lib.lookup<NativeFunction<_BatchStatusC>>('engine_batch_status').asFunction();
+    prefetch = _lib.lookup<NativeFunction<_PrefetchC>>('engine_prefetch').asFunction();
+    prefetchCancel = _lib.lookup<NativeFunction<_PrefetchCancelC>>('engine_prefetch_cancel').asFunction();
+    probeImages = _lib.lookup<NativeFunction<_ProbeImagesC>>('engine_probe_images').asFunction();
     freeString = _lib.lookup<NativeFunction<_FreeStringC>>('free_string').asFunction();
     shutdown = _lib.lookup<NativeFunction<_EngineShutdownC>>('engine_shutdown').asFunction();
     getLastError = _lib.lookup<NativeFunction<_GetLastErrorC>>('engine_get_last_error').asFunction();
@@ -71,32 +288,119 @@ class _RawBindings {
 // Isolate Messages
 // ==============================================================================
 
+/// Requests travel as `[requestId, message]`; replies come back on the
+/// isolate's spawn port as `[requestId, payload]`.
 sealed class _IsolateMessage {}
 
 class _InitMessage extends _IsolateMessage {
-  final SendPort replyPort;
   final String libraryPath;
   final String? pythonHome;
   final String scriptPath;
+  final int flags;
+  final int allocator;
+  final int jobWorkers;
+  final int maxInputPixels;
+  final String? pluginDir;
+  final int queueCapacity;
+  final int queuePolicy;
 
-  _InitMessage(this.replyPort, this.libraryPath, this.pythonHome, this.scriptPath);
+  _InitMessage(this.libraryPath, this.pythonHome, this.scriptPath, this.flags,
+      this.allocator, this.jobWorkers, this.maxInputPixels, this.pluginDir,
+      this.queueCapacity, this.queuePolicy);
+}
+
+/// Load the library in an additional isolate without initializing the engine.
+class _AttachMessage extends _IsolateMessage {
+  final String libraryPath;
+
+  _AttachMessage(this.libraryPath);
 }
 
 class _ProcessMessage extends _IsolateMessage {
-  final SendPort replyPort;
   final String inputJson;
 
-  _ProcessMessage(this.replyPort, this.inputJson);
+  /// Address of the pool's progress callback (0 = none) and the token
+  /// identifying this request in its events.
+  final int progressCallback;
+  final int progressToken;
+
+  _ProcessMessage(this.inputJson, [this.progressCallback = 0, this.progressToken = 0]);
+}
+
+class _ProcessBinaryMessage extends _IsolateMessage {
+  final String inputPath;
+  final String? outputDir;
+  final bool overlay;
+  final double sharpness;
+  final double contrast;
+  final int progressCallback;
+  final int progressToken;
+
+  /// Return the final pixels as an engine-owned frame ([_PixelsReply]).
+  final bool pixels;
+
+  /// With [pixels]: also write the output file.
+  final bool encode;
+
+  _ProcessBinaryMessage(this.inputPath, this.outputDir, this.overlay,
+      this.sharpness, this.contrast,
+      {this.progressCallback = 0, this.progressToken = 0, this.pixels = false, this.encode = true});
+}
+
+/// Engine frame handed back by the isolate. Only addresses cross the
+/// isolate boundary; the receiver wraps them without copying.
+class _PixelsReply {
+  final ProcessingResult result;
+  final int address;
+  final int handle;
+  final int width;
+  final int height;
+  final int stride;
+
+  _PixelsReply(this.result, this.address, this.handle, this.width, this.height, this.stride);
+}
+
+class _SubmitManifestMessage extends _IsolateMessage {
+  final String manifestPath;
+  final String? resultsPath;
+
+  _SubmitManifestMessage(this.manifestPath, this.resultsPath);
+}
+
+class _BatchStatusMessage extends _IsolateMessage {
+  final int batchId;
+
+  _BatchStatusMessage(this.batchId);
+}
+
+class _PrefetchMessage extends _IsolateMessage {
+  final String inputPath;
+  final String? paramsJson;
+
+  _PrefetchMessage(this.inputPath, this.paramsJson);
+}
+
+class _PrefetchCancelMessage extends _IsolateMessage {
+  final int prefetchId;
+
+  _PrefetchCancelMessage(this.prefetchId);
+}
+
+class _ProbeImagesMessage extends _IsolateMessage {
+  final List<String> paths;
+
+  _ProbeImagesMessage(this.paths);
 }
 
 class _ShutdownMessage extends _IsolateMessage {
-  final SendPort replyPort;
-  _ShutdownMessage(this.replyPort);
+  /// False for attached isolates: release per-isolate state only.
+  final bool shutdownEngine;
+
+  _ShutdownMessage({this.shutdownEngine = true});
 }
 
 class _GetVersionMessage extends _IsolateMessage {
-  final SendPort replyPort;
-  _GetVersionMessage(this.replyPort);
+  _GetVersionMessage();
 }
 
 // ==============================================================================
@@ -109,35 +413,66 @@ void _isolateEntry(SendPort mainPort) {
 
   _RawBindings? bindings;
 
-  receivePort.listen((message) {
+  // Reused for every binary call; freed on shutdown
+  Pointer<_EngineRequest>? request;
+  Pointer<_EngineResult>? result;
+  Pointer<_EngineFrame>? frame;
+
+  receivePort.listen((envelope) {
+    final requestId = (envelope as List)[0] as int;
+    final message = envelope[1] as _IsolateMessage;
+    void reply(Object? payload) => mainPort.send([requestId, payload]);
+
     if (message is _InitMessage) {
       try {
         bindings = _RawBindings(message.libraryPath);
 
         final pythonHomePtr = message.pythonHome?.toNativeUtf8() ?? nullptr;
         final scriptPathPtr = message.scriptPath.toNativeUtf8();
+        final pluginDirPtr = message.pluginDir?.toNativeUtf8() ?? nullptr;
+        final optionsPtr = calloc<_EngineInitOptions>();
+        optionsPtr.ref
+          ..structSize = sizeOf<_EngineInitOptions>()
+          ..flags = message.flags
+          ..allocator = message.allocator
+          ..jobWorkers = message.jobWorkers
+          ..maxInputPixels = message.maxInputPixels
+          ..pluginDir = pluginDirPtr
+          ..queueCapacity = message.queueCapacity
+          ..queuePolicy = message.queuePolicy;
 
-        final result = bindings!.engineInit(pythonHomePtr, scriptPathPtr);
+        final result = bindings!.engineInitEx(pythonHomePtr, scriptPathPtr, optionsPtr);
 
         // Free allocated strings
         if (pythonHomePtr != nullptr) calloc.free(pythonHomePtr);
+        if (pluginDirPtr != nullptr) calloc.free(pluginDirPtr);
         calloc.free(scriptPathPtr);
+        calloc.free(optionsPtr);
 
         if (result != 0) {
           final errorPtr = bindings!.getLastError();
           final error = errorPtr != nullptr ? errorPtr.toDartString() : 'Unknown error';
-          message.replyPort.send({'success': false, 'error': error, 'code': result});
+          reply({'success': false, 'error': error, 'code': result});
         } else {
           final versionPtr = bindings!.getVersion();
           final version = versionPtr != nullptr ? versionPtr.toDartString() : 'unknown';
-          message.replyPort.send({'success': true, 'version': version});
+          reply({'success': true, 'version': version});
         }
       } catch (e) {
-        message.replyPort.send({'success': false, 'error': e.toString()});
+        reply({'success': false, 'error': e.toString()});
+      }
+    } else if (message is _AttachMessage) {
+      try {
+        bindings = _RawBindings(message.libraryPath);
+        final versionPtr = bindings!.getVersion();
+        final version = versionPtr != nullptr ? versionPtr.toDartString() : 'unknown';
+        reply({'success': true, 'version': version});
+      } catch (e) {
+        reply({'success': false, 'error': e.toString()});
       }
     } else if (message is _ProcessMessage) {
       if (bindings == null) {
-        message.replyPort.send({'success': false, 'error': 'Not initialized'});
+        reply({'success': false, 'error': 'Not initialized'});
         return;
       }
 
@@ -145,13 +480,19 @@ void _isolateEntry(SendPort mainPort) {
       Pointer<Utf8>? resultPtr;
 
       try {
-        resultPtr = bindings!.processImage(inputPtr);
+        resultPtr = message.progressCallback == 0
+            ? bindings!.processImage(inputPtr)
+            : bindings!.processImageWithProgress(
+                inputPtr,
+                Pointer.fromAddress(message.progressCallback),
+                Pointer.fromAddress(message.progressToken),
+              );
 
         if (resultPtr == nullptr) {
-          message.replyPort.send({'success': false, 'error': 'Null result'});
+          reply({'success': false, 'error': 'Null result'});
         } else {
           final result = resultPtr.toDartString();
-          message.replyPort.send({'success': true, 'result': result});
+          reply({'success': true, 'result': result});
         }
       } finally {
         // CRITICAL: Free allocated memory!
@@ -160,17 +501,168 @@ void _isolateEntry(SendPort mainPort) {
           bindings!.freeString(resultPtr);
         }
       }
+    } else if (message is _ProcessBinaryMessage) {
+      if (bindings == null) {
+        reply({'success': false, 'error': 'Not initialized'});
+        return;
+      }
+
+      request ??= calloc<_EngineRequest>();
+      result ??= calloc<_EngineResult>();
+
+      final inputPtr = message.inputPath.toNativeUtf8();
+      final outputDirPtr = message.outputDir?.toNativeUtf8() ?? nullptr;
+
+      try {
+        request!.ref
+          ..structSize = sizeOf<_EngineRequest>()
+          ..abiVersion = _engineAbiVersion
+          ..inputPath = inputPtr
+          ..outputDir = outputDirPtr
+          ..flags = (message.overlay ? 0 : _engineRequestNoOverlay) |
+              (message.pixels && !message.encode ? _engineRequestSkipEncode : 0)
+          ..sharpness = message.sharpness
+          ..contrast = message.contrast
+          ..progress = Pointer.fromAddress(message.progressCallback)
+          ..progressUserData = Pointer.fromAddress(message.progressToken);
+        result!.ref.structSize = sizeOf<_EngineResult>();
+
+        final int status;
+        if (message.pixels) {
+          frame ??= calloc<_EngineFrame>();
+          frame!.ref.structSize = sizeOf<_EngineFrame>();
+          status = bindings!.processImagePixels(request!, result!, frame!);
+        } else {
+          status = bindings!.processImageBinary(request!, result!);
+        }
+        final r = result!.ref;
+
+        if (status != _engineStatusOk) {
+          reply(ProcessingResult(
+            success: false,
+            error: _readFixedString(r.error, _engineErrorMax),
+          ));
+        } else {
+          final outputPath = _readFixedString(r.outputPath, _enginePathMax);
+          final processed = ProcessingResult(
+            success: true,
+            outputPath: outputPath.isEmpty ? null : outputPath,
+            metadata: {
+              'input_path': message.inputPath,
+              'original_size': [r.originalWidth, r.originalHeight],
+              'original_mode': _readFixedString(r.originalMode, 8),
+              'output_dimensions': [r.outputWidth, r.outputHeight],
+              'output_size_bytes': r.outputSizeBytes,
+              'timings_ms': {
+                for (var i = 0; i < engineStages.length; i++) engineStages[i]: r.stageMs[i],
+              },
+            },
+          );
+
+          if (message.pixels) {
+            final f = frame!.ref;
+            reply(_PixelsReply(processed, f.pixels.address, f.handle.address, f.width, f.height,
+                f.stride));
+          } else {
+            reply(processed);
+          }
+        }
+      } finally {
+        calloc.free(inputPtr);
+        if (outputDirPtr != nullptr) calloc.free(outputDirPtr);
+      }
+    } else if (message is _SubmitManifestMessage) {
+      if (bindings == null) {
+        reply({'success': false, 'error': 'Not initialized'});
+        return;
+      }
+
+      final manifestPtr = message.manifestPath.toNativeUtf8();
+      final resultsPtr = message.resultsPath?.toNativeUtf8() ?? nullptr;
+      try {
+        final batchId = bindings!.submitManifest(manifestPtr, resultsPtr);
+        if (batchId == 0) {
+          final errorPtr = bindings!.getLastError();
+          final error = errorPtr != nullptr ? errorPtr.toDartString() : 'Unknown error';
+          reply({'success': false, 'error': error});
+        } else {
+          reply({'success': true, 'batch_id': batchId});
+        }
+      } finally {
+        calloc.free(manifestPtr);
+        if (resultsPtr != nullptr) calloc.free(resultsPtr);
+      }
+    } else if (message is _BatchStatusMessage) {
+      if (bindings == null) {
+        reply({'success': false, 'error': 'Not initialized'});
+        return;
+      }
+
+      final statusPtr = bindings!.batchStatus(message.batchId);
+      try {
+        reply({'success': true, 'result': statusPtr.toDartString()});
+      } finally {
+        bindings!.freeString(statusPtr);
+      }
+    } else if (message is _PrefetchMessage) {
+      if (bindings == null) {
+        reply({'success': false, 'error': 'Not initialized'});
+        return;
+      }
+
+      final pathPtr = message.inputPath.toNativeUtf8();
+      final paramsPtr = message.paramsJson?.toNativeUtf8() ?? nullptr;
+      try {
+        final prefetchId = bindings!.prefetch(pathPtr, paramsPtr);
+        if (prefetchId == 0) {
+          final errorPtr = bindings!.getLastError();
+          final error = errorPtr != nullptr ? errorPtr.toDartString() : 'Unknown error';
+          reply({'success': false, 'error': error});
+        } else {
+          reply({'success': true, 'prefetch_id': prefetchId});
+        }
+      } finally {
+        calloc.free(pathPtr);
+        if (paramsPtr != nullptr) calloc.free(paramsPtr);
+      }
+    } else if (message is _PrefetchCancelMessage) {
+      if (bindings == null) {
+        reply({'success': false, 'error': 'Not initialized'});
+        return;
+      }
+
+      reply({'success': true, 'cancelled': bindings!.prefetchCancel(message.prefetchId) != 0});
+    } else if (message is _ProbeImagesMessage) {
+      if (bindings == null) {
+        reply({'success': false, 'error': 'Not initialized'});
+        return;
+      }
+
+      final pathsPtr = jsonEncode(message.paths).toNativeUtf8();
+      final resultPtr = bindings!.probeImages(pathsPtr);
+      try {
+        reply({'success': true, 'result': resultPtr.toDartString()});
+      } finally {
+        bindings!.freeString(resultPtr);
+        calloc.free(pathsPtr);
+      }
     } else if (message is _ShutdownMessage) {
-      bindings?.shutdown();
+      if (request != null) calloc.free(request!);
+      if (result != null) calloc.free(result!);
+      if (frame != null) calloc.free(frame!);
+      request = null;
+      result = null;
+      frame = null;
+      if (message.shutdownEngine) bindings?.shutdown();
       bindings = null;
-      message.replyPort.send({'success': true});
+      reply({'success': true});
       receivePort.close();
     } else if (message is _GetVersionMessage) {
       if (bindings != null) {
         final ptr = bindings!.getVersion();
-        message.replyPort.send(ptr != nullptr ? ptr.toDartString() : 'unknown');
+        reply(ptr != nullptr ? ptr.toDartString() : 'unknown');
       } else {
-        message.replyPort.send('not loaded');
+        reply('not loaded');
       }
     }
   });
@@ -190,6 +682,36 @@ class NativeEngineException implements Exception {
   String toString() => 'NativeEngineException: $message${code != null ? ' (code: $code)' : ''}';
 }
 
+// ==============================================================================
+// Progress
+// ==============================================================================
+
+/// One progress event reported by the engine while a request runs.
+/// [done]/[total] count units within [stage] (row bands while filtering,
+/// 1 for other stages); `done == total` means the stage finished.
+class EngineProgress {
+  final int stage;
+  final int done;
+  final int total;
+
+  const EngineProgress(this.stage, this.done, this.total);
+
+  // Typical share of wall time per stage, in engineStages order
+  static const List<double> _stageWeights = [0.10, 0.55, 0.05, 0.30];
+
+  String get stageName => engineStages[stage];
+
+  /// Overall completion of the request in [0, 1].
+  double get fraction {
+    var before = 0.0;
+    for (var i = 0; i < stage; i++) {
+      before += _stageWeights[i];
+    }
+    final within = total > 0 ? (done / total).clamp(0.0, 1.0) : 0.0;
+    return before + _stageWeights[stage] * within;
+  }
+}
+
 // ==============================================================================
 // Processing Result
 // ==============================================================================
@@ -200,11 +722,28 @@ class ProcessingResult {
   final String? error;
   final Map<String, dynamic>? metadata;
 
+  /// Batch id of the queued full-resolution job after a preview request
+  /// with `followUp`; poll it with [NativeEnginePool.batchStatus].
+  final int? followUpBatchId;
+
+  /// Directory of the deep-zoom tile pyramid (with pyramid.json), if requested.
+  final String? pyramidPath;
+
+  /// Downscaled sibling paths by name, if requested.
+  final Map<String, String>? siblings;
+
+  /// Variant output paths by name, in request order, if requested.
+  final Map<String, String>? variants;
+
   ProcessingResult({
     required this.success,
     this.outputPath,
     this.error,
     this.metadata,
+    this.followUpBatchId,
+    this.pyramidPath,
+    this.siblings,
+    this.variants,
   });
 
   factory ProcessingResult.fromJson(Map<String, dynamic> json) {
@@ -213,50 +752,206 @@ class ProcessingResult {
       outputPath: json['output_image_path'],
       error: json['error'],
       metadata: json['metadata'],
+      followUpBatchId: json['follow_up_batch_id'],
+      pyramidPath: json['pyramid_path'],
+      siblings: (json['siblings'] as Map<String, dynamic>?)?.map(
+        (name, sibling) => MapEntry(name, sibling['path'] as String),
+      ),
+      variants: (json['variants'] as List<dynamic>?)?.fold<Map<String, String>>(
+        {},
+        (paths, variant) =>
+            paths..[variant['name'] as String] = variant['output_image_path'] as String,
+      ),
     );
   }
 }
 
 // ==============================================================================
-// Native Engine (High-Level, Isolate-Based)
+// Processed Pixels
+// ==============================================================================
+
+/// Final pixels of a request, viewed in place in engine-owned memory.
+///
+/// [pixels] is an external RGBA8888 list (alpha 255) with [rowBytes] per
+/// row. A native finalizer attached to the list returns the frame to the
+/// engine pool once the list is unreachable; nothing is copied.
+/// Suitable for `ui.decodeImageFromPixels(..., rowBytes: rowBytes)`.
+class ProcessedPixels {
+  final ProcessingResult result;
+  final Uint8List pixels;
+  final int width;
+  final int height;
+  final int rowBytes;
+
+  ProcessedPixels._(this.result, this.pixels, this.width, this.height, this.rowBytes);
+}
+
+// ==============================================================================
+// Engine Isolate
 // ==============================================================================
 
-class NativeEngine {
-  Isolate? _isolate;
-  SendPort? _sendPort;
+/// One background isolate driving the shared native engine.
+///
+/// All replies arrive on a single long-lived port and are matched to their
+/// [Completer] by request id, so any number of requests can be queued on
+/// the isolate without a ReceivePort per call.
+class _EngineIsolate {
+  final Isolate _isolate;
+  final ReceivePort _replies;
+  final SendPort _sendPort;
+  final Map<int, Completer<dynamic>> _pending = {};
+  int _nextRequestId = 0;
+
+  _EngineIsolate._(this._isolate, this._replies, this._sendPort);
+
+  /// Requests sent and not yet answered (used for least-loaded dispatch).
+  int get inFlight => _pending.length;
+
+  static Future<_EngineIsolate> spawn() async {
+    final replies = ReceivePort();
+    final isolate = await Isolate.spawn(_isolateEntry, replies.sendPort);
+
+    // First message is the isolate's command port; the rest are replies
+    final sendPort = Completer<SendPort>();
+    late final _EngineIsolate worker;
+    replies.listen((message) {
+      if (message is SendPort) {
+        sendPort.complete(message);
+        return;
+      }
+      worker._complete(message as List);
+    });
+
+    worker = _EngineIsolate._(isolate, replies, await sendPort.future);
+    return worker;
+  }
+
+  void _complete(List reply) {
+    final completer = _pending.remove(reply[0] as int);
+    completer?.complete(reply[1]);
+  }
+
+  /// Queue a request on the isolate and await its reply.
+  Future<dynamic> call(_IsolateMessage message) {
+    final id = _nextRequestId++;
+    final completer = Completer<dynamic>();
+    _pending[id] = completer;
+    _sendPort.send([id, message]);
+    return completer.future;
+  }
+
+  /// Fail anything still pending, then tear the isolate down.
+  void kill() {
+    for (final completer in _pending.values) {
+      completer.completeError(NativeEngineException('Engine isolate stopped'));
+    }
+    _pending.clear();
+    _replies.close();
+    _isolate.kill(priority: Isolate.immediate);
+  }
+}
+
+// ==============================================================================
+// Native Engine Pool (High-Level, Isolate-Based)
+// ==============================================================================
+
+/// How [NativeEnginePool] picks an isolate for the next request.
+enum EngineDispatch {
+  /// Rotate through isolates in order.
+  roundRobin,
+
+  /// Pick the isolate with the fewest outstanding requests.
+  leastLoaded,
+}
+
+/// Several isolates sharing one initialized native engine.
+///
+/// The first isolate initializes the engine; the others only load the
+/// library. Each isolate blocks on one FFI call at a time, so [isolates]
+/// bounds how many requests the engine sees concurrently.
+class NativeEnginePool {
+  final int isolates;
+  final EngineDispatch dispatch;
+
+  final List<_EngineIsolate> _workers = [];
+  int _next = 0;
+
+  // One listener callable shared by all isolates. It lives on this (UI)
+  // isolate, so events arrive while the engine isolate is blocked in FFI.
+  NativeCallable<_ProgressCallbackC>? _progressCallable;
+
+  // engine_release_frame, looked up on this isolate for pixel finalizers
+  Pointer<NativeFinalizerFunction>? _releaseFrame;
+  final Map<int, void Function(EngineProgress)> _progressListeners = {};
+  int _nextProgressToken = 1;
   bool _initialized = false;
   String _version = 'unknown';
 
+  NativeEnginePool({
+    int? isolates,
+    this.dispatch = EngineDispatch.leastLoaded,
+  }) : isolates = (isolates != null && isolates > 0) ? isolates : _defaultIsolates();
+
+  /// One isolate per core, capped: beyond that the GIL dominates.
+  static int _defaultIsolates() {
+    final cores = Platform.numberOfProcessors;
+    return cores < 1 ? 1 : (cores > 4 ? 4 : cores);
+  }
+
   bool get isInitialized => _initialized;
   String get version => _version;
 
-  /// Initialize engine in background isolate.
+  /// Outstanding requests per isolate.
+  List<int> get load => [for (final w in _workers) w.inFlight];
+
+  /// Initialize engine in background isolates.
   /// Does NOT block UI thread.
+  ///
+  /// [hugePages] backs large frame buffers with 2 MiB pages when the OS allows.
+  /// [allocator] selects the interpreter/engine allocator.
+  /// [jobWorkers] sets the threads running manifest batches (0 = auto, sized
+  /// from the CPUs the process may use under its affinity mask and quota).
+  /// [maxInputPixels] rejects larger inputs from their header before
+  /// decoding (0 = engine default).
+  /// [pluginDir] holds filter plug-ins loaded once at init; Python ones
+  /// (`*.py`) call `image_processor.register_hook` on import.
+  /// [queueCapacity] bounds queued jobs per lane (0 = engine default) and
+  /// [queuePolicy] decides what happens when it is reached.
   Future<void> initialize({
     required String libraryPath,
     String? pythonHome,
     required String scriptPath,
+    bool hugePages = false,
+    EngineAllocator allocator = EngineAllocator.system,
+    int jobWorkers = 0,
+    int maxInputPixels = 0,
+    String? pluginDir,
+    int queueCapacity = 0,
+    EngineQueuePolicy queuePolicy = EngineQueuePolicy.block,
   }) async {
     if (_initialized) {
       throw NativeEngineException('Already initialized');
     }
 
-    // Spawn isolate
-    final receivePort = ReceivePort();
-    _isolate = await Isolate.spawn(_isolateEntry, receivePort.sendPort);
-    _sendPort = await receivePort.first as SendPort;
+    // Spawn isolates
+    final spawned = await Future.wait([
+      for (var i = 0; i < isolates; i++) _EngineIsolate.spawn(),
+    ]);
+    _workers.addAll(spawned);
 
-    // Initialize engine in isolate
-    final responsePort = ReceivePort();
-    _sendPort!.send(_InitMessage(
-      responsePort.sendPort,
+    // Initialize engine in the primary isolate
+    final response = await _workers.first.call(_InitMessage(
       libraryPath,
       pythonHome,
       scriptPath,
-    ));
-
-    final response = await responsePort.first as Map<String, dynamic>;
-    responsePort.close();
+      hugePages ? _engineFlagHugePages : 0,
+      allocator.code,
+      jobWorkers,
+      maxInputPixels,
+      pluginDir,
+      queueCapacity,
+      queuePolicy.code,
+    )) as Map<String, dynamic>;
 
     if (response['success'] != true) {
       await shutdown();
@@ -266,27 +961,124 @@ class NativeEngine {
       );
     }
 
+    // Attach the rest to the already-initialized engine
+    final attached = await Future.wait([
+      for (final worker in _workers.skip(1))
+        worker.call(_AttachMessage(libraryPath)),
+    ]);
+    for (final r in attached.cast<Map<String, dynamic>>()) {
+      if (r['success'] != true) {
+        await shutdown();
+        throw NativeEngineException(r['error'] ?? 'Attach failed');
+      }
+    }
+
+    _releaseFrame = DynamicLibrary.open(libraryPath)
+        .lookup<NativeFinalizerFunction>('engine_release_frame');
+
     _version = response['version'] ?? 'unknown';
     _initialized = true;
   }
 
-  /// Process image in background isolate.
-  /// Does NOT block UI thread.
-  Future<ProcessingResult> processImage(String inputPath, {String? outputDir}) async {
-    if (!_initialized || _sendPort == null) {
+  _EngineIsolate _pick() {
+    if (!_initialized || _workers.isEmpty) {
       throw NativeEngineException('Not initialized');
     }
 
+    if (dispatch == EngineDispatch.roundRobin) {
+      final worker = _workers[_next];
+      _next = (_next + 1) % _workers.length;
+      return worker;
+    }
+
+    // Least loaded; rotate the starting point so ties spread out
+    var best = _workers[_next];
+    for (var i = 1; i < _workers.length; i++) {
+      final candidate = _workers[(_next + i) % _workers.length];
+      if (candidate.inFlight < best.inFlight) best = candidate;
+    }
+    _next = (_next + 1) % _workers.length;
+    return best;
+  }
+
+  void _onProgress(Pointer<Void> token, int stage, int done, int total) {
+    if (stage < 0 || stage >= engineStages.length) return;
+    _progressListeners[token.address]?.call(EngineProgress(stage, done, total));
+  }
+
+  /// Register [onProgress] for one request: (callback address, token).
+  (int, int) _listen(void Function(EngineProgress)? onProgress) {
+    if (onProgress == null) return (0, 0);
+    _progressCallable ??= NativeCallable<_ProgressCallbackC>.listener(_onProgress);
+    final token = _nextProgressToken++;
+    _progressListeners[token] = onProgress;
+    return (_progressCallable!.nativeFunction.address, token);
+  }
+
+  /// Process image in a background isolate.
+  /// Does NOT block UI thread.
+  ///
+  /// [onProgress] receives stage and tile events as the engine reports them.
+  ///
+  /// With [previewMaxDim] a downscaled proxy (longer side <= previewMaxDim)
+  /// is processed instead and returned quickly; [followUp] then queues the
+  /// full-resolution job at background priority (see
+  /// [ProcessingResult.followUpBatchId]).
+  ///
+  /// With [roi] only that region (in source pixels) is processed and
+  /// written, so a zoomed view costs in proportion to what is visible.
+  ///
+  /// [pyramid] also writes 256px tiles for every zoom level next to the
+  /// output (see [ProcessingResult.pyramidPath]).
+  ///
+  /// [siblings] maps names to a maximum dimension; each gets a downscaled
+  /// copy resampled from the in-memory result (see
+  /// [ProcessingResult.siblings]), so display never decodes full resolution.
+  ///
+  /// [ops] applies native plug-in filters after the built-in chain, in
+  /// order, e.g. `[{'op': 'denoise', 'strength': 0.8}]`.
+  ///
+  /// [variants] decodes once and writes one output per entry, rendered in
+  /// parallel, e.g. `[{'name': 'soft', 'sharpness': 1.0}, {'name': 'crisp',
+  /// 'sharpness': 2.5}]` (see [ProcessingResult.variants]). Unset settings
+  /// fall back to the defaults; not combinable with [roi], [pyramid] or
+  /// [siblings].
+  Future<ProcessingResult> processImage(
+    String inputPath, {
+    String? outputDir,
+    int? previewMaxDim,
+    bool followUp = false,
+    ({int x, int y, int width, int height})? roi,
+    bool pyramid = false,
+    Map<String, int>? siblings,
+    List<Map<String, Object>>? ops,
+    List<Map<String, Object>>? variants,
+    void Function(EngineProgress)? onProgress,
+  }) async {
+    final worker = _pick();
+
     final inputJson = jsonEncode({
       'input_image_path': inputPath,
-      if (outputDir != null) 'output_dir': outputDir,
+      ..._requestOptions(
+        outputDir: outputDir,
+        previewMaxDim: previewMaxDim,
+        followUp: followUp,
+        roi: roi,
+        pyramid: pyramid,
+        siblings: siblings,
+        ops: ops,
+        variants: variants,
+      ),
     });
 
-    final responsePort = ReceivePort();
-    _sendPort!.send(_ProcessMessage(responsePort.sendPort, inputJson));
-
-    final response = await responsePort.first as Map<String, dynamic>;
-    responsePort.close();
+    final (callback, token) = _listen(onProgress);
+    final Map<String, dynamic> response;
+    try {
+      response = await worker.call(_ProcessMessage(inputJson, callback, token))
+          as Map<String, dynamic>;
+    } finally {
+      _progressListeners.remove(token);
+    }
 
     if (response['success'] != true) {
       throw NativeEngineException(response['error'] ?? 'Process failed');
@@ -297,18 +1089,248 @@ class NativeEngine {
     return ProcessingResult.fromJson(resultMap);
   }
 
-  /// Shutdown engine and kill isolate.
-  Future<void> shutdown() async {
-    if (_sendPort != null) {
-      final responsePort = ReceivePort();
-      _sendPort!.send(_ShutdownMessage(responsePort.sendPort));
-      await responsePort.first;
-      responsePort.close();
+  /// Process image through the binary struct ABI.
+  /// Skips JSON encoding/decoding on both sides; intended for high-rate,
+  /// small-image workloads. Returns the same [ProcessingResult] shape.
+  Future<ProcessingResult> processImageBinary(
+    String inputPath, {
+    String? outputDir,
+    bool overlay = true,
+    double sharpness = 1.5,
+    double contrast = 1.2,
+    void Function(EngineProgress)? onProgress,
+  }) async {
+    final worker = _pick();
+
+    final (callback, token) = _listen(onProgress);
+    final dynamic response;
+    try {
+      response = await worker.call(_ProcessBinaryMessage(
+        inputPath,
+        outputDir,
+        overlay,
+        sharpness,
+        contrast,
+        progressCallback: callback,
+        progressToken: token,
+      ));
+    } finally {
+      _progressListeners.remove(token);
     }
 
-    _isolate?.kill(priority: Isolate.immediate);
-    _isolate = null;
-    _sendPort = null;
+    if (response is ProcessingResult) {
+      return response;
+    }
+    throw NativeEngineException((response as Map<String, dynamic>)['error'] ?? 'Process failed');
+  }
+
+  /// Process an image and return its final pixels without copying them.
+  ///
+  /// The pixels stay in the engine's frame pool and are released by a
+  /// native finalizer when [ProcessedPixels.pixels] is garbage collected.
+  /// With [writeFile] false no output file is encoded at all.
+  Future<ProcessedPixels> processImagePixels(
+    String inputPath, {
+    String? outputDir,
+    bool overlay = true,
+    double sharpness = 1.5,
+    double contrast = 1.2,
+    bool writeFile = false,
+    void Function(EngineProgress)? onProgress,
+  }) async {
+    final worker = _pick();
+
+    final (callback, token) = _listen(onProgress);
+    final dynamic response;
+    try {
+      response = await worker.call(_ProcessBinaryMessage(
+        inputPath,
+        outputDir,
+        overlay,
+        sharpness,
+        contrast,
+        progressCallback: callback,
+        progressToken: token,
+        pixels: true,
+        encode: writeFile,
+      ));
+    } finally {
+      _progressListeners.remove(token);
+    }
+
+    if (response is _PixelsReply) {
+      final pixels = Pointer<Uint8>.fromAddress(response.address).asTypedList(
+        response.stride * response.height,
+        finalizer: _releaseFrame,
+        token: Pointer<Void>.fromAddress(response.handle),
+      );
+      return ProcessedPixels._(
+          response.result, pixels, response.width, response.height, response.stride);
+    }
+    if (response is ProcessingResult) {
+      throw NativeEngineException(response.error ?? 'Process failed');
+    }
+    throw NativeEngineException((response as Map<String, dynamic>)['error'] ?? 'Process failed');
+  }
+
+  /// Request members shared by [processImage] and [prefetch], so a
+  /// prefetch with the same arguments matches the later request.
+  static Map<String, Object> _requestOptions({
+    String? outputDir,
+    int? previewMaxDim,
+    bool followUp = false,
+    ({int x, int y, int width, int height})? roi,
+    bool pyramid = false,
+    Map<String, int>? siblings,
+    List<Map<String, Object>>? ops,
+    List<Map<String, Object>>? variants,
+  }) {
+    return {
+      if (outputDir != null) 'output_dir': outputDir,
+      if (previewMaxDim != null)
+        'preview': {'max_dim': previewMaxDim, 'follow_up': followUp},
+      if (roi != null) 'roi': [roi.x, roi.y, roi.width, roi.height],
+      if (pyramid) 'pyramid': true,
+      if (siblings != null) 'siblings': siblings,
+      if (ops != null) 'ops': ops,
+      if (variants != null) 'variants': variants,
+    };
+  }
+
+  /// Hint that [processImage] will probably be called for [inputPath]
+  /// (hover, selection). The engine decodes it while idle; with [speculate]
+  /// it runs the whole request, and a later [processImage] with the same
+  /// arguments returns that result at once (or waits for it if still
+  /// running). Other arguments match [processImage]'s.
+  ///
+  /// Returns an id for [cancelPrefetch]; call it when the hint goes stale.
+  Future<int> prefetch(
+    String inputPath, {
+    bool speculate = false,
+    String? outputDir,
+    int? previewMaxDim,
+    bool followUp = false,
+    ({int x, int y, int width, int height})? roi,
+    bool pyramid = false,
+    Map<String, int>? siblings,
+    List<Map<String, Object>>? ops,
+    List<Map<String, Object>>? variants,
+  }) async {
+    final worker = _pick();
+
+    final paramsJson = jsonEncode({
+      ..._requestOptions(
+        outputDir: outputDir,
+        previewMaxDim: previewMaxDim,
+        followUp: followUp,
+        roi: roi,
+        pyramid: pyramid,
+        siblings: siblings,
+        ops: ops,
+        variants: variants,
+      ),
+      if (speculate) 'speculate': true,
+    });
+
+    final response = await worker.call(_PrefetchMessage(inputPath, paramsJson))
+        as Map<String, dynamic>;
+
+    if (response['success'] != true) {
+      throw NativeEngineException(response['error'] ?? 'Prefetch failed');
+    }
+    return response['prefetch_id'] as int;
+  }
+
+  /// Withdraw a [prefetch] hint. Returns false if it had already been used
+  /// or dropped.
+  Future<bool> cancelPrefetch(int prefetchId) async {
+    final worker = _pick();
+
+    final response = await worker.call(_PrefetchCancelMessage(prefetchId))
+        as Map<String, dynamic>;
+
+    if (response['success'] != true) {
+      throw NativeEngineException(response['error'] ?? 'Cancel failed');
+    }
+    return response['cancelled'] as bool;
+  }
+
+  /// Queue every entry of a JSON manifest for background processing.
+  /// The manifest is parsed natively and never crosses the isolate boundary;
+  /// per-entry results are appended to [resultsPath] as JSON Lines.
+  /// Returns the batch id for [batchStatus].
+  Future<int> submitManifest(String manifestPath, {String? resultsPath}) async {
+    final worker = _pick();
+
+    final response = await worker.call(_SubmitManifestMessage(manifestPath, resultsPath))
+        as Map<String, dynamic>;
+
+    if (response['success'] != true) {
+      throw NativeEngineException(response['error'] ?? 'Submit failed');
+    }
+    return response['batch_id'] as int;
+  }
+
+  /// Progress counters of a manifest batch
+  /// (submitted, completed, failed, pixels_total, pixels_done, parsing, done, error).
+  Future<Map<String, dynamic>> batchStatus(int batchId) async {
+    final worker = _pick();
+
+    final response = await worker.call(_BatchStatusMessage(batchId)) as Map<String, dynamic>;
+
+    if (response['success'] != true) {
+      throw NativeEngineException(response['error'] ?? 'Status failed');
+    }
+    return jsonDecode(response['result'] as String) as Map<String, dynamic>;
+  }
+
+  /// Header-only probe of each path: format, width, height, mode,
+  /// bit_depth and channels, or status/error per file. Nothing is decoded.
+  Future<List<Map<String, dynamic>>> probeImages(List<String> paths) async {
+    final worker = _pick();
+
+    final response = await worker.call(_ProbeImagesMessage(paths)) as Map<String, dynamic>;
+
+    if (response['success'] != true) {
+      throw NativeEngineException(response['error'] ?? 'Probe failed');
+    }
+    final result = jsonDecode(response['result'] as String) as Map<String, dynamic>;
+    if (result['status'] != 'success') {
+      throw NativeEngineException(result['error'] ?? 'Probe failed');
+    }
+    return (result['results'] as List).cast<Map<String, dynamic>>();
+  }
+
+  Future<Map<String, dynamic>> probeImage(String path) async =>
+      (await probeImages([path])).single;
+
+  /// Shutdown engine and kill isolates.
+  /// Attached isolates detach first; the engine waits for in-flight calls.
+  Future<void> shutdown() async {
     _initialized = false;
+
+    if (_workers.isNotEmpty) {
+      await Future.wait([
+        for (final worker in _workers.skip(1))
+          worker.call(_ShutdownMessage(shutdownEngine: false)),
+      ]);
+      await _workers.first.call(_ShutdownMessage());
+    }
+
+    for (final worker in _workers) {
+      worker.kill();
+    }
+    _workers.clear();
+    _next = 0;
+
+    // Engine is down; nothing can call the listener any more
+    _progressCallable?.close();
+    _progressCallable = null;
+    _progressListeners.clear();
   }
 }
+
+/// Single-isolate engine; requests are handled one at a time.
+class NativeEngine extends NativeEnginePool {
+  NativeEngine() : super(isolates: 1);
+}
@@ -0,0 +1,382 @@
+/**
+ * @file allocator.cpp
+ * @brief Planter Pressure - Pluggable Allocator for Interpreter and Engine
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <atomic>
+#include <cstdlib>
+
+#ifdef ENGINE_HAVE_MIMALLOC
+#include <mimalloc.h>
+#endif
+
+#include "allocator.h"
+
+namespace planter {
+
+namespace {
+
+// =============================================================================
+// Statistics
+// =============================================================================
+
+    struct AtomicDomainStats {
+        std::atomic<uint64_t> allocs{0};
+        std::atomic<uint64_t> frees{0};
+        std::atomic<uint64_t> bytes_current{0};
+
+        void on_alloc(size_t bytes) {
+            allocs.fetch_add(1, std::memory_order_relaxed);
+            bytes_current.fetch_add(bytes, std::memory_order_relaxed);
+        }
+
+        void on_free(size_t bytes) {
+            frees.fetch_add(1, std::memory_order_relaxed);
+            bytes_current.fetch_sub(bytes, std::memory_order_relaxed);
+        }
+
+        DomainStats snapshot() const {
+            DomainStats s;
+            s.allocs = allocs.load(std::memory_order_relaxed);
+            s.frees = frees.load(std::memory_order_relaxed);
+            s.bytes_current = bytes_current.load(std::memory_order_relaxed);
+            return s;
+        }
+    };
+
+    AtomicDomainStats g_raw_stats;
+    AtomicDomainStats g_mem_stats;
+    AtomicDomainStats g_obj_stats;
+    AtomicDomainStats g_engine_stats;
+    std::atomic<uint64_t> g_thread_heaps{0};
+    std::atomic<uint64_t> g_thread_heap_bytes{0};
+
+    AllocatorKind g_kind = AllocatorKind::Default;
+    bool g_installed = false;   // first install decides for the whole process
+
+    AtomicDomainStats* stats_for(PyMemAllocatorDomain domain) {
+        switch (domain) {
+            case PYMEM_DOMAIN_RAW: return &g_raw_stats;
+            case PYMEM_DOMAIN_MEM: return &g_mem_stats;
+            default: return &g_obj_stats;
+        }
+    }
+
+// =============================================================================
+// Tracked Backend (wraps the previous allocator, size kept in a header)
+// =============================================================================
+
+    // 16 bytes keeps the malloc alignment guarantee for the payload
+    constexpr size_t TRACK_HEADER = 16;
+
+    struct TrackedContext {
+        PyMemAllocatorEx inner;
+        AtomicDomainStats* stats;
+    };
+
+    TrackedContext g_tracked[3];
+
+    void* tracked_malloc(void* ctx, size_t size) {
+        auto* t = static_cast<TrackedContext*>(ctx);
+        if (size > PY_SSIZE_T_MAX - TRACK_HEADER) return nullptr;
+        auto* base = static_cast<uint8_t*>(t->inner.malloc(t->inner.ctx, size + TRACK_HEADER));
+        if (!base) return nullptr;
+        *reinterpret_cast<size_t*>(base) = size;
+        t->stats->on_alloc(size);
+        return base + TRACK_HEADER;
+    }
+
+    void* tracked_calloc(void* ctx, size_t nelem, size_t elsize) {
+        if (elsize != 0 && nelem > (PY_SSIZE_T_MAX - TRACK_HEADER) / elsize) return nullptr;
+        auto* t = static_cast<TrackedContext*>(ctx);
+        size_t size = nelem * elsize;
+        auto* base = static_cast<uint8_t*>(t->inner.calloc(t->inner.ctx, 1, size + TRACK_HEADER));
+        if (!base) return nullptr;
+        *reinterpret_cast<size_t*>(base) = size;
+        t->stats->on_alloc(size);
+        return base + TRACK_HEADER;
+    }
+
+    void* tracked_realloc(void* ctx, void* ptr, size_t new_size) {
+        auto* t = static_cast<TrackedContext*>(ctx);
+        if (!ptr) return tracked_malloc(ctx, new_size);
+        if (new_size > PY_SSIZE_T_MAX - TRACK_HEADER) return nullptr;
+
+        uint8_t* old_base = static_cast<uint8_t*>(ptr) - TRACK_HEADER;
+        size_t old_size = *reinterpret_cast<size_t*>(old_base);
+
+        auto* base = static_cast<uint8_t*>(t->inner.realloc(t->inner.ctx, old_base, new_size + TRACK_HEADER));
+        if (!base) return nullptr;
+        *reinterpret_cast<size_t*>(base) = new_size;
+        t->stats->on_free(old_size);
+        t->stats->on_alloc(new_size);
+        return base + TRACK_HEADER;
+    }
+
+    void tracked_free(void* ctx, void* ptr) {
+        if (!ptr) return;
+        auto* t = static_cast<TrackedContext*>(ctx);
+        uint8_t* base = static_cast<uint8_t*>(ptr) - TRACK_HEADER;
+        t->stats->on_free(*reinterpret_cast<size_t*>(base));
+        t->inner.free(t->inner.ctx, base);
+    }
+
+    void install_tracked() {
+        const PyMemAllocatorDomain domains[3] = {
+            PYMEM_DOMAIN_RAW, PYMEM_DOMAIN_MEM, PYMEM_DOMAIN_OBJ
+        };
+        for (int i = 0; i < 3; ++i) {
+            PyMemAllocatorEx current;
+            PyMem_GetAllocator(domains[i], &current);
+            // Wrapping our own wrapper would make it call itself
+            if (current.malloc == tracked_malloc) continue;
+
+            g_tracked[i].inner = current;
+            g_tracked[i].stats = stats_for(domains[i]);
+
+            PyMemAllocatorEx wrapper = {
+                &g_tracked[i], tracked_malloc, tracked_calloc, tracked_realloc, tracked_free
+            };
+            PyMem_SetAllocator(domains[i], &wrapper);
+        }
+    }
+
+// =============================================================================
+// mimalloc Backend
+// =============================================================================
+
+#ifdef ENGINE_HAVE_MIMALLOC
+    void* mi_py_malloc(void* ctx, size_t size) {
+        void* p = mi_malloc(size ? size : 1);
+        if (p) static_cast<AtomicDomainStats*>(ctx)->on_alloc(mi_usable_size(p));
+        return p;
+    }
+
+    void* mi_py_calloc(void* ctx, size_t nelem, size_t elsize) {
+        void* p = (nelem && elsize) ? mi_calloc(nelem, elsize) : mi_calloc(1, 1);
+        if (p) static_cast<AtomicDomainStats*>(ctx)->on_alloc(mi_usable_size(p));
+        return p;
+    }
+
+    void* mi_py_realloc(void* ctx, void* ptr, size_t new_size) {
+        auto* stats = static_cast<AtomicDomainStats*>(ctx);
+        size_t old_size = ptr ? mi_usable_size(ptr) : 0;
+        void* p = mi_realloc(ptr, new_size ? new_size : 1);
+        if (p) {
+            if (ptr) stats->on_free(old_size);
+            stats->on_alloc(mi_usable_size(p));
+        }
+        return p;
+    }
+
+    void mi_py_free(void* ctx, void* ptr) {
+        if (!ptr) return;
+        static_cast<AtomicDomainStats*>(ctx)->on_free(mi_usable_size(ptr));
+        mi_free(ptr);
+    }
+
+    void install_mimalloc() {
+        const PyMemAllocatorDomain domains[3] = {
+            PYMEM_DOMAIN_RAW, PYMEM_DOMAIN_MEM, PYMEM_DOMAIN_OBJ
+        };
+        for (PyMemAllocatorDomain domain : domains) {
+            PyMemAllocatorEx alloc = {
+                stats_for(domain), mi_py_malloc, mi_py_calloc, mi_py_realloc, mi_py_free
+            };
+            PyMem_SetAllocator(domain, &alloc);
+        }
+    }
+#endif
+
+} // anonymous namespace
+
+// =============================================================================
+// Public Interface
+// =============================================================================
+
+AllocatorKind install_python_allocator(AllocatorKind requested) {
+    // Blocks from an earlier interpreter may outlive Py_FinalizeEx, so the
+    // hooks can't be swapped (or stacked) on re-init: keep the first choice
+    if (g_installed) return g_kind;
+    g_installed = true;
+
+    if (requested == AllocatorKind::Default) {
+        g_kind = AllocatorKind::Default;
+        return g_kind;
+    }
+
+#ifdef ENGINE_HAVE_MIMALLOC
+    if (requested == AllocatorKind::Mimalloc) {
+        install_mimalloc();
+        g_kind = AllocatorKind::Mimalloc;
+        return g_kind;
+    }
+#endif
+
+    install_tracked();
+    g_kind = AllocatorKind::Tracked;
+    return g_kind;
+}
+
+void* engine_malloc(size_t bytes) {
+#ifdef ENGINE_HAVE_MIMALLOC
+    void* p = mi_malloc(bytes);
+    if (p) g_engine_stats.on_alloc(mi_usable_size(p));
+#else
+    auto* base = static_cast<uint8_t*>(malloc(bytes + TRACK_HEADER));
+    if (!base) return nullptr;
+    *reinterpret_cast<size_t*>(base) = bytes;
+    g_engine_stats.on_alloc(bytes);
+    void* p = base + TRACK_HEADER;
+#endif
+    return p;
+}
+
+void engine_free(void* ptr) {
+    if (!ptr) return;
+#ifdef ENGINE_HAVE_MIMALLOC
+    g_engine_stats.on_free(mi_usable_size(ptr));
+    mi_free(ptr);
+#else
+    uint8_t* base = static_cast<uint8_t*>(ptr) - TRACK_HEADER;
+    g_engine_stats.on_free(*reinterpret_cast<size_t*>(base));
+    free(base);
+#endif
+}
+
+AllocatorStats allocator_stats() {
+    AllocatorStats s;
+    s.kind = g_kind;
+#ifdef ENGINE_HAVE_MIMALLOC
+    s.mimalloc_compiled = true;
+#endif
+    s.raw = g_raw_stats.snapshot();
+    s.mem = g_mem_stats.snapshot();
+    s.obj = g_obj_stats.snapshot();
+    s.engine = g_engine_stats.snapshot();
+    s.thread_heaps = g_thread_heaps.load(std::memory_order_relaxed);
+    s.thread_heap_bytes = g_thread_heap_bytes.load(std::memory_order_relaxed);
+    return s;
+}
+
+const char* allocator_name(AllocatorKind kind) {
+    switch (kind) {
+        case AllocatorKind::Mimalloc: return "mimalloc";
+        case AllocatorKind::Tracked: return "tracked";
+        default: return "default";
+    }
+}
+
+// =============================================================================
+// Thread Heap
+// =============================================================================
+
+namespace {
+
+    constexpr size_t THREAD_HEAP_MIN_BLOCK = size_t(256) << 10;
+    constexpr size_t THREAD_HEAP_ALIGN = 64;
+
+    thread_local int t_scratch_depth = 0;
+
+} // anonymous namespace
+
+ThreadHeap& ThreadHeap::current() {
+    thread_local ThreadHeap heap;
+    return heap;
+}
+
+ThreadHeap::ThreadHeap() {
+#ifdef ENGINE_HAVE_MIMALLOC
+    backend_heap_ = mi_heap_new();
+#endif
+    g_thread_heaps.fetch_add(1, std::memory_order_relaxed);
+}
+
+ThreadHeap::~ThreadHeap() {
+    reset();
+    if (current_.data) {
+        raw_free(current_.data, current_.size);
+    }
+#ifdef ENGINE_HAVE_MIMALLOC
+    if (backend_heap_) mi_heap_delete(static_cast<mi_heap_t*>(backend_heap_));
+#endif
+    g_thread_heaps.fetch_sub(1, std::memory_order_relaxed);
+}
+
+uint8_t* ThreadHeap::raw_alloc(size_t bytes) {
+    uint8_t* p = nullptr;
+#ifdef ENGINE_HAVE_MIMALLOC
+    if (backend_heap_) {
+        p = static_cast<uint8_t*>(mi_heap_malloc_aligned(static_cast<mi_heap_t*>(backend_heap_),
+                                                         bytes, THREAD_HEAP_ALIGN));
+    }
+#endif
+    if (!p) {
+        p = static_cast<uint8_t*>(engine_malloc(bytes));
+    }
+    if (p) g_thread_heap_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    return p;
+}
+
+void ThreadHeap::raw_free(uint8_t* ptr, size_t bytes) {
+    g_thread_heap_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+#ifdef ENGINE_HAVE_MIMALLOC
+    if (backend_heap_) {
+        mi_free(ptr);
+        return;
+    }
+#endif
+    engine_free(ptr);
+}
+
+void* ThreadHeap::alloc(size_t bytes) {
+    bytes = (bytes + THREAD_HEAP_ALIGN - 1) & ~(THREAD_HEAP_ALIGN - 1);
+
+    // engine_malloc only guarantees 16 bytes; align the bump pointer itself
+    uintptr_t base = reinterpret_cast<uintptr_t>(current_.data);
+    size_t aligned = ((base + offset_ + THREAD_HEAP_ALIGN - 1) & ~(uintptr_t(THREAD_HEAP_ALIGN) - 1)) - base;
+
+    if (!current_.data || aligned + bytes > current_.size) {
+        if (current_.data) {
+            retired_.push_back(current_);
+        }
+        size_t size = current_.size * 2;
+        if (size < THREAD_HEAP_MIN_BLOCK) size = THREAD_HEAP_MIN_BLOCK;
+        if (size < bytes + THREAD_HEAP_ALIGN) size = bytes + THREAD_HEAP_ALIGN;
+
+        current_.data = raw_alloc(size);
+        current_.size = current_.data ? size : 0;
+        offset_ = 0;
+        if (!current_.data) return nullptr;
+
+        base = reinterpret_cast<uintptr_t>(current_.data);
+        aligned = ((base + THREAD_HEAP_ALIGN - 1) & ~(uintptr_t(THREAD_HEAP_ALIGN) - 1)) - base;
+    }
+
+    offset_ = aligned + bytes;
+    return current_.data + aligned;
+}
+
+void ThreadHeap::reset() {
+    // The current block is always the largest; older ones are released
+    for (const Block& block : retired_) {
+        raw_free(block.data, block.size);
+    }
+    retired_.clear();
+    offset_ = 0;
+}
+
+ScratchScope::ScratchScope() : heap_(ThreadHeap::current()) {
+    ++t_scratch_depth;
+}
+
+ScratchScope::~ScratchScope() {
+    if (--t_scratch_depth == 0) {
+        heap_.reset();
+    }
+}
+
+} // namespace planter
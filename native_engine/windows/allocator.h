@@ -0,0 +1,114 @@
+/**
+ * @file allocator.h
+ * @brief Planter Pressure - Pluggable Allocator for Interpreter and Engine
+ *
+ * OPTIMIZATIONS:
+ * - mimalloc (when built with it) behind all Python allocator domains
+ * - Engine strings allocated from the same backend
+ * - Per-thread scratch heaps for tile workers (no cross-thread locking)
+ * - Lock-free allocation statistics
+ */
+
+#ifndef PLANTER_PRESSURE_ALLOCATOR_H
+#define PLANTER_PRESSURE_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace planter {
+
+enum class AllocatorKind {
+    Default,   // pymalloc + system malloc, no hooks
+    Mimalloc,  // mimalloc behind RAW/MEM/OBJ
+    Tracked,   // existing allocators wrapped with statistics
+};
+
+struct DomainStats {
+    uint64_t allocs = 0;
+    uint64_t frees = 0;
+    uint64_t bytes_current = 0;
+};
+
+struct AllocatorStats {
+    AllocatorKind kind = AllocatorKind::Default;
+    bool mimalloc_compiled = false;
+    DomainStats raw;
+    DomainStats mem;
+    DomainStats obj;
+    DomainStats engine;
+    uint64_t thread_heaps = 0;
+    uint64_t thread_heap_bytes = 0;
+};
+
+/**
+ * Install the allocator into the Python RAW/MEM/OBJ domains.
+ * MUST be called after Py_PreInitialize and before Py_InitializeFromConfig.
+ * Mimalloc falls back to Tracked when the engine was built without it.
+ * Only the first call per process installs anything; later calls (re-init
+ * after engine_shutdown) keep and return that allocator.
+ *
+ * @return The allocator actually installed
+ */
+AllocatorKind install_python_allocator(AllocatorKind requested);
+
+// Engine-internal allocations (strings returned across the C API)
+void* engine_malloc(size_t bytes);
+void engine_free(void* ptr);
+
+AllocatorStats allocator_stats();
+const char* allocator_name(AllocatorKind kind);
+
+/**
+ * Per-thread bump heap for kernel scratch memory.
+ * Backed by a private mimalloc heap when available. Not thread-safe by
+ * design - each thread only ever touches its own instance.
+ */
+class ThreadHeap {
+public:
+    static ThreadHeap& current();
+
+    void* alloc(size_t bytes);
+
+    // Forget every allocation; keeps the largest block for reuse
+    void reset();
+
+    ~ThreadHeap();
+
+private:
+    ThreadHeap();
+    ThreadHeap(const ThreadHeap&) = delete;
+    ThreadHeap& operator=(const ThreadHeap&) = delete;
+
+    struct Block {
+        uint8_t* data;
+        size_t size;
+    };
+
+    uint8_t* raw_alloc(size_t bytes);
+    void raw_free(uint8_t* ptr, size_t bytes);
+
+    void* backend_heap_ = nullptr;
+    Block current_ = {nullptr, 0};
+    size_t offset_ = 0;
+    std::vector<Block> retired_;
+};
+
+/**
+ * RAII scratch region: everything allocated from the thread heap inside
+ * the outermost scope is released when it ends.
+ */
+class ScratchScope {
+public:
+    ScratchScope();
+    ~ScratchScope();
+
+    void* alloc(size_t bytes) { return heap_.alloc(bytes); }
+
+private:
+    ThreadHeap& heap_;
+};
+
+} // namespace planter
+
+#endif
@@ -0,0 +1,386 @@
+/**
+ * @file decoder.cpp
+ * @brief Planter Pressure - Native Decoders (libpng, libjpeg-turbo, libwebp)
+ */
+
+#include "decoder.h"
+#include "frame_pool.h"
+#include "kernels.h"
+
+#include <algorithm>
+#include <csetjmp>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef ENGINE_HAVE_LIBPNG
+#include <png.h>
+#endif
+
+#ifdef ENGINE_HAVE_LIBJPEG
+#include <jpeglib.h>
+#include <jerror.h>
+#endif
+
+#ifdef ENGINE_HAVE_LIBWEBP
+#include <webp/decode.h>
+#endif
+
+namespace planter {
+
+namespace {
+
+    class InputFile {
+    public:
+        explicit InputFile(const std::string& path) : f_(fopen(path.c_str(), "rb")) {}
+        ~InputFile() { if (f_) fclose(f_); }
+        InputFile(const InputFile&) = delete;
+        InputFile& operator=(const InputFile&) = delete;
+
+        FILE* get() const { return f_; }
+
+    private:
+        FILE* f_;
+    };
+
+    bool acquire_output(DecodedImage& out, int width, int height, std::string& error) {
+        out.width = width;
+        out.height = height;
+        out.stride = frame_stride(width);
+        out.buffer = FramePool::instance().acquire(out.stride * static_cast<size_t>(height));
+        if (!out.buffer) {
+            error = "Out of memory";
+            return false;
+        }
+        return true;
+    }
+
+    void release_output(DecodedImage& out) {
+        if (out.buffer) {
+            FramePool::instance().release(out.buffer);
+            out.buffer = nullptr;
+        }
+    }
+
+// =============================================================================
+// PNG
+// =============================================================================
+
+#ifdef ENGINE_HAVE_LIBPNG
+    void png_error_fn(png_structp png, png_const_charp message) {
+        *static_cast<std::string*>(png_get_error_ptr(png)) = message;
+        png_longjmp(png, 1);
+    }
+
+    void png_warning_fn(png_structp, png_const_charp) {}
+
+    DecodeStatus decode_png(FILE* f, DecodedImage& out, std::string& error) {
+        png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, &error,
+                                                 png_error_fn, png_warning_fn);
+        png_infop info = png ? png_create_info_struct(png) : nullptr;
+        if (!info) {
+            png_destroy_read_struct(&png, nullptr, nullptr);
+            error = "libpng init failed";
+            return DecodeStatus::Error;
+        }
+
+        std::vector<png_bytep> rows;
+        if (setjmp(png_jmpbuf(png))) {
+            release_output(out);
+            png_destroy_read_struct(&png, &info, nullptr);
+            return DecodeStatus::Error;
+        }
+
+        png_init_io(png, f);
+        png_read_info(png, info);
+
+        const int width = static_cast<int>(png_get_image_width(png, info));
+        const int height = static_cast<int>(png_get_image_height(png, info));
+        const int bit_depth = png_get_bit_depth(png, info);
+        const int color_type = png_get_color_type(png, info);
+        const bool color = (color_type & PNG_COLOR_MASK_COLOR) != 0;
+        const bool alpha = (color_type & PNG_COLOR_MASK_ALPHA) != 0;
+        const bool palette = color_type == PNG_COLOR_TYPE_PALETTE;
+
+        // 16-bit gray is "I;16" in Pillow, not something we flatten to RGB
+        if (bit_depth == 16 && color_type == PNG_COLOR_TYPE_GRAY) {
+            png_destroy_read_struct(&png, &info, nullptr);
+            return DecodeStatus::Unsupported;
+        }
+
+        out.format = "PNG";
+        out.mode = palette ? "P" : alpha ? (color || bit_depth == 16 ? "RGBA" : "LA")
+                 : color ? "RGB" : bit_depth == 1 ? "1" : "L";
+        out.original_width = width;
+        out.original_height = height;
+
+        // tRNS is never expanded: Pillow's RGB conversion ignores it too
+        uint8_t lut[256][FRAME_CHANNELS] = {};
+        if (palette) {
+            png_colorp entries = nullptr;
+            int count = 0;
+            png_get_PLTE(png, info, &entries, &count);
+            for (int i = 0; i < 256; ++i) {
+                if (i < count) {
+                    lut[i][0] = entries[i].red;
+                    lut[i][1] = entries[i].green;
+                    lut[i][2] = entries[i].blue;
+                }
+                lut[i][3] = 0xFF;
+            }
+            png_set_packing(png);
+        } else {
+            // Pillow keeps the high byte of 16-bit samples, as strip_16 does
+            if (bit_depth == 16) png_set_strip_16(png);
+            if (bit_depth < 8) png_set_expand_gray_1_2_4_to_8(png);
+            if (!color) png_set_gray_to_rgb(png);
+            if (!alpha) png_set_filler(png, 0xFF, PNG_FILLER_AFTER);
+        }
+        const int passes = png_set_interlace_handling(png);
+        png_read_update_info(png, info);
+
+        if (!acquire_output(out, width, height, error)) {
+            png_destroy_read_struct(&png, &info, nullptr);
+            return DecodeStatus::Error;
+        }
+
+        // Palette indices land in the last quarter of each row and expand forwards
+        const size_t index_offset = palette ? static_cast<size_t>(width) * 3 : 0;
+        rows.resize(height);
+        for (int y = 0; y < height; ++y) {
+            rows[y] = out.buffer->data + static_cast<size_t>(y) * out.stride + index_offset;
+        }
+
+        for (int pass = 0; pass < passes; ++pass) {
+            const bool last = pass == passes - 1;
+            for (int y = 0; y < height; ++y) {
+                png_read_row(png, rows[y], nullptr);
+                if (!last) continue;
+
+                // Flatten epilogue while the row is still in cache
+                uint8_t* row = rows[y] - index_offset;
+                if (palette) {
+                    const uint8_t* indices = rows[y];
+                    for (int x = 0; x < width; ++x) {
+                        memcpy(row + static_cast<size_t>(x) * FRAME_CHANNELS, lut[indices[x]], FRAME_CHANNELS);
+                    }
+                } else if (alpha) {
+                    flatten_alpha_row(row, width);
+                }
+            }
+        }
+        png_read_end(png, nullptr);
+        png_destroy_read_struct(&png, &info, nullptr);
+        return DecodeStatus::Ok;
+    }
+#endif
+
+// =============================================================================
+// JPEG
+// =============================================================================
+
+#ifdef ENGINE_HAVE_LIBJPEG
+    struct JpegError {
+        jpeg_error_mgr mgr;
+        jmp_buf jump;
+        std::string* message;
+    };
+
+    void jpeg_error_exit(j_common_ptr cinfo) {
+        auto* err = reinterpret_cast<JpegError*>(cinfo->err);
+        char buffer[JMSG_LENGTH_MAX];
+        (*cinfo->err->format_message)(cinfo, buffer);
+        *err->message = buffer;
+        longjmp(err->jump, 1);
+    }
+
+    // Warnings are ignored, except truncation, which Pillow also rejects
+    void jpeg_emit_message(j_common_ptr cinfo, int msg_level) {
+        if (msg_level == -1 && cinfo->err->msg_code == JWRN_JPEG_EOF) {
+            jpeg_error_exit(cinfo);
+        }
+    }
+
+    // Largest IDCT reduction that keeps the longer side at least max_dim
+    int jpeg_scale_denom(int width, int height, int max_dim) {
+        if (max_dim <= 0) return 1;
+        for (int denom : {8, 4, 2}) {
+            int longer = std::max((width + denom - 1) / denom, (height + denom - 1) / denom);
+            if (longer >= max_dim) return denom;
+        }
+        return 1;
+    }
+
+    DecodeStatus decode_jpeg(FILE* f, const DecodeOptions& options, DecodedImage& out,
+                             std::string& error) {
+        jpeg_decompress_struct cinfo;
+        JpegError jerr;
+        cinfo.err = jpeg_std_error(&jerr.mgr);
+        jerr.mgr.error_exit = jpeg_error_exit;
+        jerr.mgr.emit_message = jpeg_emit_message;
+        jerr.message = &error;
+
+        if (setjmp(jerr.jump)) {
+            jpeg_destroy_decompress(&cinfo);
+            release_output(out);
+            return DecodeStatus::Error;
+        }
+
+        jpeg_create_decompress(&cinfo);
+        jpeg_stdio_src(&cinfo, f);
+        jpeg_read_header(&cinfo, TRUE);
+
+        // CMYK/YCCK need Adobe inversion handling; leave them to Pillow
+        if (cinfo.num_components != 1 && cinfo.num_components != 3) {
+            jpeg_destroy_decompress(&cinfo);
+            return DecodeStatus::Unsupported;
+        }
+
+        out.format = "JPEG";
+        out.mode = cinfo.num_components == 1 ? "L" : "RGB";
+        out.original_width = static_cast<int>(cinfo.image_width);
+        out.original_height = static_cast<int>(cinfo.image_height);
+        out.scale_denom = jpeg_scale_denom(out.original_width, out.original_height, options.max_dim);
+
+        cinfo.scale_num = 1;
+        cinfo.scale_denom = static_cast<unsigned int>(out.scale_denom);
+#ifdef JCS_EXTENSIONS
+        cinfo.out_color_space = JCS_EXT_RGBX;  // libjpeg-turbo writes X = 0xFF
+#else
+        cinfo.out_color_space = JCS_RGB;
+#endif
+        jpeg_start_decompress(&cinfo);
+
+        if (!acquire_output(out, static_cast<int>(cinfo.output_width),
+                            static_cast<int>(cinfo.output_height), error)) {
+            jpeg_destroy_decompress(&cinfo);
+            return DecodeStatus::Error;
+        }
+
+        while (cinfo.output_scanline < cinfo.output_height) {
+            JSAMPROW row = out.buffer->data + static_cast<size_t>(cinfo.output_scanline) * out.stride;
+            jpeg_read_scanlines(&cinfo, &row, 1);
+#ifndef JCS_EXTENSIONS
+            // Widen RGB to RGBX in place, back to front
+            for (int x = out.width - 1; x >= 0; --x) {
+                uint8_t* px = row + static_cast<size_t>(x) * FRAME_CHANNELS;
+                const uint8_t* rgb = row + static_cast<size_t>(x) * 3;
+                uint8_t r = rgb[0], g = rgb[1], b = rgb[2];
+                px[0] = r; px[1] = g; px[2] = b; px[3] = 0xFF;
+            }
+#endif
+        }
+
+        jpeg_finish_decompress(&cinfo);
+        jpeg_destroy_decompress(&cinfo);
+        return DecodeStatus::Ok;
+    }
+#endif
+
+// =============================================================================
+// WebP
+// =============================================================================
+
+#ifdef ENGINE_HAVE_LIBWEBP
+    DecodeStatus decode_webp(FILE* f, DecodedImage& out, std::string& error) {
+        std::vector<uint8_t> data;
+        uint8_t chunk[1 << 16];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+            data.insert(data.end(), chunk, chunk + n);
+        }
+
+        WebPBitstreamFeatures features;
+        if (WebPGetFeatures(data.data(), data.size(), &features) != VP8_STATUS_OK) {
+            error = "Corrupt WebP header";
+            return DecodeStatus::Error;
+        }
+        if (features.has_animation) {
+            return DecodeStatus::Unsupported;
+        }
+
+        out.format = "WEBP";
+        out.mode = features.has_alpha ? "RGBA" : "RGB";
+        out.original_width = features.width;
+        out.original_height = features.height;
+        if (!acquire_output(out, features.width, features.height, error)) {
+            return DecodeStatus::Error;
+        }
+
+        // Opaque sources decode with alpha = 0xFF, i.e. straight into RGBX
+        if (!WebPDecodeRGBAInto(data.data(), data.size(), out.buffer->data,
+                                out.stride * static_cast<size_t>(out.height), static_cast<int>(out.stride))) {
+            release_output(out);
+            error = "WebP decode failed";
+            return DecodeStatus::Error;
+        }
+        if (features.has_alpha) {
+            for (int y = 0; y < out.height; ++y) {
+                flatten_alpha_row(out.buffer->data + static_cast<size_t>(y) * out.stride, out.width);
+            }
+        }
+        return DecodeStatus::Ok;
+    }
+#endif
+
+} // anonymous namespace
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+DecodeStatus decode_image(const std::string& path, const DecodeOptions& options,
+                          DecodedImage& out, std::string& error) {
+    out = DecodedImage();
+
+    InputFile file(path);
+    if (!file.get()) {
+        error = "Cannot open file";
+        return DecodeStatus::Error;
+    }
+
+    uint8_t sig[12] = {};
+    const size_t n = fread(sig, 1, sizeof(sig), file.get());
+    rewind(file.get());
+
+#ifdef ENGINE_HAVE_LIBPNG
+    if (n >= 8 && png_sig_cmp(sig, 0, 8) == 0) {
+        return decode_png(file.get(), out, error);
+    }
+#endif
+#ifdef ENGINE_HAVE_LIBJPEG
+    if (n >= 3 && sig[0] == 0xFF && sig[1] == 0xD8 && sig[2] == 0xFF) {
+        return decode_jpeg(file.get(), options, out, error);
+    }
+#endif
+#ifdef ENGINE_HAVE_LIBWEBP
+    if (n >= 12 && memcmp(sig, "RIFF", 4) == 0 && memcmp(sig + 8, "WEBP", 4) == 0) {
+        return decode_webp(file.get(), out, error);
+    }
+#endif
+
+    (void)options;
+    (void)n;
+    return DecodeStatus::Unsupported;
+}
+
+const char* native_decoders() {
+    static const std::string list = [] {
+        std::string s;
+#ifdef ENGINE_HAVE_LIBPNG
+        s += "png,";
+#endif
+#ifdef ENGINE_HAVE_LIBJPEG
+        s += "jpeg,";
+#endif
+#ifdef ENGINE_HAVE_LIBWEBP
+        s += "webp,";
+#endif
+        if (!s.empty()) s.pop_back();
+        return s;
+    }();
+    return list.c_str();
+}
+
+} // namespace planter
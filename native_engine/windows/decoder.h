@@ -0,0 +1,60 @@
+/**
+ * @file decoder.h
+ * @brief Planter Pressure - Native Decoders (libpng, libjpeg-turbo, libwebp)
+ *
+ * OPTIMIZATIONS:
+ * - Rows decoded straight into pooled RGBX frames (no Pillow image, no tobytes copy)
+ * - JPEG previews use 1/2, 1/4 or 1/8 scaled IDCT (up to 64x fewer pixels decoded)
+ * - P/RGBA/LA flattened to RGB in the row epilogue (palette LUT, SSE2 blend onto
+ *   white); palette indices are unpacked inside the frame itself
+ * - Each codec is optional at build time; anything unsupported falls back to Pillow
+ */
+
+#ifndef PLANTER_PRESSURE_DECODER_H
+#define PLANTER_PRESSURE_DECODER_H
+
+#include <cstddef>
+#include <string>
+
+namespace planter {
+
+struct FrameBuffer;
+
+enum class DecodeStatus {
+    Ok,
+    Unsupported,   // format/codec/pixel layout not handled natively; use Pillow
+    Error,         // recognised but corrupt or unreadable
+};
+
+struct DecodeOptions {
+    // If > 0, decode may shrink (JPEG: scaled IDCT) while the longer side stays >= max_dim
+    int max_dim = 0;
+};
+
+struct DecodedImage {
+    FrameBuffer* buffer = nullptr;  // pooled, owned by the caller on Ok
+    int width = 0;                  // decoded geometry
+    int height = 0;
+    size_t stride = 0;
+    int original_width = 0;         // size stored in the file
+    int original_height = 0;
+    int scale_denom = 1;            // JPEG IDCT scale actually used
+    std::string format;             // "PNG", "JPEG", "WEBP"
+    std::string mode;               // Pillow mode of the source
+};
+
+/**
+ * Decode `path` into a pooled RGBX frame (X = 255). Palette and alpha
+ * sources come out flattened onto white, matching Pillow's
+ * `paste(img, mask=alpha)` rounding; tRNS chunks are ignored.
+ * On Unsupported/Error no buffer is held; `error` is set for Error.
+ */
+DecodeStatus decode_image(const std::string& path, const DecodeOptions& options,
+                          DecodedImage& out, std::string& error);
+
+// Comma-separated codecs compiled in, e.g. "png,jpeg"
+const char* native_decoders();
+
+} // namespace planter
+
+#endif
@@ -7,14 +7,25 @@
  * - Proper GIL handling for thread safety
  * - Clean error propagation
  * - No data copying - path-only communication
+ * - Batch manifests parsed natively and streamed to job workers
+ * - Identical concurrent requests coalesced onto one in-flight call
+ * - Prefetch hints decode or process ahead at idle priority; real requests adopt the work
+ * - Manifest jobs pipelined: decode, filter and encode of neighbouring jobs overlap
+ * - Thread counts and frame budgets sized from cgroup/affinity limits, re-checked while running
  */
 
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
 
 #include <string>
+#include <memory>
 #include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <thread>
+#include <chrono>
 #include <cstring>
+#include <cstddef>
 #include <cstdlib>
 #include <cstdio>
 
@@ -23,9 +34,25 @@
 #endif
 
 #include "engine.h"
+#include "allocator.h"
+#include "decoder.h"
+#include "frame_pool.h"
+#include "jobs.h"
+#include "json_util.h"
+#include "native_module.h"
+#include "plugins.h"
+#include "prefetch.h"
+#include "probe.h"
+#include "progress.h"
+#include "resources.h"
+#include "singleflight.h"
+#include "thread_pool.h"
 
 static const char* ENGINE_VERSION = "2.0.0-optimized";
 
+// How often CPU/memory limits are re-read (containers and VDI hosts resize them live)
+static const std::chrono::milliseconds RESOURCE_RECHECK(5000);
+
 // =============================================================================
 // Global State (Thread-Safe)
 // =============================================================================
@@ -36,16 +63,71 @@ namespace {
         bool initialized = false;
         PyObject* py_module = nullptr;
         PyObject* py_process_func = nullptr;
-        std::string last_error;
+        PyObject* py_process_tuple_func = nullptr;
+        PyObject* py_process_frame_func = nullptr;
+        PyObject* py_batch_decode_func = nullptr;
+        PyObject* py_batch_filter_func = nullptr;
+        PyObject* py_batch_encode_func = nullptr;
+        PyThreadState* main_thread_state = nullptr;
+        uint64_t max_input_pixels = ENGINE_DEFAULT_MAX_INPUT_PIXELS;
+        bool auto_job_workers = true;   // job_workers was 0: follow the CPU limit
         std::mutex mutex;
+
+        // Calls currently inside Python; shutdown waits for them to drain
+        int active_calls = 0;
+        bool shutting_down = false;
+        std::condition_variable calls_drained;
     };
 
     EngineState g_state;
 
+    // Outcome of one process_image_tuple call, shared with coalesced callers
+    struct TupleOutcome {
+        int status = ENGINE_STATUS_OK;
+        EngineResult result;
+    };
+
+    planter::SingleFlight<std::string> g_json_flight;
+    planter::SingleFlight<TupleOutcome> g_tuple_flight;
+
+    // Per thread: calls from several isolates run concurrently, and each
+    // reads the error of the call it just made
+    thread_local std::string t_last_error;
+
     void set_error(const std::string& error) {
-        g_state.last_error = error;
+        t_last_error = error;
     }
 
+    /**
+     * Admits one processing call without holding g_state.mutex for its
+     * duration, so calls from several isolates overlap (the GIL still
+     * serializes pure-Python sections; native stages release it).
+     */
+    class CallScope {
+    public:
+        CallScope() {
+            std::lock_guard<std::mutex> lock(g_state.mutex);
+            admitted_ = g_state.initialized && !g_state.shutting_down;
+            if (admitted_) ++g_state.active_calls;
+        }
+
+        ~CallScope() {
+            if (!admitted_) return;
+            std::lock_guard<std::mutex> lock(g_state.mutex);
+            if (--g_state.active_calls == 0) {
+                g_state.calls_drained.notify_all();
+            }
+        }
+
+        CallScope(const CallScope&) = delete;
+        CallScope& operator=(const CallScope&) = delete;
+
+        bool admitted() const { return admitted_; }
+
+    private:
+        bool admitted_ = false;
+    };
+
     std::string get_python_error() {
         if (!PyErr_Occurred()) {
             return "Unknown Python error";
@@ -79,7 +161,7 @@ namespace {
 // Allocate string that caller must free
     char* alloc_string(const std::string& str) {
         size_t len = str.length() + 1;
-        char* result = static_cast<char*>(malloc(len));
+        char* result = static_cast<char*>(planter::engine_malloc(len));
         if (result) {
             memcpy(result, str.c_str(), len);
         }
@@ -87,19 +169,29 @@ namespace {
     }
 
     std::string make_error_json(const std::string& error) {
-        std::string escaped;
-        escaped.reserve(error.size() + 20);
-        for (char c : error) {
-            switch (c) {
-                case '"': escaped += "\\\""; break;
-                case '\\': escaped += "\\\\"; break;
-                case '\n': escaped += "\\n"; break;
-                case '\r': escaped += "\\r"; break;
-                case '\t': escaped += "\\t"; break;
-                default: escaped += c;
-            }
-        }
-        return "{\"status\":\"error\",\"error\":\"" + escaped + "\"}";
+        return "{\"status\":\"error\",\"error\":\"" + planter::json_escape(error) + "\"}";
+    }
+
+    std::string domain_json(const planter::DomainStats& d) {
+        return "{\"allocs\":" + std::to_string(d.allocs)
+             + ",\"frees\":" + std::to_string(d.frees)
+             + ",\"bytes_current\":" + std::to_string(d.bytes_current) + "}";
+    }
+
+    std::string allocator_stats_json() {
+        planter::AllocatorStats a = planter::allocator_stats();
+        std::string json = "{\"kind\":\"";
+        json += planter::allocator_name(a.kind);
+        json += "\",\"mimalloc_compiled\":";
+        json += a.mimalloc_compiled ? "true" : "false";
+        json += ",\"raw\":" + domain_json(a.raw);
+        json += ",\"mem\":" + domain_json(a.mem);
+        json += ",\"obj\":" + domain_json(a.obj);
+        json += ",\"engine\":" + domain_json(a.engine);
+        json += ",\"thread_heaps\":" + std::to_string(a.thread_heaps);
+        json += ",\"thread_heap_bytes\":" + std::to_string(a.thread_heap_bytes);
+        json += "}";
+        return json;
     }
 
     bool load_python_from_zip(const char* zip_path) {
@@ -132,9 +224,666 @@ namespace {
             return false;
         }
 
+        // Binary ABI entry point is optional; process_image_binary reports its absence
+        g_state.py_process_tuple_func = PyObject_GetAttrString(g_state.py_module, "process_image_tuple");
+        if (!g_state.py_process_tuple_func || !PyCallable_Check(g_state.py_process_tuple_func)) {
+            Py_XDECREF(g_state.py_process_tuple_func);
+            g_state.py_process_tuple_func = nullptr;
+            PyErr_Clear();
+        }
+
+        // Pixel output entry point is optional too
+        g_state.py_process_frame_func = PyObject_GetAttrString(g_state.py_module, "process_image_frame");
+        if (!g_state.py_process_frame_func || !PyCallable_Check(g_state.py_process_frame_func)) {
+            Py_XDECREF(g_state.py_process_frame_func);
+            g_state.py_process_frame_func = nullptr;
+            PyErr_Clear();
+        }
+
+        // Stage entry points for pipelined batches; all three or none
+        PyObject** stages[] = {&g_state.py_batch_decode_func, &g_state.py_batch_filter_func,
+                               &g_state.py_batch_encode_func};
+        const char* stage_names[] = {"batch_decode", "batch_filter", "batch_encode"};
+        bool pipelined = true;
+        for (int i = 0; i < 3; ++i) {
+            *stages[i] = PyObject_GetAttrString(g_state.py_module, stage_names[i]);
+            if (!*stages[i] || !PyCallable_Check(*stages[i])) pipelined = false;
+        }
+        if (!pipelined) {
+            for (PyObject** stage : stages) Py_CLEAR(*stage);
+            PyErr_Clear();
+        }
+
         return true;
     }
 
+    void clear_python_funcs() {
+        Py_CLEAR(g_state.py_process_func);
+        Py_CLEAR(g_state.py_process_tuple_func);
+        Py_CLEAR(g_state.py_process_frame_func);
+        Py_CLEAR(g_state.py_batch_decode_func);
+        Py_CLEAR(g_state.py_batch_filter_func);
+        Py_CLEAR(g_state.py_batch_encode_func);
+        Py_CLEAR(g_state.py_module);
+    }
+
+    // Native filter libraries first, so Python plug-ins can see their ops
+    bool load_plugins(const char* plugin_dir) {
+        std::string error;
+        if (!planter::PluginRegistry::instance().load_directory(plugin_dir, error)) {
+            set_error("Plug-in load error: " + error);
+            return false;
+        }
+
+        PyObject* result = PyObject_CallMethod(g_state.py_module, "load_plugins", "s", plugin_dir);
+        if (!result) {
+            set_error("Plug-in load error: " + get_python_error());
+            planter::PluginRegistry::instance().unload();
+            return false;
+        }
+        Py_DECREF(result);
+        return true;
+    }
+
+    // Copy into a fixed-size field; false if it had to be truncated
+    bool copy_field(char* dst, size_t capacity, const char* src) {
+        size_t len = src ? strlen(src) : 0;
+        bool fits = len < capacity;
+        if (!fits) len = capacity - 1;
+        if (len) memcpy(dst, src, len);
+        dst[len] = '\0';
+        return fits;
+    }
+
+    int fail_result(EngineResult* result, int status, const std::string& error) {
+        result->status = status;
+        copy_field(result->error, sizeof(result->error), error.c_str());
+        return status;
+    }
+
+    /**
+     * Unpack process_image_tuple's return value into an EngineResult.
+     * Must be called with the GIL held.
+     */
+    int fill_result(PyObject* py_result, EngineResult* result) {
+        int ok = 0;
+        const char* output_path = nullptr;
+        const char* original_mode = nullptr;
+        const char* error = nullptr;
+        unsigned long long output_size = 0;
+        PyObject* stages = nullptr;
+
+        if (!PyArg_ParseTuple(py_result, "ps(ii)s(ii)KOs",
+                              &ok, &output_path,
+                              &result->original_width, &result->original_height,
+                              &original_mode,
+                              &result->output_width, &result->output_height,
+                              &output_size, &stages, &error)) {
+            return fail_result(result, ENGINE_STATUS_ERROR, "Bad result tuple: " + get_python_error());
+        }
+
+        if (!ok) {
+            return fail_result(result, ENGINE_STATUS_ERROR, error);
+        }
+
+        result->output_size_bytes = output_size;
+        copy_field(result->original_mode, sizeof(result->original_mode), original_mode);
+
+        Py_ssize_t count = PyTuple_Check(stages) ? PyTuple_GET_SIZE(stages) : 0;
+        for (Py_ssize_t i = 0; i < count && i < ENGINE_STAGE_COUNT; ++i) {
+            result->stage_ms[i] = PyFloat_AsDouble(PyTuple_GET_ITEM(stages, i));
+        }
+        PyErr_Clear();
+
+        if (!copy_field(result->output_path, sizeof(result->output_path), output_path)) {
+            return fail_result(result, ENGINE_STATUS_TRUNCATED, "Output path exceeds ENGINE_PATH_MAX");
+        }
+
+        result->status = ENGINE_STATUS_OK;
+        return ENGINE_STATUS_OK;
+    }
+
+    // Hand the final frame's pooled buffer to the caller (GIL held)
+    int take_frame(PyObject* py_frame, EngineResult* result, EngineFrame* frame) {
+        int width = 0;
+        int height = 0;
+        size_t stride = 0;
+        planter::FrameBuffer* buffer = planter::detach_frame(py_frame, &width, &height, &stride);
+        if (!buffer) {
+            return fail_result(result, ENGINE_STATUS_ERROR, "No output frame: " + get_python_error());
+        }
+
+        frame->width = width;
+        frame->height = height;
+        frame->stride = static_cast<uint32_t>(stride);
+        frame->pixels = buffer->data;
+        frame->handle = buffer;
+        return ENGINE_STATUS_OK;
+    }
+
+    // A coalesced caller did no work itself; close out its progress stages
+    void report_shared_progress() {
+        planter::ProgressSink sink = planter::current_progress();
+        for (int stage = 0; stage < ENGINE_STAGE_COUNT; ++stage) {
+            sink.report(stage, 1, 1);
+        }
+    }
+
+    /**
+     * Run process_image_tuple (or process_image_frame when `frame` is given)
+     * and unpack into result. Acquires the GIL itself; result must already
+     * be zeroed.
+     */
+    int invoke_process_tuple(const char* input_path, const char* output_dir,
+                           float sharpness, float contrast, bool overlay,
+                           EngineResult* result,
+                           EngineFrame* frame = nullptr, bool encode = true) {
+        PyGILState_STATE gstate = PyGILState_Ensure();
+
+        PyObject* py_output_dir = nullptr;
+        if (output_dir && output_dir[0] != '\0') {
+            py_output_dir = PyUnicode_FromString(output_dir);
+        } else {
+            py_output_dir = Py_None;
+            Py_INCREF(py_output_dir);
+        }
+
+        PyObject* py_result = nullptr;
+        if (py_output_dir && frame) {
+            py_result = PyObject_CallFunction(
+                    g_state.py_process_frame_func, "sOddOO",
+                    input_path,
+                    py_output_dir,
+                    static_cast<double>(sharpness),
+                    static_cast<double>(contrast),
+                    overlay ? Py_True : Py_False,
+                    encode ? Py_True : Py_False
+            );
+        } else if (py_output_dir) {
+            py_result = PyObject_CallFunction(
+                    g_state.py_process_tuple_func, "sOddO",
+                    input_path,
+                    py_output_dir,
+                    static_cast<double>(sharpness),
+                    static_cast<double>(contrast),
+                    overlay ? Py_True : Py_False
+            );
+        }
+        Py_XDECREF(py_output_dir);
+
+        int status;
+        if (!py_result) {
+            status = fail_result(result, ENGINE_STATUS_ERROR, get_python_error());
+        } else if (frame) {
+            // (result_tuple, frame_or_None)
+            PyObject* tuple = nullptr;
+            PyObject* py_frame = nullptr;
+            if (!PyArg_ParseTuple(py_result, "OO", &tuple, &py_frame)) {
+                status = fail_result(result, ENGINE_STATUS_ERROR, "Bad result tuple: " + get_python_error());
+            } else {
+                status = fill_result(tuple, result);
+                if (status == ENGINE_STATUS_OK) {
+                    status = take_frame(py_frame, result, frame);
+                }
+            }
+            Py_DECREF(py_result);
+        } else {
+            status = fill_result(py_result, result);
+            Py_DECREF(py_result);
+        }
+
+        PyGILState_Release(gstate);
+        return status;
+    }
+
+    /**
+     * invoke_process_tuple, coalesced with identical calls in flight.
+     * Pixel output is never shared: each caller owns the frame it gets.
+     */
+    int call_process_tuple(const char* input_path, const char* output_dir,
+                           float sharpness, float contrast, bool overlay,
+                           EngineResult* result,
+                           EngineFrame* frame = nullptr, bool encode = true) {
+        if (frame) {
+            return invoke_process_tuple(input_path, output_dir, sharpness, contrast, overlay,
+                                        result, frame, encode);
+        }
+
+        std::string key = planter::input_identity(input_path);
+        if (!key.empty()) {
+            char params[64];
+            snprintf(params, sizeof(params), "|%.9g|%.9g|%d|", sharpness, contrast, overlay ? 1 : 0);
+            key += params;
+            key += output_dir ? output_dir : "";
+        }
+
+        bool follower = false;
+        TupleOutcome outcome = g_tuple_flight.run(key, [&] {
+            TupleOutcome own;
+            memset(&own.result, 0, sizeof(own.result));
+            own.result.struct_size = sizeof(own.result);
+            own.status = invoke_process_tuple(input_path, output_dir, sharpness, contrast,
+                                              overlay, &own.result);
+            return own;
+        }, &follower);
+        if (follower) report_shared_progress();
+
+        uint32_t result_size = result->struct_size;
+        *result = outcome.result;
+        result->struct_size = result_size;
+        return outcome.status;
+    }
+
+    // Shared body of process_image_binary / process_image_pixels
+    int run_request(const EngineRequest* request, EngineResult* result, EngineFrame* frame) {
+        if (!result || result->struct_size < sizeof(EngineResult)) {
+            return ENGINE_STATUS_INVALID_REQUEST;
+        }
+
+        // Start from a clean result; keep the caller-declared size
+        uint32_t result_size = result->struct_size;
+        memset(result, 0, sizeof(EngineResult));
+        result->struct_size = result_size;
+
+        // Requests predating the progress fields are still accepted
+        if (!request || request->struct_size < offsetof(EngineRequest, progress) ||
+            request->abi_version != ENGINE_ABI_VERSION) {
+            return fail_result(result, ENGINE_STATUS_INVALID_REQUEST, "Unsupported request ABI");
+        }
+
+        if (!request->input_path || request->input_path[0] == '\0') {
+            return fail_result(result, ENGINE_STATUS_INVALID_REQUEST, "Missing input_path");
+        }
+
+        CallScope call;
+
+        if (!call.admitted()) {
+            return fail_result(result, ENGINE_STATUS_NOT_INITIALIZED, "Engine not initialized");
+        }
+
+        if (!g_state.py_process_tuple_func) {
+            return fail_result(result, ENGINE_STATUS_ERROR, "No binary process function");
+        }
+
+        if (frame && !g_state.py_process_frame_func) {
+            return fail_result(result, ENGINE_STATUS_ERROR, "No pixel process function");
+        }
+
+        // Header probe: refuse oversized inputs before Python decodes them
+        std::string too_large;
+        uint64_t pixels = 0;
+        if (!planter::admit_image(request->input_path, g_state.max_input_pixels, pixels, too_large)) {
+            return fail_result(result, ENGINE_STATUS_TOO_LARGE, too_large);
+        }
+
+        planter::ProgressSink sink;
+        if (request->struct_size >= sizeof(EngineRequest)) {
+            sink.fn = request->progress;
+            sink.user_data = request->progress_user_data;
+        }
+        planter::ProgressScope progress(sink);
+
+        return call_process_tuple(
+                request->input_path,
+                request->output_dir,
+                request->sharpness > 0.f ? request->sharpness : 1.5f,
+                request->contrast > 0.f ? request->contrast : 1.2f,
+                (request->flags & ENGINE_REQUEST_NO_OVERLAY) == 0,
+                result,
+                frame,
+                (request->flags & ENGINE_REQUEST_SKIP_ENCODE) == 0
+        );
+    }
+
+    bool is_success(const std::string& json) {
+        static const char SUCCESS_PREFIX[] = "{\"status\": \"success\"";
+        return json.compare(0, sizeof(SUCCESS_PREFIX) - 1, SUCCESS_PREFIX) == 0;
+    }
+
+    // process_image_json for one request; acquires the GIL itself
+    std::string call_process_json(const char* input_json) {
+        PyGILState_STATE gstate = PyGILState_Ensure();
+
+        PyObject* py_input = PyUnicode_FromString(input_json);
+        if (!py_input) {
+            std::string err = get_python_error();
+            PyGILState_Release(gstate);
+            return make_error_json(err);
+        }
+
+        PyObject* py_result = PyObject_CallFunctionObjArgs(
+                g_state.py_process_func, py_input, nullptr
+        );
+        Py_DECREF(py_input);
+
+        if (!py_result) {
+            std::string err = get_python_error();
+            PyGILState_Release(gstate);
+            return make_error_json(err);
+        }
+
+        const char* result_str = PyUnicode_AsUTF8(py_result);
+        std::string json = result_str ? result_str : make_error_json("Result conversion failed");
+
+        Py_DECREF(py_result);
+        PyGILState_Release(gstate);
+        return json;
+    }
+
+    // Job outcome from a process_image_json result
+    planter::JobOutcome outcome_from_json(const std::string& json) {
+        planter::JobOutcome outcome;
+        planter::JsonReader r(json.data(), json.size());
+        std::string key;
+        std::string status;
+        bool done = false;
+        if (!r.begin_object()) {
+            outcome.error = "Bad result: " + r.error();
+            return outcome;
+        }
+        while (r.next_key(key, done) && !done) {
+            bool ok = key == "status" ? r.read_string(status)
+                    : key == "output_image_path" ? r.read_string(outcome.output_path)
+                    : key == "error" ? r.read_string(outcome.error)
+                    : r.skip_value();
+            if (!ok) break;
+        }
+        outcome.ok = status == "success";
+        if (!outcome.ok && outcome.error.empty()) {
+            outcome.error = r.error().empty() ? "Processing failed" : "Bad result: " + r.error();
+        }
+        return outcome;
+    }
+
+    // Executor for queued jobs (manifest batches); runs on job worker threads
+    planter::JobOutcome run_job(const planter::Job& job) {
+        planter::JobOutcome outcome;
+
+        EngineResult result;
+        memset(&result, 0, sizeof(result));
+        result.struct_size = sizeof(result);
+
+        if (job.request_json.empty() && !g_state.py_process_tuple_func) {
+            outcome.error = "No binary process function";
+            return outcome;
+        }
+
+        // Preview follow-ups yield to interactive calls
+        if (job.priority == planter::JobPriority::Background) {
+            std::unique_lock<std::mutex> lock(g_state.mutex);
+            g_state.calls_drained.wait(lock, [] {
+                return g_state.active_calls == 0 || g_state.shutting_down;
+            });
+            if (g_state.shutting_down) {
+                outcome.error = "Engine shutting down";
+                return outcome;
+            }
+        }
+
+        if (!job.request_json.empty()) {
+            return outcome_from_json(call_process_json(job.request_json.c_str()));
+        }
+
+        int status = call_process_tuple(job.input_path.c_str(), job.output_dir.c_str(),
+                                        job.sharpness, job.contrast, job.overlay, &result);
+        outcome.ok = status == ENGINE_STATUS_OK;
+        if (outcome.ok) {
+            outcome.output_path = result.output_path;
+        } else {
+            outcome.error = result.error;
+        }
+        return outcome;
+    }
+
+    // =========================================================================
+    // Pipelined batch stages
+    // =========================================================================
+
+    // Python object a job carries between stages; dropping it takes the GIL
+    std::shared_ptr<void> hold_stage_object(PyObject* obj) {
+        return std::shared_ptr<void>(obj, [](void* p) {
+            PyGILState_STATE gstate = PyGILState_Ensure();
+            Py_DECREF(static_cast<PyObject*>(p));
+            PyGILState_Release(gstate);
+        });
+    }
+
+    /**
+     * Call a batch_* stage (args stolen) and unpack its (value, error)
+     * result. Returns a new reference to value, or nullptr with
+     * outcome.error set. Caller holds the GIL.
+     */
+    PyObject* call_stage(PyObject* func, PyObject* args, planter::StagedJob& staged) {
+        if (!args) {
+            staged.outcome.error = get_python_error();
+            return nullptr;
+        }
+        PyObject* py_result = PyObject_CallObject(func, args);
+        Py_DECREF(args);
+        if (!py_result) {
+            staged.outcome.error = "Processing failed: " + get_python_error();
+            return nullptr;
+        }
+
+        PyObject* value = nullptr;
+        PyObject* error = nullptr;
+        if (!PyArg_ParseTuple(py_result, "OO", &value, &error)) {
+            staged.outcome.error = "Bad stage result: " + get_python_error();
+            value = nullptr;
+        } else if (value == Py_None) {
+            const char* message = error != Py_None ? PyUnicode_AsUTF8(error) : nullptr;
+            staged.outcome.error = message ? message : "Processing failed";
+            PyErr_Clear();
+            value = nullptr;
+        } else {
+            Py_INCREF(value);
+        }
+        Py_DECREF(py_result);
+        return value;
+    }
+
+    bool decode_stage(planter::StagedJob& staged) {
+        PyGILState_STATE gstate = PyGILState_Ensure();
+        PyObject* source = call_stage(g_state.py_batch_decode_func,
+                                      Py_BuildValue("(s)", staged.job.input_path.c_str()), staged);
+        PyGILState_Release(gstate);
+        if (!source) return false;
+        staged.state = hold_stage_object(source);
+        return true;
+    }
+
+    bool filter_stage(planter::StagedJob& staged) {
+        const planter::Job& job = staged.job;
+        PyObject* source = static_cast<PyObject*>(staged.state.get());
+
+        PyGILState_STATE gstate = PyGILState_Ensure();
+        PyObject* image = call_stage(g_state.py_batch_filter_func,
+                                     Py_BuildValue("(sOddO)", job.input_path.c_str(), source,
+                                                   static_cast<double>(job.sharpness),
+                                                   static_cast<double>(job.contrast),
+                                                   job.overlay ? Py_True : Py_False),
+                                     staged);
+        PyGILState_Release(gstate);
+
+        // The filter consumed its source either way
+        staged.state.reset();
+        if (!image) return false;
+        staged.state = hold_stage_object(image);
+        return true;
+    }
+
+    bool encode_stage(planter::StagedJob& staged) {
+        const planter::Job& job = staged.job;
+        PyObject* image = static_cast<PyObject*>(staged.state.get());
+
+        PyGILState_STATE gstate = PyGILState_Ensure();
+        PyObject* args = job.output_dir.empty()
+                ? Py_BuildValue("(OsO)", image, job.input_path.c_str(), Py_None)
+                : Py_BuildValue("(Oss)", image, job.input_path.c_str(), job.output_dir.c_str());
+        PyObject* path = call_stage(g_state.py_batch_encode_func, args, staged);
+        const char* output_path = path ? PyUnicode_AsUTF8(path) : nullptr;
+        if (path && !output_path) staged.outcome.error = get_python_error();
+        if (output_path) {
+            staged.outcome.ok = true;
+            staged.outcome.output_path = output_path;
+        }
+        Py_XDECREF(path);
+        PyGILState_Release(gstate);
+        return staged.outcome.ok;
+    }
+
+    planter::JobPipeline batch_pipeline() {
+        if (!g_state.py_batch_decode_func) return planter::JobPipeline();
+        return planter::JobPipeline{decode_stage, filter_stage, encode_stage};
+    }
+
+    /**
+     * Queue a successful preview's full-resolution follow-up, if it asked
+     * for one. The follow-up replays the whole request minus "preview", so
+     * it produces what the approved preview showed at full size.
+     */
+    void attach_follow_up(std::string& json, const char* input_json, planter::Job follow_up,
+                          const planter::PreviewOptions& preview) {
+        if (preview.max_dim <= 0 || !preview.follow_up || follow_up.input_path.empty() ||
+            !is_success(json)) {
+            return;
+        }
+
+        follow_up.priority = planter::JobPriority::Background;
+        std::string error;
+        uint64_t batch_id = 0;
+        if (planter::canonical_json(input_json, strlen(input_json), follow_up.request_json,
+                                    error, "preview")) {
+            batch_id = planter::JobSystem::instance().submit_job(std::move(follow_up), error);
+        }
+
+        // Splice the batch id in before the closing brace
+        size_t end = json.rfind('}');
+        if (end != std::string::npos) {
+            json.insert(end, batch_id
+                    ? ", \"follow_up_batch_id\": " + std::to_string(batch_id)
+                    : ", \"follow_up_error\": \"" + planter::json_escape(error) + "\"");
+        }
+    }
+
+    /**
+     * Key shared by identical JSON requests: input file identity plus the
+     * canonical request (key order and whitespace don't matter). Empty if
+     * either is unavailable, which disables coalescing and prefetch pickup.
+     */
+    std::string request_key(const std::string& input_path, const char* json, size_t size) {
+        std::string identity = planter::input_identity(input_path);
+        std::string canonical;
+        std::string error;
+        if (identity.empty() || !planter::canonical_json(json, size, canonical, error)) {
+            return std::string();
+        }
+        return "request|" + identity + "\n" + canonical;
+    }
+
+    // Top-level "speculate" flag of engine_prefetch params
+    bool read_speculate(const char* json, size_t size) {
+        planter::JsonReader r(json, size);
+        if (!r.begin_object()) return false;
+        std::string key;
+        bool done = false;
+        bool speculate = false;
+        while (r.next_key(key, done) && !done) {
+            bool ok = key == "speculate" && r.peek() != 'n' ? r.read_bool(speculate) : r.skip_value();
+            if (!ok) return false;
+        }
+        return speculate;
+    }
+
+    // Pull a file through the OS cache when no native decoder can take it
+    void read_through(const std::string& path) {
+        FILE* f = fopen(path.c_str(), "rb");
+        if (!f) return;
+        static thread_local char chunk[1 << 16];
+        while (fread(chunk, 1, sizeof(chunk), f) == sizeof(chunk)) {
+        }
+        fclose(f);
+    }
+
+    /**
+     * Fit the tile pool and frame pool to the CPUs and memory the process
+     * may use. Idle frames get at most 1/8 of a memory limit.
+     */
+    // Queued jobs run on worker threads that take the GIL per job
+    int auto_job_workers(const planter::ResourceLimits& limits) {
+        return std::max(1, std::min(4, limits.cpus));
+    }
+
+    void apply_resource_limits(const planter::ResourceLimits& limits) {
+        planter::TilePool::instance().set_max_helpers(limits.cpus - 1);
+        if (g_state.auto_job_workers) {
+            planter::JobSystem::instance().resize_workers(auto_job_workers(limits));
+        }
+
+        uint64_t budget = planter::DEFAULT_IDLE_BUDGET;
+        if (limits.memory_limit) budget = std::min<uint64_t>(budget, limits.memory_limit / 8);
+        planter::FramePool::instance().set_idle_budget(static_cast<size_t>(budget));
+    }
+
+    // Prefetch gate: no call in flight; false once shutdown has begun
+    bool wait_idle() {
+        std::unique_lock<std::mutex> lock(g_state.mutex);
+        g_state.calls_drained.wait(lock, [] {
+            return g_state.active_calls == 0 || g_state.shutting_down;
+        });
+        return !g_state.shutting_down;
+    }
+
+    /**
+     * Runs on the prefetch thread. Decode-only tasks stay native (no GIL);
+     * speculative ones run the whole request into a staging directory and
+     * stop at the next stage boundary once cancelled. Follow-up jobs are
+     * left to the adopter.
+     */
+    bool run_prefetch(planter::PrefetchTask& task, planter::PrefetchResult& result) {
+        CallScope call;
+        if (!call.admitted() || task.cancelled) return false;
+
+        uint64_t pixels = 0;
+        std::string too_large;
+        if (!planter::admit_image(task.path, g_state.max_input_pixels, pixels, too_large)) {
+            return false;
+        }
+
+        if (task.request_json.empty()) {
+            planter::DecodeOptions options;
+            options.max_dim = task.max_dim;
+            std::string error;
+            if (planter::decode_image(task.path, options, result.image, error) ==
+                planter::DecodeStatus::Ok) {
+                return true;
+            }
+            read_through(task.path);
+            return false;
+        }
+
+        // Outputs go to a staging directory until a real request adopts them
+        planter::Job job;
+        planter::PreviewOptions preview;
+        std::string request;
+        std::string error;
+        if (!planter::parse_request(task.request_json.data(), task.request_json.size(),
+                                    job, preview, error) ||
+            !planter::canonical_json(task.request_json.data(), task.request_json.size(),
+                                     request, error, "output_dir")) {
+            return false;
+        }
+        result.staging_dir = planter::prefetch_staging_dir(job.output_dir, task.id);
+        request = "{\"output_dir\":\"" + planter::json_escape(result.staging_dir) + "\"" +
+                  (request.size() > 2 ? "," + request.substr(1) : std::string("}"));
+
+        planter::ProgressSink sink;
+        sink.cancel = &task.cancelled;
+        planter::ProgressScope scope(sink);
+        result.json = call_process_json(request.c_str());
+        return is_success(result.json);
+    }
+
 } // anonymous namespace
 
 // =============================================================================
@@ -144,6 +893,11 @@ namespace {
 extern "C" {
 
 ENGINE_API int engine_init(const char* python_home, const char* assets_path) {
+    return engine_init_ex(python_home, assets_path, nullptr);
+}
+
+ENGINE_API int engine_init_ex(const char* python_home, const char* assets_path,
+                              const EngineInitOptions* options) {
     std::lock_guard<std::mutex> lock(g_state.mutex);
 
     if (g_state.initialized) {
@@ -167,6 +921,38 @@ ENGINE_API int engine_init(const char* python_home, const char* assets_path) {
 #endif
     }
 
+    // Copy only the fields the caller knows about
+    EngineInitOptions opts = {};
+    opts.struct_size = sizeof(EngineInitOptions);
+    if (options) {
+        memcpy(&opts, options, std::min<size_t>(options->struct_size, sizeof(EngineInitOptions)));
+    }
+
+    planter::FramePool::instance().set_huge_pages((opts.flags & ENGINE_FLAG_HUGE_PAGES) != 0);
+
+    // Built-in modules must be registered before the interpreter starts
+    if (planter::register_native_module() != 0) {
+        set_error("Native module registration failed");
+        return 2;
+    }
+
+    // Allocators must be swapped between pre-initialization and initialization
+    PyPreConfig preconfig;
+    PyPreConfig_InitPythonConfig(&preconfig);
+    PyStatus pre_status = Py_PreInitialize(&preconfig);
+    if (PyStatus_Exception(pre_status)) {
+        set_error("Python pre-init failed");
+        return 2;
+    }
+
+    planter::AllocatorKind allocator = planter::AllocatorKind::Default;
+    if (opts.allocator == ENGINE_ALLOCATOR_MIMALLOC) {
+        allocator = planter::AllocatorKind::Mimalloc;
+    } else if (opts.allocator == ENGINE_ALLOCATOR_TRACKED) {
+        allocator = planter::AllocatorKind::Tracked;
+    }
+    planter::install_python_allocator(allocator);
+
     // Initialize Python
     PyConfig config;
     PyConfig_InitPythonConfig(&config);
@@ -190,6 +976,32 @@ ENGINE_API int engine_init(const char* python_home, const char* assets_path) {
         return 3;
     }
 
+    if (opts.plugin_dir && opts.plugin_dir[0] != '\0' && !load_plugins(opts.plugin_dir)) {
+        clear_python_funcs();
+        Py_FinalizeEx();
+        return 3;
+    }
+
+    // Sized from the CPUs we may use; the tile pool and (unless set
+    // explicitly) the job workers follow later changes
+    g_state.auto_job_workers = opts.job_workers == 0;
+    planter::ResourceLimits limits =
+            planter::ResourceMonitor::instance().start(RESOURCE_RECHECK, apply_resource_limits);
+    int workers = opts.job_workers ? static_cast<int>(opts.job_workers) : auto_job_workers(limits);
+    g_state.max_input_pixels = opts.max_input_pixels ? opts.max_input_pixels
+                                                     : ENGINE_DEFAULT_MAX_INPUT_PIXELS;
+    planter::JobSystem::instance().configure(workers, g_state.max_input_pixels, run_job,
+                                             batch_pipeline());
+    planter::JobSystem::instance().configure_queue(
+            opts.queue_capacity ? opts.queue_capacity : ENGINE_DEFAULT_QUEUE_CAPACITY,
+            opts.queue_policy == ENGINE_QUEUE_REJECT      ? planter::QueueFullPolicy::Reject
+            : opts.queue_policy == ENGINE_QUEUE_DROP_OLDEST ? planter::QueueFullPolicy::DropOldest
+                                                            : planter::QueueFullPolicy::Block);
+    planter::Prefetcher::instance().configure(run_prefetch, wait_idle);
+
+    // Release the GIL so any thread (Dart isolates, job workers) can take it
+    g_state.main_thread_state = PyEval_SaveThread();
+
     g_state.initialized = true;
     return 0;
 }
@@ -200,9 +1012,15 @@ ENGINE_API int engine_is_initialized(void) {
 }
 
 ENGINE_API const char* process_image(const char* input_json) {
-    std::lock_guard<std::mutex> lock(g_state.mutex);
+    return process_image_with_progress(input_json, nullptr, nullptr);
+}
+
+ENGINE_API const char* process_image_with_progress(const char* input_json,
+                                                   EngineProgressCallback progress,
+                                                   void* user_data) {
+    CallScope call;
 
-    if (!g_state.initialized) {
+    if (!call.admitted()) {
         return alloc_string(make_error_json("Engine not initialized"));
     }
 
@@ -214,67 +1032,323 @@ ENGINE_API const char* process_image(const char* input_json) {
         return alloc_string(make_error_json("No process function"));
     }
 
-    // Acquire GIL for thread safety
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    // Native pass over the request for admission and "preview.follow_up";
+    // malformed JSON is left for Python to report
+    planter::Job follow_up;
+    planter::PreviewOptions preview;
+    std::string parse_error;
+    if (!planter::parse_request(input_json, strlen(input_json), follow_up, preview, parse_error)) {
+        follow_up.input_path.clear();
+        preview.follow_up = false;
+    }
 
-    PyObject* py_input = PyUnicode_FromString(input_json);
-    if (!py_input) {
-        std::string err = get_python_error();
-        PyGILState_Release(gstate);
-        return alloc_string(make_error_json(err));
+    if (!follow_up.input_path.empty()) {
+        std::string too_large;
+        if (!planter::admit_image(follow_up.input_path, g_state.max_input_pixels,
+                                  follow_up.pixels, too_large)) {
+            return alloc_string(make_error_json(too_large));
+        }
     }
 
-    PyObject* py_result = PyObject_CallFunctionObjArgs(
-            g_state.py_process_func, py_input, nullptr
-    );
-    Py_DECREF(py_input);
+    // Python runs on this thread; the sink follows it into planter_native
+    planter::ProgressScope scope({progress, user_data});
 
-    if (!py_result) {
-        std::string err = get_python_error();
-        PyGILState_Release(gstate);
-        return alloc_string(make_error_json(err));
+    std::string key;
+    if (!follow_up.input_path.empty()) {
+        key = request_key(follow_up.input_path, input_json, strlen(input_json));
+    }
+
+    // Speculative result from engine_prefetch first; otherwise identical
+    // requests in flight share one call (and one follow-up)
+    std::string result;
+    bool shared = planter::Prefetcher::instance().adopt_result(key, result);
+    if (shared) {
+        attach_follow_up(result, input_json, follow_up, preview);
+    } else {
+        result = g_json_flight.run(key, [&] {
+            std::string json = call_process_json(input_json);
+            attach_follow_up(json, input_json, follow_up, preview);
+            return json;
+        }, &shared);
+    }
+    if (shared) report_shared_progress();
+
+    return alloc_string(result);
+}
+
+ENGINE_API int process_image_binary(const EngineRequest* request, EngineResult* result) {
+    return run_request(request, result, nullptr);
+}
+
+ENGINE_API int process_image_pixels(const EngineRequest* request, EngineResult* result,
+                                    EngineFrame* frame) {
+    if (!frame || frame->struct_size < sizeof(EngineFrame)) {
+        return ENGINE_STATUS_INVALID_REQUEST;
+    }
+
+    uint32_t frame_size = frame->struct_size;
+    memset(frame, 0, sizeof(EngineFrame));
+    frame->struct_size = frame_size;
+
+    return run_request(request, result, frame);
+}
+
+ENGINE_API void engine_release_frame(void* handle) {
+    if (handle) {
+        planter::FramePool::instance().release(static_cast<planter::FrameBuffer*>(handle));
+    }
+}
+
+ENGINE_API int64_t engine_submit_manifest(const char* manifest_path, const char* results_path) {
+    std::lock_guard<std::mutex> lock(g_state.mutex);
+
+    if (!g_state.initialized || g_state.shutting_down) {
+        set_error("Engine not initialized");
+        return 0;
+    }
+
+    if (!manifest_path) {
+        set_error("Manifest path required");
+        return 0;
+    }
+
+    // Only spawns the reader thread; parsing and processing happen off this lock
+    std::string error;
+    uint64_t batch_id = planter::JobSystem::instance().submit_manifest(
+            manifest_path, results_path ? results_path : "", error);
+    if (batch_id == 0) {
+        set_error(error);
+    }
+    return static_cast<int64_t>(batch_id);
+}
+
+ENGINE_API int64_t engine_prefetch(const char* path, const char* params_json) {
+    {
+        std::lock_guard<std::mutex> lock(g_state.mutex);
+        if (!g_state.initialized || g_state.shutting_down) {
+            set_error("Engine not initialized");
+            return 0;
+        }
     }
 
-    const char* result_str = PyUnicode_AsUTF8(py_result);
-    char* result_copy = nullptr;
+    if (!path || path[0] == '\0') {
+        set_error("Prefetch path required");
+        return 0;
+    }
+
+    auto task = std::make_shared<planter::PrefetchTask>();
+    task->path = path;
+
+    bool speculate = false;
+    if (params_json && params_json[0] != '\0') {
+        size_t size = strlen(params_json);
+        planter::Job job;
+        planter::PreviewOptions preview;
+        std::string error;
+        if (!planter::parse_request(params_json, size, job, preview, error)) {
+            set_error("Invalid prefetch params: " + error);
+            return 0;
+        }
+        if (!job.input_path.empty()) {
+            set_error("Prefetch params must not contain input_image_path");
+            return 0;
+        }
+        task->max_dim = preview.max_dim;
+
+        // The request as process_image will see it: params plus the input path
+        std::string params;
+        if (!planter::canonical_json(params_json, size, params, error, "speculate")) {
+            set_error("Invalid prefetch params: " + error);
+            return 0;
+        }
+        speculate = read_speculate(params_json, size);
+        task->request_json = "{\"input_image_path\":\"" + planter::json_escape(path) + "\"" +
+                             (params.size() > 2 ? "," + params.substr(1) : std::string("}"));
+    }
 
-    if (result_str) {
-        result_copy = alloc_string(result_str);
+    if (speculate) {
+        task->key = request_key(path, task->request_json.data(), task->request_json.size());
     } else {
-        result_copy = alloc_string(make_error_json("Result conversion failed"));
+        task->request_json.clear();
+        task->key = planter::decode_key(path, task->max_dim);
+    }
+    if (task->key.empty()) {
+        set_error("Cannot read " + std::string(path));
+        return 0;
+    }
+
+    uint64_t id = planter::Prefetcher::instance().submit(std::move(task));
+    if (id == 0) {
+        set_error("Prefetch not available");
+    }
+    return static_cast<int64_t>(id);
+}
+
+ENGINE_API int engine_prefetch_cancel(int64_t prefetch_id) {
+    if (prefetch_id <= 0) return 0;
+    return planter::Prefetcher::instance().cancel(static_cast<uint64_t>(prefetch_id)) ? 1 : 0;
+}
+
+ENGINE_API const char* engine_batch_status(int64_t batch_id) {
+    std::string status = planter::JobSystem::instance().batch_status(static_cast<uint64_t>(batch_id));
+    if (status.empty()) {
+        return alloc_string(make_error_json("Unknown batch"));
+    }
+    return alloc_string(status);
+}
+
+ENGINE_API const char* engine_probe_image(const char* path) {
+    if (!path) {
+        return alloc_string(make_error_json("Path required"));
+    }
+
+    planter::ImageInfo info;
+    std::string error;
+    if (!planter::probe_image(path, info, error)) {
+        return alloc_string(make_error_json(error));
+    }
+    return alloc_string("{\"status\":\"success\"," + planter::image_info_json(info) + "}");
+}
+
+ENGINE_API const char* engine_probe_images(const char* paths_json) {
+    if (!paths_json) {
+        return alloc_string(make_error_json("Null input"));
     }
 
-    Py_DECREF(py_result);
-    PyGILState_Release(gstate);
+    planter::JsonReader r(paths_json, strlen(paths_json));
+    if (!r.begin_array()) {
+        return alloc_string(make_error_json("Expected an array of paths: " + r.error()));
+    }
+
+    std::string json = "{\"status\":\"success\",\"results\":[";
+    std::string path;
+    bool done = false;
+    for (size_t i = 0;; ++i) {
+        if (!r.next_element(done)) return alloc_string(make_error_json(r.error()));
+        if (done) break;
+        if (!r.read_string(path)) return alloc_string(make_error_json(r.error()));
+
+        if (i > 0) json += ',';
+        json += "{\"input_image_path\":\"" + planter::json_escape(path) + "\"";
 
-    return result_copy;
+        planter::ImageInfo info;
+        std::string error;
+        if (planter::probe_image(path, info, error)) {
+            json += ",\"status\":\"success\"," + planter::image_info_json(info) + "}";
+        } else {
+            json += ",\"status\":\"error\",\"error\":\"" + planter::json_escape(error) + "\"}";
+        }
+    }
+    json += "]}";
+    return alloc_string(json);
 }
 
 ENGINE_API void free_string(const char* str) {
     if (str) {
-        free(const_cast<char*>(str));
+        planter::engine_free(const_cast<char*>(str));
     }
 }
 
 ENGINE_API void engine_shutdown(void) {
-    std::lock_guard<std::mutex> lock(g_state.mutex);
+    std::unique_lock<std::mutex> lock(g_state.mutex);
+
+    if (!g_state.initialized || g_state.shutting_down) return;
+
+    // Refuse new calls and let in-flight ones (other isolates) finish; a
+    // running speculation counts as one, so stop it instead of waiting it out
+    g_state.shutting_down = true;
+    lock.unlock();
+    planter::Prefetcher::instance().stop();
+    lock.lock();
+    g_state.calls_drained.wait(lock, [] { return g_state.active_calls == 0; });
+
+    // Workers call into Python; stop them before tearing the interpreter down.
+    // Unlocked so background jobs waiting on calls_drained can bail out.
+    g_state.calls_drained.notify_all();
+    lock.unlock();
+    planter::ResourceMonitor::instance().stop();
+    planter::JobSystem::instance().shutdown();
+    planter::Prefetcher::instance().shutdown();
+    lock.lock();
 
-    if (!g_state.initialized) return;
+    if (g_state.main_thread_state) {
+        PyEval_RestoreThread(g_state.main_thread_state);
+        g_state.main_thread_state = nullptr;
+    }
 
-    Py_XDECREF(g_state.py_process_func);
-    Py_XDECREF(g_state.py_module);
-    g_state.py_process_func = nullptr;
-    g_state.py_module = nullptr;
+    clear_python_funcs();
 
     if (Py_IsInitialized()) {
         Py_FinalizeEx();
     }
+    planter::PluginRegistry::instance().unload();
+
+    // All frames are back in the pool once the interpreter is gone
+    planter::TilePool::instance().shutdown();
+    planter::FramePool::instance().trim();
 
     g_state.initialized = false;
+    g_state.shutting_down = false;
+}
+
+ENGINE_API const char* engine_get_stats(void) {
+    planter::FramePoolStats pool = planter::FramePool::instance().stats();
+
+    std::string json = "{\"frame_pool\":{";
+    json += "\"acquires\":" + std::to_string(pool.acquires);
+    json += ",\"hits\":" + std::to_string(pool.hits);
+    json += ",\"misses\":" + std::to_string(pool.misses);
+    json += ",\"bytes_live\":" + std::to_string(pool.bytes_live);
+    json += ",\"bytes_idle\":" + std::to_string(pool.bytes_idle);
+    json += ",\"buffers_idle\":" + std::to_string(pool.buffers_idle);
+    json += ",\"huge_page_bytes\":" + std::to_string(pool.huge_page_bytes);
+    json += ",\"hugetlb_bytes\":" + std::to_string(pool.hugetlb_bytes);
+    json += ",\"huge_page_fallbacks\":" + std::to_string(pool.huge_page_fallbacks);
+    json += "},\"allocator\":" + allocator_stats_json();
+    json += ",\"tile_threads\":" + std::to_string(planter::TilePool::instance().thread_count());
+    json += ",\"tile_steals\":" + std::to_string(planter::TilePool::instance().steal_count());
+
+    planter::ResourceLimits limits = planter::ResourceMonitor::instance().current();
+    char quota[32];
+    snprintf(quota, sizeof(quota), "%.2f", limits.quota_cpus);
+    json += ",\"resources\":{\"cpus\":" + std::to_string(limits.cpus);
+    json += ",\"hardware_cpus\":" + std::to_string(limits.hardware_cpus);
+    json += ",\"affinity_cpus\":" + std::to_string(limits.affinity_cpus);
+    json += ",\"quota_cpus\":" + std::string(quota);
+    json += ",\"memory_limit\":" + std::to_string(limits.memory_limit) + "}";
+
+    static const char* const POLICY_NAMES[] = {"block", "reject", "drop_oldest"};
+    planter::JobQueueStats jobs = planter::JobSystem::instance().queue_stats();
+    json += ",\"jobs\":{\"policy\":\"" + std::string(POLICY_NAMES[static_cast<int>(jobs.policy)]) + "\"";
+    json += ",\"capacity\":" + std::to_string(jobs.capacity);
+    json += ",\"depth\":" + std::to_string(jobs.depth);
+    json += ",\"blocked\":" + std::to_string(jobs.blocked);
+    json += ",\"rejected\":" + std::to_string(jobs.rejected);
+    json += ",\"dropped\":" + std::to_string(jobs.dropped);
+    json += ",\"retry_after_ms\":" + std::to_string(jobs.retry_after_ms) + "}";
+    json += ",\"native_decoders\":\"" + std::string(planter::native_decoders()) + "\"";
+    json += ",\"native_ops\":[";
+    const auto& filters = planter::PluginRegistry::instance().filters();
+    for (size_t i = 0; i < filters.size(); ++i) {
+        json += (i ? ",\"" : "\"") + std::string(filters[i]->name) + "\"";
+    }
+    json += "]";
+    planter::SingleFlightStats json_calls = g_json_flight.stats();
+    planter::SingleFlightStats tuple_calls = g_tuple_flight.stats();
+    json += ",\"coalesced\":{\"leaders\":" + std::to_string(json_calls.leaders + tuple_calls.leaders);
+    json += ",\"followers\":" + std::to_string(json_calls.followers + tuple_calls.followers) + "}";
+    planter::PrefetchStats prefetch = planter::Prefetcher::instance().stats();
+    json += ",\"prefetch\":{\"submitted\":" + std::to_string(prefetch.submitted);
+    json += ",\"completed\":" + std::to_string(prefetch.completed);
+    json += ",\"cancelled\":" + std::to_string(prefetch.cancelled);
+    json += ",\"hits\":" + std::to_string(prefetch.hits) + "}";
+    json += "}";
+
+    return alloc_string(json);
 }
 
 ENGINE_API const char* engine_get_last_error(void) {
-    return g_state.last_error.c_str();
+    return t_last_error.c_str();
 }
 
 ENGINE_API const char* engine_get_version(void) {
@@ -285,10 +1359,11 @@ ENGINE_API const char* engine_get_version(void) {
 
 #ifdef _WIN32
 BOOL APIENTRY DllMain(HMODULE hModule, DWORD reason, LPVOID lpReserved) {
+    (void)lpReserved;
+    // No engine_shutdown() here: it joins worker threads, which would wait
+    // on the loader lock we hold. Callers shut down before unloading.
     if (reason == DLL_PROCESS_ATTACH) {
         DisableThreadLibraryCalls(hModule);
-    } else if (reason == DLL_PROCESS_DETACH && lpReserved == nullptr) {
-        engine_shutdown();
     }
     return TRUE;
 }
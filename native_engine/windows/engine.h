@@ -21,10 +21,51 @@
 #define ENGINE_API __attribute__((visibility("default")))
 #endif
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// =============================================================================
+// Init Options
+// =============================================================================
+
+/** Back large frame buffers with huge pages (hugetlbfs/THP), falling back to heap. */
+#define ENGINE_FLAG_HUGE_PAGES 0x1u
+
+/** Allocator installed behind the interpreter's RAW/MEM/OBJ domains. */
+#define ENGINE_ALLOCATOR_DEFAULT  0u  /* pymalloc + system malloc, untouched */
+#define ENGINE_ALLOCATOR_MIMALLOC 1u  /* mimalloc; falls back to TRACKED if not built in */
+#define ENGINE_ALLOCATOR_TRACKED  2u  /* existing allocators wrapped with statistics */
+
+/** What a full job queue does with a new manifest entry or preview follow-up. */
+#define ENGINE_QUEUE_BLOCK       0u  /* manifest readers wait for room; follow-ups are rejected */
+#define ENGINE_QUEUE_REJECT      1u  /* the new job fails with "retry_after_ms" */
+#define ENGINE_QUEUE_DROP_OLDEST 2u  /* the oldest queued entry of another manifest fails instead; follow-ups are rejected */
+
+/** Jobs each queue lane (manifest entries, follow-ups) holds by default. */
+#define ENGINE_DEFAULT_QUEUE_CAPACITY 1024u
+
+/** Inputs with more pixels are rejected from their header (Pillow's bomb error threshold). */
+#define ENGINE_DEFAULT_MAX_INPUT_PIXELS 178956970ull
+
+/**
+ * Optional settings for engine_init_ex.
+ * Set struct_size = sizeof(EngineInitOptions) so older/newer callers stay compatible;
+ * fields beyond struct_size keep their defaults.
+ */
+typedef struct EngineInitOptions {
+    uint32_t struct_size;
+    uint32_t flags;          /* ENGINE_FLAG_* */
+    uint32_t allocator;      /* ENGINE_ALLOCATOR_*; fixed by the first init of the process */
+    uint32_t job_workers;    /* threads running queued jobs (per stage when pipelined; follow-ups get one more); 0 = auto (from usable CPUs, re-checked) */
+    uint64_t max_input_pixels; /* admission limit; 0 = ENGINE_DEFAULT_MAX_INPUT_PIXELS, UINT64_MAX = none */
+    const char* plugin_dir;  /* filter plug-ins loaded at init (see below); NULL = none */
+    uint32_t queue_capacity; /* jobs per queue lane, rounded up to a power of two; 0 = default */
+    uint32_t queue_policy;   /* ENGINE_QUEUE_* */
+} EngineInitOptions;
+
 /**
  * Initialize the Python engine.
  * MUST be called once before any processing.
@@ -35,23 +76,322 @@ extern "C" {
  */
 ENGINE_API int engine_init(const char* python_home, const char* script_path);
 
+/**
+ * Initialize the Python engine with options.
+ * Same as engine_init when options is NULL.
+ *
+ * Plug-ins: shared libraries in options->plugin_dir (.dll; .so/.dylib
+ * elsewhere) implementing planter_plugin.h add native filters that requests
+ * apply via "ops" (see process_image). Then every `*.py` there is imported
+ * after the processing module, in name order. A Python plug-in registers hooks with
+ * `image_processor.register_hook(stage, fn)`; `fn(frame, context)` then runs
+ * on the pooled frame ("pre_filter": decoded pixels, "post_filter": after
+ * the native filter chain). `numpy.asarray(frame)` is a writable
+ * (height, width, 4) RGBX view of engine memory, so hooks edit in place
+ * without a Pillow round trip. A plug-in that fails to load fails init.
+ *
+ * @param python_home Path to Python installation (NULL for system Python)
+ * @param script_path Path to process.py script
+ * @param options Init options (may be NULL)
+ * @return 0 on success, non-zero on failure
+ */
+ENGINE_API int engine_init_ex(const char* python_home, const char* script_path,
+                              const EngineInitOptions* options);
+
 /**
  * Check if engine is initialized.
  * @return 1 if initialized, 0 otherwise
  */
 ENGINE_API int engine_is_initialized(void);
 
+/**
+ * Progress event for one call. `done`/`total` count units of work within
+ * `stage` (ENGINE_STAGE_*): tile bands for the filter stage, 1 otherwise.
+ * done == total marks the stage finished.
+ *
+ * May be invoked from engine worker threads while the call is running;
+ * it must be thread-safe and must not call back into the engine.
+ */
+typedef void (*EngineProgressCallback)(void* user_data, int32_t stage, int32_t done, int32_t total);
+
 /**
  * Process an image file.
  *
  * Input JSON: {"input_image_path": "C:/path/input.png"}
  * Output JSON: {"status": "success", "output_image_path": "C:/path/output.png"}
  *
+ * Preview: {"input_image_path": "...", "preview": {"max_dim": 512, "follow_up": true}}
+ * processes a downscaled proxy (JPEG decoded at reduced DCT scale) and returns
+ * quickly. With follow_up the same request without "preview" (ops, variants,
+ * pyramid and siblings included) is queued at background priority and the
+ * output gains "follow_up_batch_id" (poll engine_batch_status; its
+ * "output_image_path" is set once done).
+ *
+ * Native plug-in filters: {"input_image_path": "...", "ops": [{"op": "denoise",
+ * "strength": 0.8}]} runs each op, in order, on the tile pool after the
+ * built-in filter chain. Unnamed parameters take their defaults; unknown
+ * ops or out-of-range values fail the request.
+ *
+ * Variants: {"input_image_path": "...", "variants": [{"name": "soft",
+ * "sharpness": 1.0}, {"name": "crisp", "sharpness": 2.5, "ops": [...]}]}
+ * decodes once and renders every variant from the shared source in parallel,
+ * one output file each. Unset variant settings take the top-level values.
+ * The output gains "variants": [{"name", "output_image_path",
+ * "output_dimensions", "output_size_bytes", "timings_ms"}] in request order;
+ * "output_image_path" is the first variant's. Not combinable with roi,
+ * pyramid or siblings.
+ *
+ * Inputs whose header reports more than max_input_pixels pixels fail with
+ * "Image too large" before anything is decoded.
+ *
+ * May be called concurrently from several threads/isolates after init;
+ * engine_shutdown waits for in-flight calls to return. A call whose JSON
+ * equals one already in flight once canonicalized (object keys sorted at
+ * every level, whitespace dropped, numbers compared by value: {"a":1.0,
+ * "b":2} matches { "b": 2, "a": 1 }), for an unchanged input file (same
+ * size and mtime), waits for that call and returns the same result
+ * (same output file and follow-up batch); its progress callback only sees
+ * each stage complete.
+ *
  * @param input_json JSON string with input parameters
  * @return JSON string (MUST be freed with free_string!)
  */
 ENGINE_API const char* process_image(const char* input_json);
 
+/**
+ * process_image, reporting stage and tile progress through `progress`
+ * (may be NULL) while the call runs.
+ */
+ENGINE_API const char* process_image_with_progress(const char* input_json,
+                                                   EngineProgressCallback progress,
+                                                   void* user_data);
+
+// =============================================================================
+// Binary ABI (alternative to JSON for high-rate callers)
+// =============================================================================
+
+#define ENGINE_ABI_VERSION 1
+
+#define ENGINE_PATH_MAX 1024
+#define ENGINE_ERROR_MAX 256
+
+/** EngineRequest.flags */
+#define ENGINE_REQUEST_NO_OVERLAY    0x1u
+#define ENGINE_REQUEST_SKIP_ENCODE   0x2u  /* process_image_pixels only: write no file */
+
+/** EngineResult.status / process_image_binary return value */
+#define ENGINE_STATUS_OK              0
+#define ENGINE_STATUS_ERROR           1
+#define ENGINE_STATUS_INVALID_REQUEST 2
+#define ENGINE_STATUS_NOT_INITIALIZED 3
+#define ENGINE_STATUS_TRUNCATED       4  /* output path exceeded ENGINE_PATH_MAX */
+#define ENGINE_STATUS_TOO_LARGE       5  /* input exceeds max_input_pixels (from its header) */
+
+/** Indices into EngineResult.stage_ms */
+#define ENGINE_STAGE_DECODE  0
+#define ENGINE_STAGE_FILTER  1
+#define ENGINE_STAGE_OVERLAY 2
+#define ENGINE_STAGE_ENCODE  3
+#define ENGINE_STAGE_COUNT   4
+
+/**
+ * Request for process_image_binary. Strings are borrowed for the call only.
+ * Zero-initialize, then set struct_size = sizeof(EngineRequest) and
+ * abi_version = ENGINE_ABI_VERSION.
+ */
+typedef struct EngineRequest {
+    uint32_t struct_size;
+    uint32_t abi_version;
+    const char* input_path;
+    const char* output_dir;   /* NULL = system temp directory */
+    uint32_t flags;           /* ENGINE_REQUEST_* */
+    float sharpness;          /* 0 = default (1.5) */
+    float contrast;           /* 0 = default (1.2) */
+
+    /* Optional; read only when struct_size covers them */
+    EngineProgressCallback progress;
+    void* progress_user_data;
+} EngineRequest;
+
+/**
+ * Result filled by process_image_binary. Caller-owned; nothing to free.
+ * Set struct_size = sizeof(EngineResult) before the call.
+ */
+typedef struct EngineResult {
+    uint32_t struct_size;
+    int32_t status;                     /* ENGINE_STATUS_* */
+    int32_t original_width;
+    int32_t original_height;
+    int32_t output_width;
+    int32_t output_height;
+    uint64_t output_size_bytes;
+    double stage_ms[ENGINE_STAGE_COUNT];
+    char original_mode[8];
+    char output_path[ENGINE_PATH_MAX];
+    char error[ENGINE_ERROR_MAX];
+} EngineResult;
+
+/**
+ * Process an image without any JSON marshalling.
+ * Same pipeline as process_image; reusable request/result structs make
+ * the call allocation-free on the caller side.
+ *
+ * Coalesced like process_image: a request matching one in flight (same
+ * input file, settings, flags and output_dir), including a preview
+ * follow-up job, shares that call's result. Manifest jobs run in stages
+ * (see engine_submit_manifest) and are not shared.
+ *
+ * @param request Request parameters
+ * @param result Filled on return (also on failure, with error set)
+ * @return ENGINE_STATUS_* (same as result->status)
+ */
+ENGINE_API int process_image_binary(const EngineRequest* request, EngineResult* result);
+
+// =============================================================================
+// Batch Manifests
+// =============================================================================
+
+/**
+ * Queue every entry of a manifest file for processing.
+ * The manifest is parsed natively on a background thread and streamed into
+ * the job queue; this call returns immediately.
+ *
+ * When the job queue is full, EngineInitOptions.queue_policy applies: the
+ * reader waits (default), or the entry fails with "retry_after_ms" in its
+ * results line, or the oldest queued entry fails with "Dropped: job
+ * queue full" to make room. A manifest never evicts its own entries: when
+ * the oldest is its own, the reader waits.
+ *
+ * Jobs are pipelined: decode, filter and encode run on separate workers
+ * with a short hand-off queue between them, so while one image is being
+ * filtered the next is decoding and the previous one encoding. Results
+ * may therefore complete slightly out of order.
+ *
+ * Manifest JSON: [{"input_image_path": "...", "output_dir": "...", "sharpness": 1.5}, ...]
+ *            or: {"output_dir": "...", "overlay": false, "items": [ ...entries or paths... ]}
+ *
+ * @param manifest_path Path to the manifest
+ * @param results_path JSON Lines file receiving one result per entry (NULL = none)
+ * @return Batch id (> 0), or 0 on failure (see engine_get_last_error)
+ */
+ENGINE_API int64_t engine_submit_manifest(const char* manifest_path, const char* results_path);
+
+/**
+ * Progress of a batch.
+ *
+ * Output JSON: {"batch_id": 1, "submitted": 10, "completed": 8, "failed": 1,
+ *               "pixels_total": 96000000, "pixels_done": 80000000,
+ *               "parsing": false, "done": false}
+ *
+ * Entries are probed as they are read: oversized inputs fail without being
+ * queued, and pixels_* (summed from headers) give cost-weighted progress.
+ *
+ * The status of the 256 most recently finished batches (manifests and
+ * follow-ups) is kept; older ones report "Unknown batch".
+ *
+ * @return JSON string (MUST be freed with free_string!)
+ */
+ENGINE_API const char* engine_batch_status(int64_t batch_id);
+
+// =============================================================================
+// Prefetch Hints
+// =============================================================================
+
+/**
+ * Hint that a request for `path` is probably coming (hover, selection).
+ * Returns immediately; the work runs on one background thread, only while
+ * no other call is in flight, newest hint first.
+ *
+ * params_json NULL: decode the file at full resolution into a pooled frame.
+ * Otherwise it is the request process_image will get, minus
+ * "input_image_path"; the decode matches its "preview.max_dim", and with
+ * "speculate": true the whole request runs and its result is kept:
+ *
+ *   engine_prefetch("C:/scans/a.png", "{\"preview\": {\"max_dim\": 512}, \"speculate\": true}")
+ *
+ * The real call picks the work up: process_image with an equivalent request
+ * (same members, any order) for the unchanged file returns the kept result,
+ * or waits for the running speculation; any request decoding that file at
+ * that size takes the prefetched frame. Each result is used once. Only a few
+ * are kept; older ones are dropped. A repeated hint returns the id already
+ * planned. Speculative outputs are written to a hidden ".planter-prefetch-<id>"
+ * directory inside output_dir and moved into output_dir only when adopted;
+ * dropped or cancelled results delete theirs.
+ *
+ * @return Prefetch id (> 0), or 0 on failure (see engine_get_last_error)
+ */
+ENGINE_API int64_t engine_prefetch(const char* path, const char* params_json);
+
+/**
+ * Withdraw a hint: queued work is dropped, kept results (and their staged
+ * files) are freed, and a running speculation stops at its next stage
+ * boundary (unless a real call is already waiting on it).
+ * @return 1 if something was cancelled, 0 if the id is unknown or finished
+ */
+ENGINE_API int engine_prefetch_cancel(int64_t prefetch_id);
+
+// =============================================================================
+// Image Probe
+// =============================================================================
+
+/**
+ * Read an image's header only: no decode, no Python, no init required.
+ * Understands PNG, JPEG, TIFF, WebP, GIF and BMP.
+ *
+ * Output JSON: {"status": "success", "format": "PNG", "width": 4000, "height": 3000,
+ *               "mode": "RGB", "bit_depth": 8, "channels": 3}
+ *
+ * @return JSON string (MUST be freed with free_string!)
+ */
+ENGINE_API const char* engine_probe_image(const char* path);
+
+/**
+ * engine_probe_image for many files.
+ *
+ * Input JSON: ["C:/a.png", "C:/b.jpg"]
+ * Output JSON: {"status": "success", "results": [{"input_image_path": "C:/a.png",
+ *               "status": "success", "format": "PNG", ...}, ...]}
+ *
+ * @return JSON string (MUST be freed with free_string!)
+ */
+ENGINE_API const char* engine_probe_images(const char* paths_json);
+
+// =============================================================================
+// Pixel Output (zero-copy)
+// =============================================================================
+
+/**
+ * Processed pixels in engine-owned pooled memory: RGBA8888 with alpha 255,
+ * `stride` bytes per row (stride >= width * 4). Valid until
+ * engine_release_frame(handle); never copied on the way out.
+ * Set struct_size = sizeof(EngineFrame) before the call.
+ */
+typedef struct EngineFrame {
+    uint32_t struct_size;
+    int32_t width;
+    int32_t height;
+    uint32_t stride;
+    uint8_t* pixels;
+    void* handle;
+} EngineFrame;
+
+/**
+ * Like process_image_binary, and also return the final pixels in `frame`.
+ * With ENGINE_REQUEST_SKIP_ENCODE no output file is written and
+ * result->output_path is empty.
+ *
+ * @return ENGINE_STATUS_*; on success frame->handle must be released
+ */
+ENGINE_API int process_image_pixels(const EngineRequest* request, EngineResult* result,
+                                    EngineFrame* frame);
+
+/**
+ * Return a frame from process_image_pixels to the engine's pool.
+ * Signature matches a Dart NativeFinalizer callback. NULL is ignored;
+ * safe to call after engine_shutdown.
+ */
+ENGINE_API void engine_release_frame(void* handle);
+
 /**
  * FREE THE RETURNED STRING!
  * Every string returned by process_image MUST be freed.
@@ -63,12 +403,35 @@ ENGINE_API void free_string(const char* str);
 /**
  * Shutdown and cleanup.
  * Releases Python interpreter and all resources.
+ *
+ * Must be called before the library is unloaded: it joins the engine's
+ * threads, which cannot be done from DLL_PROCESS_DETACH under the loader
+ * lock, so unloading does not shut the engine down by itself.
  */
 ENGINE_API void engine_shutdown(void);
 
 /**
- * Get last error message.
- * @return Error string (do NOT free)
+ * Get engine statistics (frame pool usage, allocator counters, thread counts,
+ * CPU and memory limits in effect, job queue backpressure, compiled-in native decoders, coalesced calls,
+ * prefetch hints).
+ *
+ * Output JSON: {"frame_pool": {"hits": 12, "misses": 2, "huge_page_bytes": 0, ...},
+ *               "allocator": {"kind": "mimalloc", "raw": {...}, ...}, "tile_threads": 8,
+ *               "tile_steals": 310, "resources": {"cpus": 2, "hardware_cpus": 16,
+ *               "affinity_cpus": 16, "quota_cpus": 1.50, "memory_limit": 2147483648},
+ *               "jobs": {"policy": "block", "capacity": 1024, "depth": 0,
+ *               "blocked": 2, "rejected": 0, "dropped": 0, "retry_after_ms": 50},
+ *               "native_decoders": "png,jpeg", "native_ops": ["denoise"],
+ *               "coalesced": {"leaders": 40, "followers": 3},
+ *               "prefetch": {"submitted": 9, "completed": 6, "cancelled": 3, "hits": 5}}
+ *
+ * @return JSON string (MUST be freed with free_string!)
+ */
+ENGINE_API const char* engine_get_stats(void);
+
+/**
+ * Get last error message of a call made on this thread.
+ * @return Error string (do NOT free); valid until this thread's next call
  */
 ENGINE_API const char* engine_get_last_error(void);
 
@@ -0,0 +1,294 @@
+/**
+ * @file frame_pool.cpp
+ * @brief Planter Pressure - Engine-Owned Frame Buffer Pool
+ */
+
+#include "frame_pool.h"
+
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace planter {
+
+namespace {
+
+    // Smallest class is 64 KiB; anything below is not worth pooling separately
+    constexpr int MIN_CLASS_SHIFT = 16;
+    constexpr int STEPS_PER_DOUBLING = 4;
+
+    // Largest power of two whose 1.75x class still fits in a size_t
+    constexpr int MAX_CLASS_SHIFT = static_cast<int>(sizeof(size_t) * 8) - 2;
+    constexpr int CLASS_COUNT = (MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1) * STEPS_PER_DOUBLING;
+
+    uint8_t* aligned_alloc_bytes(size_t bytes) {
+#ifdef _WIN32
+        return static_cast<uint8_t*>(_aligned_malloc(bytes, FRAME_ALIGNMENT));
+#else
+        void* ptr = nullptr;
+        if (posix_memalign(&ptr, FRAME_ALIGNMENT, bytes) != 0) {
+            return nullptr;
+        }
+        return static_cast<uint8_t*>(ptr);
+#endif
+    }
+
+    void aligned_free_bytes(uint8_t* ptr) {
+#ifdef _WIN32
+        _aligned_free(ptr);
+#else
+        free(ptr);
+#endif
+    }
+
+    size_t round_to_huge_page(size_t bytes) {
+        return (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    }
+
+    /**
+     * Try explicit huge pages first, then a 2 MiB aligned THP mapping.
+     * Returns nullptr when neither is available (caller falls back to heap).
+     */
+    uint8_t* huge_alloc_bytes(size_t mapped_size, FrameBacking& backing) {
+#ifdef _WIN32
+        // Needs SeLockMemoryPrivilege; fails cleanly without it
+        SIZE_T large_page = GetLargePageMinimum();
+        if (large_page != 0 && mapped_size % large_page == 0) {
+            void* ptr = VirtualAlloc(nullptr, mapped_size,
+                                     MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (ptr) {
+                backing = FrameBacking::HugeTlb;
+                return static_cast<uint8_t*>(ptr);
+            }
+        }
+        return nullptr;
+#else
+#ifdef MAP_HUGETLB
+        void* ptr = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (ptr != MAP_FAILED) {
+            backing = FrameBacking::HugeTlb;
+            return static_cast<uint8_t*>(ptr);
+        }
+#endif
+#ifdef MADV_HUGEPAGE
+        // Over-map by one huge page and trim both ends to get 2 MiB alignment
+        size_t span = mapped_size + HUGE_PAGE_SIZE;
+        void* raw = mmap(nullptr, span, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            return nullptr;
+        }
+
+        uintptr_t base = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = (base + HUGE_PAGE_SIZE - 1) & ~(uintptr_t(HUGE_PAGE_SIZE) - 1);
+        size_t head = aligned - base;
+        size_t tail = span - head - mapped_size;
+        if (head) munmap(raw, head);
+        if (tail) munmap(reinterpret_cast<void*>(aligned + mapped_size), tail);
+
+        void* ptr_thp = reinterpret_cast<void*>(aligned);
+        if (madvise(ptr_thp, mapped_size, MADV_HUGEPAGE) != 0) {
+            munmap(ptr_thp, mapped_size);
+            return nullptr;
+        }
+        backing = FrameBacking::Transparent;
+        return static_cast<uint8_t*>(ptr_thp);
+#else
+        return nullptr;
+#endif
+#endif
+    }
+
+    void huge_free_bytes(uint8_t* ptr, size_t mapped_size) {
+#ifdef _WIN32
+        (void)mapped_size;
+        VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+        munmap(ptr, mapped_size);
+#endif
+    }
+
+} // anonymous namespace
+
+FramePool& FramePool::instance() {
+    static FramePool pool;
+    return pool;
+}
+
+int FramePool::size_class_for(size_t bytes) {
+    int size_class = 0;
+    while (class_capacity(size_class) < bytes) {
+        if (++size_class == CLASS_COUNT) return -1;
+    }
+    return size_class;
+}
+
+size_t FramePool::class_capacity(int size_class) {
+    // 2^k * (4 + step) / 4  ->  1.0x, 1.25x, 1.5x, 1.75x of each power of two
+    int doubling = size_class / STEPS_PER_DOUBLING;
+    int step = size_class % STEPS_PER_DOUBLING;
+    size_t base = size_t(1) << (MIN_CLASS_SHIFT + doubling);
+    return base + (base / STEPS_PER_DOUBLING) * step;
+}
+
+FrameBuffer* FramePool::allocate(size_t capacity, bool huge_pages) {
+    FrameBuffer* buffer = new FrameBuffer();
+    buffer->capacity = capacity;
+
+    if (huge_pages && capacity >= HUGE_PAGE_SIZE) {
+        size_t mapped_size = round_to_huge_page(capacity);
+        buffer->data = huge_alloc_bytes(mapped_size, buffer->backing);
+        if (buffer->data) {
+            buffer->mapped_size = mapped_size;
+            return buffer;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.huge_page_fallbacks++;
+    }
+
+    buffer->backing = FrameBacking::Heap;
+    buffer->mapped_size = capacity;
+    buffer->data = aligned_alloc_bytes(capacity);
+    if (!buffer->data) {
+        delete buffer;
+        return nullptr;
+    }
+    return buffer;
+}
+
+void FramePool::destroy(FrameBuffer* buffer) {
+    if (buffer->backing == FrameBacking::Heap) {
+        aligned_free_bytes(buffer->data);
+    } else {
+        huge_free_bytes(buffer->data, buffer->mapped_size);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.huge_page_bytes -= buffer->mapped_size;
+        if (buffer->backing == FrameBacking::HugeTlb) {
+            stats_.hugetlb_bytes -= buffer->mapped_size;
+        }
+    }
+    delete buffer;
+}
+
+FrameBuffer* FramePool::acquire(size_t bytes) {
+    int size_class = size_class_for(bytes);
+    if (size_class < 0) {
+        return nullptr;   // beyond the largest class; could never be allocated anyway
+    }
+    bool huge_pages = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.acquires++;
+
+        if (size_class < static_cast<int>(free_lists_.size()) && !free_lists_[size_class].empty()) {
+            FrameBuffer* buffer = free_lists_[size_class].back();
+            free_lists_[size_class].pop_back();
+            stats_.hits++;
+            stats_.bytes_idle -= buffer->capacity;
+            stats_.buffers_idle--;
+            stats_.bytes_live += buffer->capacity;
+            return buffer;
+        }
+        stats_.misses++;
+        huge_pages = huge_pages_;
+    }
+
+    // Allocate outside the lock - large allocations can fault in slowly
+    FrameBuffer* buffer = allocate(class_capacity(size_class), huge_pages);
+    if (!buffer) {
+        return nullptr;
+    }
+    buffer->size_class = size_class;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.bytes_live += buffer->capacity;
+    if (buffer->backing != FrameBacking::Heap) {
+        stats_.huge_page_bytes += buffer->mapped_size;
+        if (buffer->backing == FrameBacking::HugeTlb) {
+            stats_.hugetlb_bytes += buffer->mapped_size;
+        }
+    }
+    return buffer;
+}
+
+void FramePool::release(FrameBuffer* buffer) {
+    if (!buffer) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.bytes_live -= buffer->capacity;
+
+        if (stats_.bytes_idle + buffer->capacity <= idle_budget_) {
+            if (buffer->size_class >= static_cast<int>(free_lists_.size())) {
+                free_lists_.resize(buffer->size_class + 1);
+            }
+            free_lists_[buffer->size_class].push_back(buffer);
+            stats_.bytes_idle += buffer->capacity;
+            stats_.buffers_idle++;
+            return;
+        }
+    }
+
+    destroy(buffer);
+}
+
+void FramePool::trim() {
+    std::vector<FrameBuffer*> doomed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& list : free_lists_) {
+            doomed.insert(doomed.end(), list.begin(), list.end());
+            list.clear();
+        }
+        stats_.bytes_idle = 0;
+        stats_.buffers_idle = 0;
+    }
+
+    for (FrameBuffer* buffer : doomed) {
+        destroy(buffer);
+    }
+}
+
+void FramePool::set_idle_budget(size_t bytes) {
+    std::vector<FrameBuffer*> doomed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_budget_ = bytes;
+
+        // Shed idle buffers over the new budget, largest classes first
+        for (auto list = free_lists_.rbegin();
+             list != free_lists_.rend() && stats_.bytes_idle > idle_budget_; ++list) {
+            while (!list->empty() && stats_.bytes_idle > idle_budget_) {
+                FrameBuffer* buffer = list->back();
+                list->pop_back();
+                stats_.bytes_idle -= buffer->capacity;
+                stats_.buffers_idle--;
+                doomed.push_back(buffer);
+            }
+        }
+    }
+
+    for (FrameBuffer* buffer : doomed) {
+        destroy(buffer);
+    }
+}
+
+void FramePool::set_huge_pages(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    huge_pages_ = enabled;
+}
+
+FramePoolStats FramePool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace planter
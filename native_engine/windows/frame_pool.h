@@ -0,0 +1,113 @@
+/**
+ * @file frame_pool.h
+ * @brief Planter Pressure - Engine-Owned Frame Buffer Pool
+ *
+ * OPTIMIZATIONS:
+ * - Frame buffers recycled across stages and jobs (no mmap/munmap churn)
+ * - Size-class buckets so near-equal frames share buffers
+ * - 64-byte aligned rows for vectorized kernels
+ * - Optional huge-page backing (hugetlbfs, then THP) to cut TLB misses
+ */
+
+#ifndef PLANTER_PRESSURE_FRAME_POOL_H
+#define PLANTER_PRESSURE_FRAME_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace planter {
+
+// Bytes per pixel of every engine frame (RGBX, same layout Pillow uses for RGB)
+constexpr int FRAME_CHANNELS = 4;
+
+// Row and base alignment of frame memory
+constexpr size_t FRAME_ALIGNMENT = 64;
+
+// Idle bytes the pool keeps unless told otherwise (set_idle_budget)
+constexpr size_t DEFAULT_IDLE_BUDGET = size_t(512) << 20;
+
+// Huge page size targeted by the huge-page allocation path
+constexpr size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+
+enum class FrameBacking {
+    Heap,        // aligned malloc
+    HugeTlb,     // explicit huge pages (MAP_HUGETLB / MEM_LARGE_PAGES)
+    Transparent, // 2 MiB aligned mapping advised with MADV_HUGEPAGE
+};
+
+struct FrameBuffer {
+    uint8_t* data = nullptr;
+    size_t capacity = 0;
+    size_t mapped_size = 0;
+    int size_class = 0;
+    FrameBacking backing = FrameBacking::Heap;
+};
+
+struct FramePoolStats {
+    uint64_t acquires = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t bytes_live = 0;          // handed out, not yet released
+    uint64_t bytes_idle = 0;          // parked in the pool
+    uint64_t buffers_idle = 0;
+    uint64_t huge_page_bytes = 0;     // huge-page-backed bytes (live + idle)
+    uint64_t hugetlb_bytes = 0;       // of which explicit huge pages
+    uint64_t huge_page_fallbacks = 0; // huge-page requests served from the heap
+};
+
+/**
+ * Thread-safe pool of large frame buffers.
+ *
+ * Requests are rounded up to a size class (four classes per power of two),
+ * so a 24 MP frame and a slightly smaller crop reuse the same buffer.
+ * Idle buffers are kept up to a byte budget; anything beyond it is freed.
+ */
+class FramePool {
+public:
+    static FramePool& instance();
+
+    // nullptr if out of memory or bytes exceeds the largest size class
+    FrameBuffer* acquire(size_t bytes);
+    void release(FrameBuffer* buffer);
+
+    // Free every idle buffer (live buffers are unaffected)
+    void trim();
+
+    // Frees idle buffers beyond a lowered budget right away
+    void set_idle_budget(size_t bytes);
+
+    // Back new buffers of at least HUGE_PAGE_SIZE with huge pages
+    void set_huge_pages(bool enabled);
+
+    FramePoolStats stats() const;
+
+private:
+    FramePool() = default;
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    // -1 if bytes exceeds the largest class
+    static int size_class_for(size_t bytes);
+    static size_t class_capacity(int size_class);
+
+    FrameBuffer* allocate(size_t capacity, bool huge_pages);
+    void destroy(FrameBuffer* buffer);
+
+    mutable std::mutex mutex_;
+    std::vector<std::vector<FrameBuffer*>> free_lists_;
+    size_t idle_budget_ = DEFAULT_IDLE_BUDGET;
+    bool huge_pages_ = false;
+    FramePoolStats stats_;
+};
+
+// Row stride (bytes) for a frame of the given width
+inline size_t frame_stride(int width) {
+    size_t row = static_cast<size_t>(width) * FRAME_CHANNELS;
+    return (row + FRAME_ALIGNMENT - 1) & ~(FRAME_ALIGNMENT - 1);
+}
+
+} // namespace planter
+
+#endif
@@ -0,0 +1,918 @@
+/**
+ * @file jobs.cpp
+ * @brief Planter Pressure - Job Queue, Workers and Batch Manifests
+ */
+
+#include "jobs.h"
+#include "json_util.h"
+#include "probe.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <filesystem>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace planter {
+
+namespace {
+
+    // Finished batches whose status stays queryable; older ones are pruned
+    constexpr size_t MAX_FINISHED_BATCHES = 256;
+
+    // Indices into JobSystem::running_; unpipelined workers count as decode
+    enum : int { DECODE_STAGE, FILTER_STAGE, ENCODE_STAGE };
+
+    /**
+     * Read-only view of a whole file, mapped rather than read: the parser
+     * walks it once front to back, so pages come in on demand and stay
+     * reclaimable, and memory does not grow with the manifest.
+     */
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile() { close(); }
+
+        bool open(const std::string& path, std::string& error) {
+            uint64_t size = 0;
+#ifdef _WIN32
+            HANDLE file = CreateFileW(std::filesystem::u8path(path).wstring().c_str(), GENERIC_READ,
+                                      FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                      FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE) {
+                error = "Cannot open manifest: " + path;
+                return false;
+            }
+            LARGE_INTEGER length;
+            bool sized = GetFileSizeEx(file, &length) != 0;
+            size = sized ? static_cast<uint64_t>(length.QuadPart) : 0;
+            HANDLE mapping = nullptr;
+            if (sized && size > 0 && size <= SIZE_MAX) {
+                mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (mapping) {
+                    data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                    CloseHandle(mapping);
+                }
+            }
+            CloseHandle(file);
+            if (!sized) {
+                error = "Cannot size manifest: " + path;
+                return false;
+            }
+#else
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                error = "Cannot open manifest: " + path;
+                return false;
+            }
+            struct stat st;
+            if (fstat(fd, &st) != 0) {
+                ::close(fd);
+                error = "Cannot size manifest: " + path;
+                return false;
+            }
+            size = static_cast<uint64_t>(st.st_size);
+            if (size > 0 && size <= SIZE_MAX) {
+                void* ptr = mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (ptr != MAP_FAILED) {
+                    madvise(ptr, static_cast<size_t>(size), MADV_SEQUENTIAL);
+                    data_ = static_cast<const char*>(ptr);
+                }
+            }
+            ::close(fd);
+#endif
+            if (size > 0 && !data_) {
+                error = "Cannot map manifest: " + path;
+                return false;
+            }
+            size_ = static_cast<size_t>(size);
+            return true;
+        }
+
+        const char* data() const { return data_ ? data_ : ""; }
+        size_t size() const { return size_; }
+
+    private:
+        void close() {
+            if (!data_) return;
+#ifdef _WIN32
+            UnmapViewOfFile(data_);
+#else
+            munmap(const_cast<char*>(data_), size_);
+#endif
+            data_ = nullptr;
+        }
+
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+    };
+
+    // Defaults declared at the top level of an object-form manifest
+    struct ManifestDefaults {
+        std::string output_dir;
+        float sharpness = 1.5f;
+        float contrast = 1.2f;
+        bool overlay = true;
+    };
+
+    /**
+     * Read a known per-job field. Returns false only on malformed JSON;
+     * `handled` tells whether the key was one of ours.
+     */
+    bool read_job_field(JsonReader& r, const std::string& key,
+                        std::string* input_path, std::string& output_dir,
+                        float& sharpness, float& contrast, bool& overlay, bool& handled) {
+        handled = true;
+        double number = 0.0;
+
+        if (input_path && key == "input_image_path") return r.read_string(*input_path);
+        if (key == "output_dir") return r.read_string(output_dir);
+        if (key == "overlay") return r.read_bool(overlay);
+        if (key == "sharpness") {
+            if (!r.read_number(number)) return false;
+            sharpness = static_cast<float>(number);
+            return true;
+        }
+        if (key == "contrast") {
+            if (!r.read_number(number)) return false;
+            contrast = static_cast<float>(number);
+            return true;
+        }
+
+        handled = false;
+        return true;
+    }
+
+    /**
+     * Walk the manifest and hand each entry to `emit` as soon as it is parsed.
+     *
+     * Accepted shapes:
+     *   [ {"input_image_path": ...}, ... ]
+     *   {"output_dir": ..., "sharpness": ..., "items": [ ... ]}
+     *
+     * `emit` returns false to stop early (queue closed).
+     */
+    bool parse_manifest(const char* text, size_t size,
+                        const std::function<bool(Job&&)>& emit,
+                        std::string& error) {
+        JsonReader r(text, size);
+        ManifestDefaults defaults;
+        size_t items_offset = 0;
+        bool have_items = false;
+
+        if (r.peek() == '{') {
+            // Collect defaults first, wherever "items" appears among the keys
+            if (!r.begin_object()) { error = r.error(); return false; }
+            std::string key;
+            bool done = false;
+            for (;;) {
+                if (!r.next_key(key, done)) { error = r.error(); return false; }
+                if (done) break;
+
+                if (key == "items") {
+                    items_offset = r.offset();
+                    have_items = true;
+                    if (!r.skip_value()) { error = r.error(); return false; }
+                    continue;
+                }
+
+                bool handled = false;
+                if (!read_job_field(r, key, nullptr, defaults.output_dir, defaults.sharpness,
+                                    defaults.contrast, defaults.overlay, handled) ||
+                    (!handled && !r.skip_value())) {
+                    error = r.error();
+                    return false;
+                }
+            }
+
+            if (!have_items) {
+                error = "Manifest object has no \"items\" array";
+                return false;
+            }
+            r.seek(items_offset);
+        }
+
+        if (!r.begin_array()) { error = r.error(); return false; }
+
+        uint64_t index = 0;
+        bool done = false;
+        for (;;) {
+            if (!r.next_element(done)) { error = r.error(); return false; }
+            if (done) break;
+
+            Job job;
+            job.index = index++;
+            job.output_dir = defaults.output_dir;
+            job.sharpness = defaults.sharpness;
+            job.contrast = defaults.contrast;
+            job.overlay = defaults.overlay;
+
+            if (r.peek() == '"') {
+                // Bare path shorthand
+                if (!r.read_string(job.input_path)) { error = r.error(); return false; }
+            } else {
+                if (!r.begin_object()) { error = r.error(); return false; }
+                std::string key;
+                bool item_done = false;
+                for (;;) {
+                    if (!r.next_key(key, item_done)) { error = r.error(); return false; }
+                    if (item_done) break;
+
+                    bool handled = false;
+                    if (!read_job_field(r, key, &job.input_path, job.output_dir, job.sharpness,
+                                        job.contrast, job.overlay, handled) ||
+                        (!handled && !r.skip_value())) {
+                        error = r.error();
+                        return false;
+                    }
+                }
+            }
+
+            if (!emit(std::move(job))) {
+                return true;
+            }
+        }
+        return true;
+    }
+
+} // anonymous namespace
+
+bool parse_request(const char* json, size_t size, Job& job, PreviewOptions& preview,
+                   std::string& error) {
+    JsonReader r(json, size);
+    if (!r.begin_object()) { error = r.error(); return false; }
+
+    std::string key;
+    bool done = false;
+    for (;;) {
+        if (!r.next_key(key, done)) { error = r.error(); return false; }
+        if (done) return true;
+
+        if (key == "preview" && r.peek() == '{') {
+            r.begin_object();
+            bool preview_done = false;
+            for (;;) {
+                if (!r.next_key(key, preview_done)) { error = r.error(); return false; }
+                if (preview_done) break;
+
+                double number = 0.0;
+                bool ok = key == "max_dim" ? r.read_number(number)
+                        : key == "follow_up" ? r.read_bool(preview.follow_up)
+                        : r.skip_value();
+                if (!ok) { error = r.error(); return false; }
+                if (key == "max_dim") preview.max_dim = static_cast<int>(number);
+            }
+            continue;
+        }
+
+        bool handled = false;
+        if (!read_job_field(r, key, &job.input_path, job.output_dir, job.sharpness,
+                            job.contrast, job.overlay, handled) ||
+            (!handled && !r.skip_value())) {
+            error = r.error();
+            return false;
+        }
+    }
+}
+
+// =============================================================================
+// JobQueue
+// =============================================================================
+
+void JobQueue::set_capacity(size_t capacity) {
+    items_.reset(capacity);
+    background_.reset(capacity);
+}
+
+void JobQueue::wake(std::condition_variable& cv, std::atomic<int>& waiting, bool all) {
+    // Pairs with the sleeper's announce-then-recheck below: either it sees
+    // our change, or we see it waiting and notify under its lock
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting.load(std::memory_order_relaxed) == 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (all) cv.notify_all();
+    else cv.notify_one();
+}
+
+bool JobQueue::push(Job&& job) {
+    JobPriority priority = job.priority;
+    uint64_t batch_id = job.batch_id;
+    MpmcRing<Job>& ring = lane(priority);
+    for (;;) {
+        if (closed()) return false;
+        if (ring.try_push(std::move(job), batch_id)) break;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiting_producers_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool pushed = !closed() && ring.try_push(std::move(job), batch_id);
+        if (!pushed && !closed()) not_full_.wait(lock);
+        waiting_producers_.fetch_sub(1, std::memory_order_relaxed);
+        if (pushed) break;
+    }
+    if (priority == JobPriority::Background) wake(background_ready_, waiting_background_, false);
+    else wake(not_empty_, waiting_consumers_, false);
+    return true;
+}
+
+bool JobQueue::try_push(Job&& job) {
+    JobPriority priority = job.priority;
+    uint64_t batch_id = job.batch_id;
+    if (closed() || !lane(priority).try_push(std::move(job), batch_id)) return false;
+    if (priority == JobPriority::Background) wake(background_ready_, waiting_background_, false);
+    else wake(not_empty_, waiting_consumers_, false);
+    return true;
+}
+
+bool JobQueue::try_pop_any(Job& job) {
+    return items_.try_pop(job) || background_.try_pop(job);
+}
+
+bool JobQueue::try_pop_ready(JobPriority priority, Job& job) {
+    if (priority == JobPriority::Normal) return items_.try_pop(job);
+    return items_.size_approx() == 0 && background_.try_pop(job);
+}
+
+bool JobQueue::pop(Job& job, JobPriority priority) {
+    std::condition_variable& ready =
+            priority == JobPriority::Background ? background_ready_ : not_empty_;
+    std::atomic<int>& waiting =
+            priority == JobPriority::Background ? waiting_background_ : waiting_consumers_;
+    for (;;) {
+        if (closed()) return false;
+        if (try_pop_ready(priority, job)) break;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiting.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool popped = !closed() && try_pop_ready(priority, job);
+        if (!popped && !closed()) ready.wait(lock);
+        waiting.fetch_sub(1, std::memory_order_relaxed);
+        if (popped) break;
+    }
+    // Room in one lane; blocked producers may be waiting on either
+    wake(not_full_, waiting_producers_, true);
+    // The background lane may run once the normal lane has drained
+    if (priority == JobPriority::Normal && items_.size_approx() == 0) {
+        wake(background_ready_, waiting_background_, false);
+    }
+    return true;
+}
+
+bool JobQueue::try_pop_oldest_unless(uint64_t batch_id, Job& job) {
+    if (!items_.try_pop_if(job, [batch_id](uint64_t tag) { return tag != batch_id; })) return false;
+    wake(not_full_, waiting_producers_, true);
+    return true;
+}
+
+void JobQueue::drain() {
+    Job job;
+    while (try_pop_any(job)) {
+    }
+}
+
+void JobQueue::close() {
+    closed_.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        not_empty_.notify_all();
+        background_ready_.notify_all();
+        not_full_.notify_all();
+    }
+    drain();
+}
+
+void JobQueue::reopen() {
+    // A push racing close() may have landed after its drain
+    drain();
+    closed_.store(false, std::memory_order_release);
+}
+
+size_t JobQueue::size() const {
+    return items_.size_approx() + background_.size_approx();
+}
+
+// =============================================================================
+// StageQueue
+// =============================================================================
+
+bool StageQueue::push(StagedJob&& job) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+    if (closed_) return false;
+    items_.push_back(std::move(job));
+    lock.unlock();
+    not_empty_.notify_one();
+    return true;
+}
+
+bool StageQueue::pop(StagedJob& job) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+    if (closed_) return false;
+    job = std::move(items_.front());
+    items_.pop_front();
+    lock.unlock();
+    not_full_.notify_one();
+    return true;
+}
+
+void StageQueue::close() {
+    // Free dropped state outside the lock; its deleter may take the GIL
+    std::deque<StagedJob> dropped;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        dropped.swap(items_);
+    }
+    not_empty_.notify_all();
+    not_full_.notify_all();
+}
+
+void StageQueue::reopen(size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = capacity;
+    closed_ = false;
+}
+
+// =============================================================================
+// JobSystem
+// =============================================================================
+
+JobSystem& JobSystem::instance() {
+    static JobSystem system;
+    return system;
+}
+
+void JobSystem::configure(int workers, uint64_t max_pixels, JobExecutor executor,
+                          JobPipeline pipeline) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    worker_count_ = std::max(1, workers);
+    max_pixels_ = max_pixels;
+    executor_ = std::move(executor);
+    pipeline_ = std::move(pipeline);
+}
+
+void JobSystem::configure_queue(size_t capacity, QueueFullPolicy policy) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.set_capacity(capacity);
+    policy_.store(policy, std::memory_order_relaxed);
+}
+
+uint32_t JobSystem::retry_after_ms() const {
+    // Until about half the queue has drained at the recent completion rate
+    uint64_t interval_ns = completion_interval_ns_.load(std::memory_order_relaxed);
+    if (interval_ns == 0) interval_ns = 100000000;   // nothing finished yet: 100 ms per job
+    uint64_t ms = (queue_.size() / 2 + 1) * interval_ns / 1000000;
+    return static_cast<uint32_t>(std::min<uint64_t>(std::max<uint64_t>(ms, 1), 60000));
+}
+
+bool JobSystem::evict_oldest(uint64_t spared_batch) {
+    Job evicted;
+    if (!queue_.try_pop_oldest_unless(spared_batch, evicted)) return false;
+    ++dropped_;
+    JobOutcome outcome;
+    outcome.error = "Dropped: job queue full";
+    std::shared_ptr<Batch> batch = find_batch(evicted.batch_id);
+    if (batch) record(batch, evicted, outcome);
+    return true;
+}
+
+bool JobSystem::enqueue(Job&& job, bool may_block, JobOutcome& rejected) {
+    if (queue_.try_push(std::move(job))) return true;
+
+    const QueueFullPolicy policy = policy_.load(std::memory_order_relaxed);
+    if (!queue_.closed()) {
+        if (policy == QueueFullPolicy::Block && may_block) {
+            ++blocked_;
+            if (queue_.push(std::move(job))) return true;
+        } else if (policy == QueueFullPolicy::DropOldest && job.priority == JobPriority::Normal &&
+                   may_block) {
+            for (;;) {
+                // The oldest entry is our own: wait, as under Block
+                if (!evict_oldest(job.batch_id)) {
+                    ++blocked_;
+                    if (queue_.push(std::move(job))) return true;
+                    break;
+                }
+                if (queue_.try_push(std::move(job))) return true;
+                if (queue_.closed()) break;
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    if (queue_.closed()) {
+        rejected.error = "Job system shutting down";
+        return false;
+    }
+    ++rejected_;
+    rejected.retry_after_ms = retry_after_ms();
+    rejected.error = "Job queue full; retry after " + std::to_string(rejected.retry_after_ms) + " ms";
+    return false;
+}
+
+JobQueueStats JobSystem::queue_stats() {
+    JobQueueStats stats;
+    stats.policy = policy_.load(std::memory_order_relaxed);
+    stats.capacity = queue_.capacity();
+    stats.depth = queue_.size();
+    stats.blocked = blocked_.load();
+    stats.rejected = rejected_.load();
+    stats.dropped = dropped_.load();
+    stats.retry_after_ms = retry_after_ms();
+    return stats;
+}
+
+bool JobSystem::admit(const std::shared_ptr<Batch>& batch, Job& job) {
+    std::string error;
+    if (!admit_image(job.input_path, max_pixels_, job.pixels, error)) {
+        JobOutcome outcome;
+        outcome.error = error;
+        job.pixels = 0;  // rejected entries cost nothing
+        record(batch, job, outcome);
+        return false;
+    }
+    batch->pixels_total += job.pixels;
+    return true;
+}
+
+void JobSystem::start_workers_locked() {
+    stopping_ = false;
+    queue_.reopen();
+    // Background jobs wait for idle in the executor; never on a worker below
+    workers_.emplace_back(&JobSystem::background_loop, this);
+    if (pipeline_) {
+        // One job waiting per downstream worker keeps every stage fed without
+        // letting decoded frames pile up in memory
+        decoded_.reopen(worker_count_);
+        filtered_.reopen(worker_count_);
+    }
+    active_workers_ = worker_count_;
+    spawned_workers_ = 0;
+    spawn_workers_locked(worker_count_);
+}
+
+void JobSystem::spawn_workers_locked(int count) {
+    for (int slot = spawned_workers_; slot < count; ++slot) {
+        if (!pipeline_) {
+            workers_.emplace_back(&JobSystem::worker_loop, this, slot);
+            continue;
+        }
+        workers_.emplace_back(&JobSystem::decode_loop, this, slot);
+        workers_.emplace_back(&JobSystem::filter_loop, this, slot);
+        workers_.emplace_back(&JobSystem::encode_loop, this, slot);
+    }
+    spawned_workers_ = std::max(spawned_workers_, count);
+}
+
+void JobSystem::resize_workers(int workers) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    worker_count_ = std::max(1, workers);
+    if (workers_.empty() || stopping_) return;   // applied when workers start
+
+    spawn_workers_locked(worker_count_);
+    {
+        std::lock_guard<std::mutex> park(park_mutex_);
+        active_workers_ = worker_count_;
+    }
+    park_cv_.notify_all();
+}
+
+bool JobSystem::await_slot(int slot) {
+    if (slot < active_workers_.load(std::memory_order_relaxed)) return true;
+    std::unique_lock<std::mutex> lock(park_mutex_);
+    park_cv_.wait(lock, [&] { return slot < active_workers_ || stopping_; });
+    return !stopping_;
+}
+
+bool JobSystem::enter_stage(int stage) {
+    // A surplus worker already waiting in pop() when the count shrank
+    // holds its job here until a running one finishes
+    std::unique_lock<std::mutex> lock(park_mutex_);
+    park_cv_.wait(lock, [&] { return running_[stage] < active_workers_ || stopping_; });
+    if (stopping_) return false;
+    ++running_[stage];
+    return true;
+}
+
+void JobSystem::leave_stage(int stage) {
+    {
+        std::lock_guard<std::mutex> lock(park_mutex_);
+        --running_[stage];
+    }
+    park_cv_.notify_all();
+}
+
+uint64_t JobSystem::submit_manifest(const std::string& manifest_path,
+                                    const std::string& results_path,
+                                    std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!executor_) {
+        error = "Job system not configured";
+        return 0;
+    }
+
+    FILE* results = nullptr;
+    if (!results_path.empty()) {
+        results = fopen(results_path.c_str(), "wb");
+        if (!results) {
+            error = "Cannot open results file: " + results_path;
+            return 0;
+        }
+    }
+
+    std::shared_ptr<Batch> batch = new_batch_locked();
+    batch->results = results;
+    readers_.emplace_back(&JobSystem::reader_loop, this, batch, manifest_path);
+    return batch->id;
+}
+
+uint64_t JobSystem::submit_job(Job job, std::string& error) {
+    std::shared_ptr<Batch> batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (!executor_) {
+            error = "Job system not configured";
+            return 0;
+        }
+
+        if (!admit_image(job.input_path, max_pixels_, job.pixels, error)) {
+            return 0;
+        }
+
+        batch = new_batch_locked();
+        job.batch_id = batch->id;
+        batch->submitted = 1;
+        batch->parsing = false;
+        batch->pixels_total = job.pixels;
+    }
+
+    // Never waits: the caller is a request that has to return
+    JobOutcome rejected;
+    if (!enqueue(std::move(job), false, rejected)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        batches_.erase(batch->id);
+        error = rejected.error;
+        return 0;
+    }
+    return batch->id;
+}
+
+std::shared_ptr<Batch> JobSystem::new_batch_locked() {
+    if (workers_.empty()) {
+        start_workers_locked();
+    }
+
+    auto batch = std::make_shared<Batch>();
+    batch->id = next_batch_id_++;
+    batches_[batch->id] = batch;
+    return batch;
+}
+
+void JobSystem::reader_loop(std::shared_ptr<Batch> batch, std::string manifest_path) {
+    MappedFile text;
+    std::string error;
+
+    bool ok = text.open(manifest_path, error) &&
+              parse_manifest(text.data(), text.size(), [&](Job&& job) {
+                  if (stopping_) return false;
+
+                  job.batch_id = batch->id;
+                  batch->submitted++;
+
+                  if (job.input_path.empty()) {
+                      JobOutcome outcome;
+                      outcome.error = "Missing input_image_path";
+                      record(batch, job, outcome);
+                      return true;
+                  }
+
+                  // Oversized entries fail here without occupying a worker
+                  if (!admit(batch, job)) return true;
+
+                  JobOutcome rejected;
+                  if (!enqueue(std::move(job), true, rejected)) {
+                      if (queue_.closed()) {
+                          batch->submitted--;
+                          return false;
+                      }
+                      record(batch, job, rejected);
+                  }
+                  return true;
+              }, error);
+
+    if (!ok) {
+        std::lock_guard<std::mutex> lock(batch->mutex);
+        batch->error = error;
+    }
+
+    batch->parsing = false;
+    maybe_finish(batch);
+}
+
+void JobSystem::worker_loop(int slot) {
+    Job job;
+    while (await_slot(slot) && queue_.pop(job) && enter_stage(DECODE_STAGE)) {
+        JobOutcome outcome = executor_(job);
+        leave_stage(DECODE_STAGE);
+        complete(job, outcome);
+    }
+}
+
+void JobSystem::background_loop() {
+    Job job;
+    while (queue_.pop(job, JobPriority::Background)) {
+        complete(job, executor_(job));
+    }
+}
+
+namespace {
+
+    void run_stage(const std::function<bool(StagedJob&)>& stage, StagedJob& staged) {
+        if (staged.failed) return;
+        if (!stage(staged)) {
+            staged.failed = true;
+            staged.state.reset();
+        }
+    }
+
+} // anonymous namespace
+
+void JobSystem::decode_loop(int slot) {
+    Job job;
+    while (await_slot(slot) && queue_.pop(job) && enter_stage(DECODE_STAGE)) {
+        StagedJob staged;
+        staged.job = std::move(job);
+        run_stage(pipeline_.decode, staged);
+        leave_stage(DECODE_STAGE);
+        if (!decoded_.push(std::move(staged))) return;
+    }
+}
+
+void JobSystem::filter_loop(int slot) {
+    StagedJob staged;
+    while (await_slot(slot) && decoded_.pop(staged) && enter_stage(FILTER_STAGE)) {
+        run_stage(pipeline_.filter, staged);
+        leave_stage(FILTER_STAGE);
+        if (!filtered_.push(std::move(staged))) return;
+    }
+}
+
+void JobSystem::encode_loop(int slot) {
+    StagedJob staged;
+    while (await_slot(slot) && filtered_.pop(staged) && enter_stage(ENCODE_STAGE)) {
+        run_stage(pipeline_.encode, staged);
+        leave_stage(ENCODE_STAGE);
+        staged.state.reset();
+        complete(staged.job, staged.outcome);
+    }
+}
+
+void JobSystem::complete(const Job& job, const JobOutcome& outcome) {
+    // Smoothed (1/8) gap between completions feeds the retry-after hint
+    uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    uint64_t last = last_completion_ns_.exchange(now, std::memory_order_relaxed);
+    if (last != 0 && now > last) {
+        uint64_t interval = completion_interval_ns_.load(std::memory_order_relaxed);
+        interval = interval == 0 ? now - last : interval - interval / 8 + (now - last) / 8;
+        completion_interval_ns_.store(interval, std::memory_order_relaxed);
+    }
+
+    std::shared_ptr<Batch> batch = find_batch(job.batch_id);
+    if (batch) {
+        record(batch, job, outcome);
+    }
+}
+
+std::shared_ptr<Batch> JobSystem::find_batch(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = batches_.find(id);
+    return it == batches_.end() ? nullptr : it->second;
+}
+
+void JobSystem::record(const std::shared_ptr<Batch>& batch, const Job& job, const JobOutcome& outcome) {
+    {
+        std::lock_guard<std::mutex> lock(batch->mutex);
+        if (outcome.ok) {
+            batch->output_path = outcome.output_path;
+        }
+        batch->pixels_done += job.pixels;
+        if (batch->results) {
+            std::string line = "{\"index\":" + std::to_string(job.index) +
+                               ",\"input_image_path\":\"" + json_escape(job.input_path) + "\"";
+            if (outcome.ok) {
+                line += ",\"status\":\"success\",\"output_image_path\":\"" +
+                        json_escape(outcome.output_path) + "\"}\n";
+            } else {
+                line += ",\"status\":\"error\",\"error\":\"" + json_escape(outcome.error) + "\"";
+                if (outcome.retry_after_ms) {
+                    line += ",\"retry_after_ms\":" + std::to_string(outcome.retry_after_ms);
+                }
+                line += "}\n";
+            }
+            fwrite(line.data(), 1, line.size(), batch->results);
+        }
+    }
+
+    if (outcome.ok) batch->completed++;
+    else batch->failed++;
+
+    maybe_finish(batch);
+}
+
+void JobSystem::maybe_finish(const std::shared_ptr<Batch>& batch) {
+    if (batch->parsing) return;
+    if (batch->completed + batch->failed < batch->submitted) return;
+
+    {
+        std::lock_guard<std::mutex> lock(batch->mutex);
+        if (batch->finished) return;
+        batch->finished = true;
+        if (batch->results) {
+            fclose(batch->results);
+            batch->results = nullptr;
+        }
+    }
+
+    // Every manifest and follow-up is a batch; keep only the latest finished
+    std::lock_guard<std::mutex> lock(mutex_);
+    finished_batches_.push_back(batch->id);
+    while (finished_batches_.size() > MAX_FINISHED_BATCHES) {
+        batches_.erase(finished_batches_.front());
+        finished_batches_.pop_front();
+    }
+}
+
+std::string JobSystem::batch_status(uint64_t batch_id) {
+    std::shared_ptr<Batch> batch = find_batch(batch_id);
+    if (!batch) return std::string();
+
+    std::lock_guard<std::mutex> lock(batch->mutex);
+    std::string json = "{\"batch_id\":" + std::to_string(batch->id);
+    json += ",\"submitted\":" + std::to_string(batch->submitted.load());
+    json += ",\"completed\":" + std::to_string(batch->completed.load());
+    json += ",\"failed\":" + std::to_string(batch->failed.load());
+    json += ",\"pixels_total\":" + std::to_string(batch->pixels_total.load());
+    json += ",\"pixels_done\":" + std::to_string(batch->pixels_done.load());
+    json += ",\"parsing\":";
+    json += batch->parsing ? "true" : "false";
+    json += ",\"done\":";
+    json += batch->finished ? "true" : "false";
+    if (!batch->error.empty()) {
+        json += ",\"error\":\"" + json_escape(batch->error) + "\"";
+    }
+    if (batch->submitted == 1 && !batch->output_path.empty()) {
+        json += ",\"output_image_path\":\"" + json_escape(batch->output_path) + "\"";
+    }
+    json += "}";
+    return json;
+}
+
+void JobSystem::shutdown() {
+    std::vector<std::thread> readers;
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        readers.swap(readers_);
+        workers.swap(workers_);
+    }
+    {
+        // Parked workers see stopping_ under the park lock
+        std::lock_guard<std::mutex> park(park_mutex_);
+    }
+    park_cv_.notify_all();
+
+    queue_.close();
+    decoded_.close();
+    filtered_.close();
+    for (auto& t : readers) if (t.joinable()) t.join();
+    for (auto& t : workers) if (t.joinable()) t.join();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : batches_) {
+        std::lock_guard<std::mutex> batch_lock(entry.second->mutex);
+        if (entry.second->results) {
+            fclose(entry.second->results);
+            entry.second->results = nullptr;
+        }
+    }
+    batches_.clear();
+    finished_batches_.clear();
+}
+
+} // namespace planter
@@ -0,0 +1,307 @@
+/**
+ * @file jobs.h
+ * @brief Planter Pressure - Job Queue, Workers and Batch Manifests
+ *
+ * OPTIMIZATIONS:
+ * - Manifests parsed natively on a reader thread (never touches the GIL)
+ * - Entries stream into a bounded queue; memory stays flat for huge batches
+ * - Results appended as JSON Lines instead of accumulated in memory
+ * - Entries probed by header on the reader thread: oversized inputs are
+ *   rejected before reaching a worker, and pixel counts give cost-based progress
+ * - Optional three-stage pipeline: decode of job N+1, filtering of N and
+ *   encoding of N-1 overlap on separate workers with bounded hand-offs
+ * - Submit and dispatch go through lock-free MPMC rings; the mutex is
+ *   only touched when a thread has to sleep on a full or empty queue
+ */
+
+#ifndef PLANTER_PRESSURE_JOBS_H
+#define PLANTER_PRESSURE_JOBS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mpmc_ring.h"
+
+namespace planter {
+
+// Background jobs run on their own thread, only when no normal-priority job is queued
+enum class JobPriority { Normal, Background };
+
+struct Job {
+    uint64_t batch_id = 0;
+    uint64_t index = 0;
+    std::string input_path;
+    std::string output_dir;
+    float sharpness = 1.5f;
+    float contrast = 1.2f;
+    bool overlay = true;
+    JobPriority priority = JobPriority::Normal;
+    uint64_t pixels = 0;      // probed cost estimate, 0 = unknown
+    // Full JSON request to replay instead of the fields above (preview
+    // follow-ups, so ops, variants, pyramid and siblings carry over)
+    std::string request_json;
+};
+
+// "preview" request option
+struct PreviewOptions {
+    int max_dim = 0;          // 0 = not a preview
+    bool follow_up = false;   // queue the full-resolution job afterwards
+};
+
+/**
+ * Parse the fields of a process_image JSON request the engine acts on
+ * itself (job fields and "preview"); other keys are skipped.
+ * @return false with `error` set on malformed JSON
+ */
+bool parse_request(const char* json, size_t size, Job& job, PreviewOptions& preview,
+                   std::string& error);
+
+struct JobOutcome {
+    bool ok = false;
+    std::string output_path;
+    std::string error;
+    uint32_t retry_after_ms = 0;   // rejected by a full queue: when to try again
+};
+
+// What submitting to a full queue does
+enum class QueueFullPolicy {
+    Block,        // manifest readers wait for room; follow-up jobs are rejected
+    Reject,       // the new job fails with a retry-after hint
+    DropOldest,   // the oldest queued manifest entry fails to make room, unless it is the reader's own
+};
+
+struct JobQueueStats {
+    QueueFullPolicy policy = QueueFullPolicy::Block;
+    size_t capacity = 0;      // per lane
+    size_t depth = 0;         // jobs queued now (approximate)
+    uint64_t blocked = 0;     // submissions that waited for room
+    uint64_t rejected = 0;
+    uint64_t dropped = 0;
+    uint32_t retry_after_ms = 0;   // hint a rejection would carry now
+};
+
+// Runs one job to completion; supplied by the engine (calls into Python)
+using JobExecutor = std::function<JobOutcome(const Job&)>;
+
+// A job between pipeline stages
+struct StagedJob {
+    Job job;
+    std::shared_ptr<void> state;   // what the stages hand on; freed if the job is dropped
+    JobOutcome outcome;
+    bool failed = false;           // later stages pass a failed job straight through
+};
+
+/**
+ * Stage functions of the pipelined executor, supplied by the engine.
+ * Each returns false with outcome.error set to fail the job; encode sets
+ * the outcome on success. Background jobs bypass the pipeline (JobExecutor).
+ */
+struct JobPipeline {
+    std::function<bool(StagedJob&)> decode;
+    std::function<bool(StagedJob&)> filter;
+    std::function<bool(StagedJob&)> encode;
+
+    explicit operator bool() const { return decode && filter && encode; }
+};
+
+/**
+ * Bounded FIFO with a background lane, one lock-free ring per lane.
+ * push() waits while the job's lane is full; pop() takes from one lane,
+ * and from the background lane only while the normal lane is empty.
+ * close() drops what is queued, wakes everyone and makes both return false.
+ */
+class JobQueue {
+public:
+    explicit JobQueue(size_t capacity) : items_(capacity), background_(capacity) {}
+
+    // Resize both lanes (rounded up to a power of two); only while unused
+    void set_capacity(size_t capacity);
+    size_t capacity() const { return items_.capacity(); }
+
+    bool push(Job&& job);
+    bool try_push(Job&& job);   // false if full or closed; job is left intact
+    bool pop(Job& job, JobPriority lane = JobPriority::Normal);
+    // Take the oldest normal-priority job unless it belongs to `batch_id`
+    bool try_pop_oldest_unless(uint64_t batch_id, Job& job);
+    void close();
+    void reopen();
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+    size_t size() const;
+
+private:
+    MpmcRing<Job>& lane(JobPriority priority) {
+        return priority == JobPriority::Background ? background_ : items_;
+    }
+    bool try_pop_any(Job& job);
+    bool try_pop_ready(JobPriority lane, Job& job);
+    // Wake one sleeper on `cv` if any announced itself in `waiting`
+    void wake(std::condition_variable& cv, std::atomic<int>& waiting, bool all);
+    void drain();
+
+    MpmcRing<Job> items_;
+    MpmcRing<Job> background_;
+    std::atomic<bool> closed_{false};
+
+    // Slow path only: sleeping producers/consumers
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable background_ready_;
+    std::condition_variable not_full_;
+    std::atomic<int> waiting_consumers_{0};
+    std::atomic<int> waiting_background_{0};
+    std::atomic<int> waiting_producers_{0};
+};
+
+/**
+ * Bounded blocking hand-off between two pipeline stages. close() drops
+ * what is queued and makes push()/pop() return false.
+ */
+class StageQueue {
+public:
+    bool push(StagedJob&& job);
+    bool pop(StagedJob& job);
+    void close();
+    void reopen(size_t capacity);
+
+private:
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<StagedJob> items_;
+    size_t capacity_ = 1;
+    bool closed_ = false;
+};
+
+struct Batch {
+    uint64_t id = 0;
+    std::atomic<uint64_t> submitted{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> failed{0};
+    std::atomic<bool> parsing{true};
+    std::atomic<uint64_t> pixels_total{0};   // probed cost of submitted entries
+    std::atomic<uint64_t> pixels_done{0};
+
+    std::mutex mutex;          // guards error, output_path, results, finished
+    std::string error;
+    std::string output_path;   // last successful output (single-job batches)
+    FILE* results = nullptr;
+    bool finished = false;
+};
+
+/**
+ * Owns the job queue, the worker threads and batch bookkeeping.
+ * Workers start lazily on the first submission.
+ */
+class JobSystem {
+public:
+    static JobSystem& instance();
+
+    /**
+     * max_pixels: admission limit per entry (0 = none). With a pipeline,
+     * each stage gets `workers` threads and batch jobs flow through it.
+     * Background jobs always run on one extra thread of their own.
+     */
+    void configure(int workers, uint64_t max_pixels, JobExecutor executor,
+                   JobPipeline pipeline = JobPipeline());
+
+    // Queue capacity per lane and full-queue behaviour; before any submission
+    void configure_queue(size_t capacity, QueueFullPolicy policy);
+
+    /**
+     * Change the worker count (per stage when pipelined) while running:
+     * missing threads start, surplus ones park after their current job.
+     */
+    void resize_workers(int workers);
+
+    /**
+     * Start streaming a manifest into the queue.
+     * @return batch id (> 0), or 0 with `error` set
+     */
+    uint64_t submit_manifest(const std::string& manifest_path,
+                             const std::string& results_path,
+                             std::string& error);
+
+    /**
+     * Queue a single job as its own batch without blocking.
+     * @return batch id (> 0), or 0 with `error` set (queue full / not configured)
+     */
+    uint64_t submit_job(Job job, std::string& error);
+
+    // JSON status of a batch, or empty string if unknown
+    std::string batch_status(uint64_t batch_id);
+
+    JobQueueStats queue_stats();
+
+    // Stop readers and workers; pending jobs are dropped
+    void shutdown();
+
+private:
+    JobSystem() : queue_(1024) {}
+
+    void start_workers_locked();
+    // Start workers for slots [spawned_workers_, count)
+    void spawn_workers_locked(int count);
+    // Parks a worker whose slot is beyond the active count; false once stopping
+    bool await_slot(int slot);
+    // Bracket running a job in one stage; at most the active count run at once
+    bool enter_stage(int stage);
+    void leave_stage(int stage);
+    bool admit(const std::shared_ptr<Batch>& batch, Job& job);
+    // Queue job under the full-queue policy; false with `rejected` filled in if not queued
+    bool enqueue(Job&& job, bool may_block, JobOutcome& rejected);
+    // Fail the oldest normal-lane job unless it is of `spared_batch`
+    bool evict_oldest(uint64_t spared_batch);
+    uint32_t retry_after_ms() const;
+    std::shared_ptr<Batch> new_batch_locked();
+    void worker_loop(int slot);
+    void background_loop();
+    void decode_loop(int slot);
+    void filter_loop(int slot);
+    void encode_loop(int slot);
+    void complete(const Job& job, const JobOutcome& outcome);
+    void reader_loop(std::shared_ptr<Batch> batch, std::string manifest_path);
+    void record(const std::shared_ptr<Batch>& batch, const Job& job, const JobOutcome& outcome);
+    void maybe_finish(const std::shared_ptr<Batch>& batch);
+    std::shared_ptr<Batch> find_batch(uint64_t id);
+
+    std::mutex mutex_;
+    JobQueue queue_;
+    std::atomic<QueueFullPolicy> policy_{QueueFullPolicy::Block};
+    std::atomic<uint64_t> blocked_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> last_completion_ns_{0};
+    std::atomic<uint64_t> completion_interval_ns_{0};   // smoothed time between completions
+    JobExecutor executor_;
+    JobPipeline pipeline_;
+    StageQueue decoded_;
+    StageQueue filtered_;
+    int worker_count_ = 1;
+    int spawned_workers_ = 0;   // per stage; never shrinks while running
+    std::atomic<int> active_workers_{1};
+    std::mutex park_mutex_;
+    std::condition_variable park_cv_;
+    int running_[3] = {};       // per stage, guarded by park_mutex_
+    std::atomic<uint64_t> max_pixels_{0};
+    std::vector<std::thread> workers_;
+    std::vector<std::thread> readers_;
+    std::map<uint64_t, std::shared_ptr<Batch>> batches_;
+    std::deque<uint64_t> finished_batches_;   // oldest first; bounds batches_
+    uint64_t next_batch_id_ = 1;
+    std::atomic<bool> stopping_{false};
+};
+
+} // namespace planter
+
+#endif
@@ -0,0 +1,380 @@
+/**
+ * @file json_util.cpp
+ * @brief Planter Pressure - Minimal In-Place JSON Reader
+ */
+
+#include "json_util.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace planter {
+
+namespace {
+
+    // Deep enough for any manifest or request; guards against stack exhaustion
+    constexpr int MAX_DEPTH = 64;
+
+    inline bool is_ws(char c) {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    int hex_value(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    void append_utf8(std::string& out, unsigned cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool skip_value_impl(JsonReader& r, int depth);
+
+    bool skip_container(JsonReader& r, bool object, int depth) {
+        if (depth > MAX_DEPTH) return false;
+        bool done = false;
+        if (object) {
+            if (!r.begin_object()) return false;
+            std::string key;
+            for (;;) {
+                if (!r.next_key(key, done)) return false;
+                if (done) return true;
+                if (!skip_value_impl(r, depth + 1)) return false;
+            }
+        }
+        if (!r.begin_array()) return false;
+        for (;;) {
+            if (!r.next_element(done)) return false;
+            if (done) return true;
+            if (!skip_value_impl(r, depth + 1)) return false;
+        }
+    }
+
+    bool skip_value_impl(JsonReader& r, int depth) {
+        char c = r.peek();
+        if (c == '{') return skip_container(r, true, depth);
+        if (c == '[') return skip_container(r, false, depth);
+        if (c == '"') {
+            std::string ignored;
+            return r.read_string(ignored);
+        }
+        if (c == 't' || c == 'f') {
+            bool ignored;
+            return r.read_bool(ignored);
+        }
+        if (c == 'n') return r.read_null();
+        double ignored;
+        return r.read_number(ignored);
+    }
+
+    bool canonical_value(JsonReader& r, std::string& out, int depth, const char* skip_key) {
+        if (depth > MAX_DEPTH) return false;
+        char c = r.peek();
+        bool done = false;
+
+        if (c == '{') {
+            if (!r.begin_object()) return false;
+            std::vector<std::pair<std::string, std::string>> members;
+            std::string key;
+            for (;;) {
+                if (!r.next_key(key, done)) return false;
+                if (done) break;
+                if (skip_key && key == skip_key) {
+                    if (!r.skip_value()) return false;
+                    continue;
+                }
+                std::string value;
+                if (!canonical_value(r, value, depth + 1, nullptr)) return false;
+                members.emplace_back(key, std::move(value));
+            }
+            std::sort(members.begin(), members.end());
+            out += '{';
+            for (size_t i = 0; i < members.size(); ++i) {
+                if (i) out += ',';
+                out += '"' + json_escape(members[i].first) + "\":" + members[i].second;
+            }
+            out += '}';
+            return true;
+        }
+        if (c == '[') {
+            if (!r.begin_array()) return false;
+            out += '[';
+            for (bool first = true;; first = false) {
+                if (!r.next_element(done)) return false;
+                if (done) break;
+                if (!first) out += ',';
+                if (!canonical_value(r, out, depth + 1, nullptr)) return false;
+            }
+            out += ']';
+            return true;
+        }
+        if (c == '"') {
+            std::string value;
+            if (!r.read_string(value)) return false;
+            out += '"' + json_escape(value) + '"';
+            return true;
+        }
+        if (c == 't' || c == 'f') {
+            bool value = false;
+            if (!r.read_bool(value)) return false;
+            out += value ? "true" : "false";
+            return true;
+        }
+        if (c == 'n') {
+            if (!r.read_null()) return false;
+            out += "null";
+            return true;
+        }
+        double value = 0.0;
+        if (!r.read_number(value)) return false;
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.17g", value);
+        out += buf;
+        return true;
+    }
+
+} // anonymous namespace
+
+JsonReader::JsonReader(const char* data, size_t size) : data_(data), size_(size) {
+    // Tolerate a UTF-8 BOM, common in manifests written by Windows tools
+    if (size_ >= 3 && memcmp(data_, "\xEF\xBB\xBF", 3) == 0) {
+        pos_ = 3;
+    }
+}
+
+void JsonReader::skip_ws() {
+    while (pos_ < size_ && is_ws(data_[pos_])) ++pos_;
+}
+
+bool JsonReader::fail(const char* what) {
+    if (error_.empty()) {
+        error_ = std::string(what) + " at offset " + std::to_string(pos_);
+    }
+    return false;
+}
+
+bool JsonReader::expect(char c) {
+    skip_ws();
+    if (pos_ >= size_ || data_[pos_] != c) {
+        return fail(c == '{' ? "Expected object" : c == '[' ? "Expected array" :
+                    c == ':' ? "Expected ':'" : "Unexpected character");
+    }
+    ++pos_;
+    return true;
+}
+
+char JsonReader::peek() {
+    skip_ws();
+    return pos_ < size_ ? data_[pos_] : 0;
+}
+
+bool JsonReader::begin_object() { return expect('{'); }
+bool JsonReader::begin_array() { return expect('['); }
+
+bool JsonReader::separator(char open, char close, bool& done) {
+    skip_ws();
+    if (pos_ >= size_) return fail("Unexpected end of input");
+
+    if (data_[pos_] == close) {
+        ++pos_;
+        done = true;
+        return true;
+    }
+    done = false;
+
+    // First member follows the opening bracket directly; later ones need a comma
+    size_t back = pos_;
+    while (back > 0 && is_ws(data_[back - 1])) --back;
+    if (back > 0 && data_[back - 1] == open) {
+        return true;
+    }
+    return expect(',');
+}
+
+bool JsonReader::next_key(std::string& key, bool& done) {
+    if (!separator('{', '}', done) || done) return error_.empty();
+    if (peek() != '"') return fail("Expected key");
+    if (!read_string(key)) return false;
+    return expect(':');
+}
+
+bool JsonReader::next_element(bool& done) {
+    return separator('[', ']', done);
+}
+
+bool JsonReader::read_string(std::string& out) {
+    if (!expect('"')) return false;
+    out.clear();
+
+    size_t start = pos_;
+    while (pos_ < size_) {
+        char c = data_[pos_];
+        if (c == '"') {
+            out.append(data_ + start, pos_ - start);
+            ++pos_;
+            return true;
+        }
+        if (c != '\\') {
+            ++pos_;
+            continue;
+        }
+
+        out.append(data_ + start, pos_ - start);
+        if (++pos_ >= size_) break;
+        char e = data_[pos_++];
+        switch (e) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                auto read_hex4 = [&](unsigned& cp) {
+                    if (pos_ + 4 > size_) return false;
+                    cp = 0;
+                    for (int i = 0; i < 4; ++i) {
+                        int v = hex_value(data_[pos_ + i]);
+                        if (v < 0) return false;
+                        cp = (cp << 4) | static_cast<unsigned>(v);
+                    }
+                    pos_ += 4;
+                    return true;
+                };
+                unsigned cp = 0;
+                if (!read_hex4(cp)) return fail("Bad \\u escape");
+                // Surrogates only come in high/low pairs; a lone one has no UTF-8 form
+                if (cp >= 0xDC00 && cp < 0xE000) return fail("Unpaired surrogate");
+                if (cp >= 0xD800 && cp < 0xDC00) {
+                    if (pos_ + 1 >= size_ || data_[pos_] != '\\' || data_[pos_ + 1] != 'u') {
+                        return fail("Unpaired surrogate");
+                    }
+                    pos_ += 2;
+                    unsigned low = 0;
+                    if (!read_hex4(low)) return fail("Bad \\u escape");
+                    if (low < 0xDC00 || low >= 0xE000) return fail("Unpaired surrogate");
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                }
+                append_utf8(out, cp);
+                break;
+            }
+            default:
+                return fail("Bad escape");
+        }
+        start = pos_;
+    }
+    return fail("Unterminated string");
+}
+
+bool JsonReader::read_number(double& out) {
+    skip_ws();
+
+    size_t start = pos_;
+    while (pos_ < size_) {
+        char c = data_[pos_];
+        if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+            ++pos_;
+        } else {
+            break;
+        }
+    }
+    if (pos_ == start) return fail("Expected number");
+
+    // strtod needs a terminator; numbers are short
+    char buf[64];
+    size_t len = pos_ - start;
+    if (len >= sizeof(buf)) return fail("Number too long");
+    memcpy(buf, data_ + start, len);
+    buf[len] = '\0';
+
+    char* end = nullptr;
+    out = strtod(buf, &end);
+    if (end != buf + len) return fail("Malformed number");
+    return true;
+}
+
+bool JsonReader::read_bool(bool& out) {
+    skip_ws();
+    if (pos_ + 4 <= size_ && memcmp(data_ + pos_, "true", 4) == 0) {
+        pos_ += 4;
+        out = true;
+        return true;
+    }
+    if (pos_ + 5 <= size_ && memcmp(data_ + pos_, "false", 5) == 0) {
+        pos_ += 5;
+        out = false;
+        return true;
+    }
+    return fail("Expected boolean");
+}
+
+bool JsonReader::read_null() {
+    skip_ws();
+    if (pos_ + 4 <= size_ && memcmp(data_ + pos_, "null", 4) == 0) {
+        pos_ += 4;
+        return true;
+    }
+    return fail("Expected null");
+}
+
+bool JsonReader::skip_value() {
+    return skip_value_impl(*this, 0);
+}
+
+bool canonical_json(const char* data, size_t size, std::string& out, std::string& error,
+                    const char* skip_key) {
+    JsonReader r(data, size);
+    out.clear();
+    if (!canonical_value(r, out, 0, skip_key) || r.peek() != 0) {
+        error = r.error().empty() ? "Malformed JSON" : r.error();
+        return false;
+    }
+    return true;
+}
+
+std::string json_escape(const std::string& in) {
+    std::string escaped;
+    escaped.reserve(in.size() + 16);
+    for (char c : in) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+                    escaped += buf;
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped;
+}
+
+} // namespace planter
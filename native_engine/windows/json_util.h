@@ -0,0 +1,77 @@
+/**
+ * @file json_util.h
+ * @brief Planter Pressure - Minimal In-Place JSON Reader
+ *
+ * OPTIMIZATIONS:
+ * - Single forward pass over the raw bytes, no DOM
+ * - Values not asked for are skipped without being materialized
+ * - Canonical form (sorted keys, no whitespace) lets requests serve as cache keys
+ */
+
+#ifndef PLANTER_PRESSURE_JSON_UTIL_H
+#define PLANTER_PRESSURE_JSON_UTIL_H
+
+#include <cstddef>
+#include <string>
+
+namespace planter {
+
+/**
+ * Pull-style cursor over a JSON document held in memory.
+ * Every method returns false on malformed input; error() says where.
+ */
+class JsonReader {
+public:
+    JsonReader(const char* data, size_t size);
+
+    // Peek at the next value's first character ('{', '[', '"', 't', ...), 0 at end
+    char peek();
+
+    bool begin_object();
+    bool begin_array();
+
+    /**
+     * Advance to the next object member / array element.
+     * Sets `done` when the closing bracket was consumed.
+     */
+    bool next_key(std::string& key, bool& done);
+    bool next_element(bool& done);
+
+    bool read_string(std::string& out);
+    bool read_number(double& out);
+    bool read_bool(bool& out);
+    bool read_null();
+    bool skip_value();
+
+    size_t offset() const { return pos_; }
+    void seek(size_t offset) { pos_ = offset; }
+
+    const std::string& error() const { return error_; }
+
+private:
+    void skip_ws();
+    bool fail(const char* what);
+    bool expect(char c);
+    bool separator(char open, char close, bool& done);
+
+    const char* data_;
+    size_t size_;
+    size_t pos_ = 0;
+    std::string error_;
+};
+
+/**
+ * Re-serialize a JSON document with object keys sorted and no whitespace,
+ * so equal documents compare equal as strings. Numbers are normalized via
+ * double. `skip_key` (if set) is dropped from the top-level object.
+ * @return false with `error` set on malformed input
+ */
+bool canonical_json(const char* data, size_t size, std::string& out, std::string& error,
+                    const char* skip_key = nullptr);
+
+// Escape a string for embedding between JSON double quotes
+std::string json_escape(const std::string& in);
+
+} // namespace planter
+
+#endif
@@ -0,0 +1,459 @@
+/**
+ * @file kernels.cpp
+ * @brief Planter Pressure - Native Stage Kernels
+ */
+
+#include "kernels.h"
+#include "allocator.h"
+#include "frame_pool.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PLANTER_HAVE_SSE2 1
+#endif
+
+namespace planter {
+
+namespace {
+
+    // Rows per tile-pool chunk; large enough to amortize scheduling
+    constexpr int ROW_GRAIN = 32;
+
+    const float SMOOTH_KERNEL[9] = {
+        1 / 13.f, 1 / 13.f, 1 / 13.f,
+        1 / 13.f, 5 / 13.f, 1 / 13.f,
+        1 / 13.f, 1 / 13.f, 1 / 13.f,
+    };
+
+    const float EDGE_ENHANCE_KERNEL[9] = {
+        -1 / 2.f, -1 / 2.f, -1 / 2.f,
+        -1 / 2.f, 10 / 2.f, -1 / 2.f,
+        -1 / 2.f, -1 / 2.f, -1 / 2.f,
+    };
+
+    inline uint8_t clip8(float v) {
+        if (v <= 0.f) return 0;
+        if (v >= 255.f) return 255;
+        return static_cast<uint8_t>(v + 0.5f);
+    }
+
+    void apply_lut(const uint8_t* in, uint8_t* out, size_t n, const uint8_t* lut) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = lut[in[i]];
+        }
+    }
+
+    void convolve_row(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+                      uint8_t* out, int width, const float k[9]) {
+        const size_t C = FRAME_CHANNELS;
+        const size_t last = static_cast<size_t>(width - 1) * C;
+
+        // Left/right border pixels are copied unchanged
+        memcpy(out, center, C);
+        for (size_t i = C; i < last; ++i) {
+            float s = k[0] * above[i - C] + k[1] * above[i] + k[2] * above[i + C]
+                    + k[3] * center[i - C] + k[4] * center[i] + k[5] * center[i + C]
+                    + k[6] * below[i - C] + k[7] * below[i] + k[8] * below[i + C];
+            out[i] = clip8(s);
+        }
+        memcpy(out + last, center + last, C);
+    }
+
+    // Upper bound on band progress events per chain
+    constexpr int MAX_PROGRESS_EVENTS = 32;
+
+    /**
+     * Counts completed bands across all passes and forwards every
+     * total/MAX_PROGRESS_EVENTS-th completion (and the last) to the hook.
+     */
+    class BandProgress {
+    public:
+        BandProgress(const EnhanceParams& params, int total)
+            : params_(params), total_(total),
+              step_(std::max(1, (total + MAX_PROGRESS_EVENTS - 1) / MAX_PROGRESS_EVENTS)) {}
+
+        void band_done() {
+            if (!params_.progress) return;
+            int done = done_.fetch_add(1) + 1;
+            if (done % step_ == 0 || done == total_) {
+                params_.progress(params_.progress_ctx, done, total_);
+            }
+        }
+
+    private:
+        const EnhanceParams& params_;
+        int total_;
+        int step_;
+        std::atomic<int> done_{0};
+    };
+
+    // Sharpness(f) = f * img - (f - 1) * smooth(img), as one kernel
+    void sharpness_kernel(float factor, float k[9]) {
+        for (int i = 0; i < 9; ++i) {
+            k[i] = -(factor - 1.f) * SMOOTH_KERNEL[i];
+        }
+        k[4] += factor;
+    }
+
+    // Output pixels [0, count) of one reduced row from source rows r0 and r1
+    int reduce2x_simd(const uint8_t* r0, const uint8_t* r1, uint8_t* out, int count) {
+        int x = 0;
+#ifdef PLANTER_HAVE_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i round = _mm_set1_epi16(2);
+
+        // 8 source pixels per row -> 4 output pixels
+        for (; x + 4 <= count; x += 4) {
+            const uint8_t* a = r0 + static_cast<size_t>(x) * 2 * FRAME_CHANNELS;
+            const uint8_t* b = r1 + static_cast<size_t>(x) * 2 * FRAME_CHANNELS;
+            __m128i packed[2];
+            for (int half = 0; half < 2; ++half) {
+                __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + half * 16));
+                __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + half * 16));
+
+                // Vertical sums of pixels p0 p1 (lo) and p2 p3 (hi) in 16-bit lanes
+                __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(va, zero), _mm_unpacklo_epi8(vb, zero));
+                __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(va, zero), _mm_unpackhi_epi8(vb, zero));
+
+                // Horizontal pairs: (p0 + p1), (p2 + p3)
+                __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+                packed[half] = _mm_srli_epi16(_mm_add_epi16(sum, round), 2);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + static_cast<size_t>(x) * FRAME_CHANNELS),
+                             _mm_packus_epi16(packed[0], packed[1]));
+        }
+#endif
+        return x;
+    }
+
+    void reduce2x_row(const uint8_t* r0, const uint8_t* r1, uint8_t* out, int src_width) {
+        const size_t C = FRAME_CHANNELS;
+        const int pairs = src_width / 2;
+
+        int x = reduce2x_simd(r0, r1, out, pairs);
+        for (; x < pairs; ++x) {
+            const size_t s = static_cast<size_t>(x) * 2 * C;
+            for (size_t c = 0; c < C; ++c) {
+                out[x * C + c] = static_cast<uint8_t>(
+                        (r0[s + c] + r0[s + C + c] + r1[s + c] + r1[s + C + c] + 2) >> 2);
+            }
+        }
+        if (src_width & 1) {
+            const size_t s = static_cast<size_t>(src_width - 1) * C;
+            for (size_t c = 0; c < C; ++c) {
+                out[x * C + c] = static_cast<uint8_t>((2 * r0[s + c] + 2 * r1[s + c] + 2) >> 2);
+            }
+        }
+    }
+
+    // Lanczos window a = 3
+    constexpr double LANCZOS_SUPPORT = 3.0;
+
+    double sinc(double x) {
+        if (x == 0.0) return 1.0;
+        x *= 3.14159265358979323846;
+        return std::sin(x) / x;
+    }
+
+    double lanczos(double x) {
+        return (x > -LANCZOS_SUPPORT && x < LANCZOS_SUPPORT) ? sinc(x) * sinc(x / LANCZOS_SUPPORT) : 0.0;
+    }
+
+    /**
+     * Normalised taps for one axis: output i reads `count[i]` inputs from
+     * `first[i]` with weights at weights[i * max_taps].
+     */
+    struct ResampleTaps {
+        std::vector<int> first;
+        std::vector<int> count;
+        std::vector<float> weights;
+        int max_taps = 0;
+    };
+
+    ResampleTaps lanczos_taps(int in_size, int out_size) {
+        const double scale = static_cast<double>(in_size) / out_size;
+        const double filter_scale = std::max(1.0, scale);
+        const double support = LANCZOS_SUPPORT * filter_scale;
+
+        ResampleTaps taps;
+        taps.max_taps = static_cast<int>(std::ceil(support)) * 2 + 1;
+        taps.first.resize(out_size);
+        taps.count.resize(out_size);
+        taps.weights.assign(static_cast<size_t>(out_size) * taps.max_taps, 0.f);
+
+        for (int i = 0; i < out_size; ++i) {
+            const double center = (i + 0.5) * scale;
+            const int lo = std::max(0, static_cast<int>(center - support + 0.5));
+            const int hi = std::min(in_size, static_cast<int>(center + support + 0.5));
+            const int n = std::min(hi - lo, taps.max_taps);
+
+            float* w = &taps.weights[static_cast<size_t>(i) * taps.max_taps];
+            double total = 0.0;
+            for (int k = 0; k < n; ++k) {
+                double v = lanczos((lo + k - center + 0.5) / filter_scale);
+                w[k] = static_cast<float>(v);
+                total += v;
+            }
+            if (total != 0.0) {
+                for (int k = 0; k < n; ++k) {
+                    w[k] = static_cast<float>(w[k] / total);
+                }
+            }
+            taps.first[i] = lo;
+            taps.count[i] = n;
+        }
+        return taps;
+    }
+
+    // One output pixel: sum of w[k] * px[k] over n RGBX pixels
+    inline void weighted_pixel(const uint8_t* px, const float* w, int n, uint8_t* out) {
+#ifdef PLANTER_HAVE_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        __m128 acc = _mm_setzero_ps();
+        for (int k = 0; k < n; ++k) {
+            int bits;
+            memcpy(&bits, px + static_cast<size_t>(k) * FRAME_CHANNELS, sizeof(bits));
+            __m128i v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bits), zero), zero);
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(w[k])));
+        }
+        // Round, then saturate 32 -> 16 -> 8 bits
+        __m128i r = _mm_packs_epi32(_mm_cvtps_epi32(acc), zero);
+        int packed = _mm_cvtsi128_si32(_mm_packus_epi16(r, zero));
+        memcpy(out, &packed, sizeof(packed));
+#else
+        float acc[FRAME_CHANNELS] = {};
+        for (int k = 0; k < n; ++k) {
+            for (int c = 0; c < FRAME_CHANNELS; ++c) {
+                acc[c] += w[k] * px[k * FRAME_CHANNELS + c];
+            }
+        }
+        for (int c = 0; c < FRAME_CHANNELS; ++c) {
+            out[c] = clip8(acc[c]);
+        }
+#endif
+    }
+
+    // Pillow's DIV255: exact round(v / 255) for v <= 255 * 255
+    inline uint8_t div255(unsigned v) {
+        v += 128;
+        return static_cast<uint8_t>((v + (v >> 8)) >> 8);
+    }
+
+} // anonymous namespace
+
+void flatten_alpha_row(uint8_t* row, int width) {
+    int x = 0;
+#ifdef PLANTER_HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi16(255);
+    const __m128i round = _mm_set1_epi16(128);
+    const __m128i opaque = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+    // 4 pixels per step, 2 per 16-bit half
+    for (; x + 4 <= width; x += 4) {
+        uint8_t* p = row + static_cast<size_t>(x) * FRAME_CHANNELS;
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i halves[2] = {_mm_unpacklo_epi8(v, zero), _mm_unpackhi_epi8(v, zero)};
+        for (__m128i& c : halves) {
+            __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, _MM_SHUFFLE(3, 3, 3, 3)),
+                                            _MM_SHUFFLE(3, 3, 3, 3));
+            // c * a + 255 * (255 - a), then DIV255
+            __m128i t = _mm_add_epi16(_mm_mullo_epi16(c, a),
+                                      _mm_mullo_epi16(_mm_sub_epi16(full, a), full));
+            t = _mm_add_epi16(t, round);
+            c = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+        }
+        v = _mm_or_si128(_mm_packus_epi16(halves[0], halves[1]), opaque);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+    }
+#endif
+    for (; x < width; ++x) {
+        uint8_t* p = row + static_cast<size_t>(x) * FRAME_CHANNELS;
+        const unsigned a = p[3];
+        for (int c = 0; c < 3; ++c) {
+            p[c] = div255(p[c] * a + 255 * (255 - a));
+        }
+        p[3] = 0xFF;
+    }
+}
+
+void expand_gray_row(const uint8_t* in, uint8_t* out, int width, bool alpha) {
+    const int step = alpha ? 2 : 1;
+    for (int x = 0; x < width; ++x, in += step, out += FRAME_CHANNELS) {
+        out[0] = out[1] = out[2] = in[0];
+        out[3] = alpha ? in[1] : 0xFF;
+    }
+    if (alpha) flatten_alpha_row(out - static_cast<size_t>(width) * FRAME_CHANNELS, width);
+}
+
+void expand_palette_row(const uint8_t* in, uint8_t* out, int width, const uint32_t palette[256]) {
+    for (int x = 0; x < width; ++x) {
+        memcpy(out + static_cast<size_t>(x) * FRAME_CHANNELS, &palette[in[x]], FRAME_CHANNELS);
+    }
+}
+
+bool filter3x3_rows(const FrameView& src, const FrameView& dst,
+                    const float kernel[9], const uint8_t* lut, int y0, int y1) {
+    const size_t row_bytes = static_cast<size_t>(src.width) * FRAME_CHANNELS;
+
+    if (src.width < 3 || src.height < 3) {
+        for (int y = y0; y < y1; ++y) {
+            if (lut) apply_lut(src.row(y), dst.row(y), row_bytes, lut);
+            else memcpy(dst.row(y), src.row(y), row_bytes);
+        }
+        return true;
+    }
+
+    // With a LUT, keep a rolling window of three transformed source rows
+    ScratchScope scratch;
+    uint8_t* window = nullptr;
+    auto source_row = [&](int y) -> const uint8_t* {
+        if (!lut) return src.row(y);
+        return window + static_cast<size_t>(y % 3) * row_bytes;
+    };
+    if (lut) {
+        window = static_cast<uint8_t*>(scratch.alloc(row_bytes * 3));
+        if (!window) return false;
+        for (int y = std::max(0, y0 - 1); y < std::min(src.height, y0 + 1); ++y) {
+            apply_lut(src.row(y), window + static_cast<size_t>(y % 3) * row_bytes, row_bytes, lut);
+        }
+    }
+
+    for (int y = y0; y < y1; ++y) {
+        if (lut && y + 1 < src.height) {
+            apply_lut(src.row(y + 1), window + static_cast<size_t>((y + 1) % 3) * row_bytes, row_bytes, lut);
+        }
+
+        if (y == 0 || y == src.height - 1) {
+            memcpy(dst.row(y), source_row(y), row_bytes);
+            continue;
+        }
+
+        convolve_row(source_row(y - 1), source_row(y), source_row(y + 1),
+                     dst.row(y), src.width, kernel);
+    }
+    return true;
+}
+
+uint64_t luma_sum_rows(const FrameView& src, int y0, int y1) {
+    uint64_t total = 0;
+    for (int y = y0; y < y1; ++y) {
+        const uint8_t* p = src.row(y);
+        uint32_t row_total = 0;
+        for (int x = 0; x < src.width; ++x, p += FRAME_CHANNELS) {
+            // Same fixed-point weights as Pillow's RGB -> L conversion
+            row_total += (p[0] * 19595u + p[1] * 38470u + p[2] * 7471u + 0x8000u) >> 16;
+        }
+        total += row_total;
+    }
+    return total;
+}
+
+void build_contrast_lut(int mean, float factor, uint8_t lut[256]) {
+    for (int v = 0; v < 256; ++v) {
+        float t = mean + factor * (v - mean);
+        lut[v] = t <= 0.f ? 0 : (t >= 255.f ? 255 : static_cast<uint8_t>(t));
+    }
+}
+
+int run_enhance_chain(const FrameView& a, const FrameView& b, const EnhanceParams& params) {
+    TilePool& pool = TilePool::instance();
+    const int h = a.height;
+
+    // Three passes, each split into ROW_GRAIN bands
+    BandProgress progress(params, 3 * ((h + ROW_GRAIN - 1) / ROW_GRAIN));
+
+    // Stage 1: sharpness, a (or the shared source) -> b
+    const FrameView& in = params.source ? *params.source : a;
+    float sharpen[9];
+    sharpness_kernel(params.sharpness, sharpen);
+    pool.parallel_for(0, h, ROW_GRAIN, [&](int y0, int y1) {
+        filter3x3_rows(in, b, sharpen, nullptr, y0, y1);
+        progress.band_done();
+    });
+
+    // Stage 2: edge enhance, b -> a, accumulating luma for the contrast mean
+    const bool own_mean = params.contrast_mean < 0;
+    std::atomic<uint64_t> luma_total{0};
+    pool.parallel_for(0, h, ROW_GRAIN, [&](int y0, int y1) {
+        filter3x3_rows(b, a, EDGE_ENHANCE_KERNEL, nullptr, y0, y1);
+        if (own_mean) luma_total.fetch_add(luma_sum_rows(a, y0, y1));
+        progress.band_done();
+    });
+
+    // Stage 3+4: contrast LUT fused into the smooth pass, a -> b
+    uint64_t pixels = static_cast<uint64_t>(a.width) * static_cast<uint64_t>(h);
+    int mean = params.contrast_mean;
+    if (own_mean) {
+        mean = pixels ? static_cast<int>(static_cast<double>(luma_total.load()) / pixels + 0.5) : 0;
+    }
+
+    uint8_t lut[256];
+    build_contrast_lut(mean, params.contrast, lut);
+    std::atomic<bool> failed{false};
+    pool.parallel_for(0, h, ROW_GRAIN, [&](int y0, int y1) {
+        if (!filter3x3_rows(a, b, SMOOTH_KERNEL, lut, y0, y1)) failed = true;
+        progress.band_done();
+    });
+
+    return failed ? -1 : 1;
+}
+
+void reduce2x(const FrameView& src, const FrameView& dst) {
+    TilePool::instance().parallel_for(0, dst.height, ROW_GRAIN, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            const uint8_t* r0 = src.row(2 * y);
+            const uint8_t* r1 = src.row(std::min(2 * y + 1, src.height - 1));
+            reduce2x_row(r0, r1, dst.row(y), src.width);
+        }
+    });
+}
+
+void resample_lanczos(const FrameView& src, const FrameView& tmp, const FrameView& dst) {
+    TilePool& pool = TilePool::instance();
+    const ResampleTaps xt = lanczos_taps(src.width, dst.width);
+    const ResampleTaps yt = lanczos_taps(src.height, dst.height);
+
+    // Horizontal: src -> tmp, row by row
+    pool.parallel_for(0, src.height, ROW_GRAIN, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            const uint8_t* in = src.row(y);
+            uint8_t* out = tmp.row(y);
+            for (int x = 0; x < dst.width; ++x) {
+                weighted_pixel(in + static_cast<size_t>(xt.first[x]) * FRAME_CHANNELS,
+                               &xt.weights[static_cast<size_t>(x) * xt.max_taps], xt.count[x],
+                               out + static_cast<size_t>(x) * FRAME_CHANNELS);
+            }
+        }
+    });
+
+    // Vertical: tmp -> dst, accumulating whole rows so the inner loop is contiguous
+    const size_t row_values = static_cast<size_t>(dst.width) * FRAME_CHANNELS;
+    pool.parallel_for(0, dst.height, ROW_GRAIN, [&](int y0, int y1) {
+        std::vector<float> acc(row_values);
+        for (int y = y0; y < y1; ++y) {
+            std::fill(acc.begin(), acc.end(), 0.f);
+            const float* w = &yt.weights[static_cast<size_t>(y) * yt.max_taps];
+            for (int k = 0; k < yt.count[y]; ++k) {
+                const uint8_t* in = tmp.row(yt.first[y] + k);
+                const float wk = w[k];
+                for (size_t i = 0; i < row_values; ++i) {
+                    acc[i] += wk * in[i];
+                }
+            }
+            uint8_t* out = dst.row(y);
+            for (size_t i = 0; i < row_values; ++i) {
+                out[i] = clip8(acc[i]);
+            }
+        }
+    });
+}
+
+} // namespace planter
@@ -0,0 +1,107 @@
+/**
+ * @file kernels.h
+ * @brief Planter Pressure - Native Stage Kernels
+ *
+ * OPTIMIZATIONS:
+ * - Stages ping-pong between two pooled frames (no per-stage allocation)
+ * - Sharpness blend folded into a single 3x3 kernel
+ * - Contrast applied as a LUT while loading rows for the smooth pass
+ * - Row bands processed on the tile pool
+ * - Pyramid levels built by an SSE2 2x2 box reduction
+ * - Separable Lanczos resampler with precomputed taps, 4 channels per SSE op
+ * - Alpha flatten onto white fused into decoder row output (SSE2, in place)
+ * - Grey and palette rows expanded straight into the frame (no RGB copy)
+ */
+
+#ifndef PLANTER_PRESSURE_KERNELS_H
+#define PLANTER_PRESSURE_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace planter {
+
+struct FrameView {
+    uint8_t* data = nullptr;
+    int width = 0;
+    int height = 0;
+    size_t stride = 0;
+
+    uint8_t* row(int y) const { return data + static_cast<size_t>(y) * stride; }
+};
+
+// Called from tile workers as row bands complete (throttled)
+using BandProgressFn = void (*)(void* ctx, int done, int total);
+
+struct EnhanceParams {
+    float sharpness = 1.5f;
+    float contrast = 1.2f;
+    // Luma mean contrast is relative to; < 0 = the edge-enhanced frame's own
+    int contrast_mean = -1;
+
+    // If set, stage 1 reads from here instead of `a`, which is then pure
+    // scratch; the source stays untouched (shared by several variants)
+    const FrameView* source = nullptr;
+
+    BandProgressFn progress = nullptr;
+    void* progress_ctx = nullptr;
+};
+
+/**
+ * Composite a row of straight-alpha RGBA onto white, in place, leaving
+ * RGBX with X = 255. Rounds exactly like Pillow's paste with a mask.
+ */
+void flatten_alpha_row(uint8_t* row, int width);
+
+/**
+ * Expand a row of 8-bit grey (L) or grey + alpha (LA) into RGBX; LA is
+ * flattened onto white, matching convert('RGBA') + flatten_alpha_row.
+ */
+void expand_gray_row(const uint8_t* in, uint8_t* out, int width, bool alpha);
+
+// Expand a row of palette indices through a 256-entry RGBX table
+void expand_palette_row(const uint8_t* in, uint8_t* out, int width, const uint32_t palette[256]);
+
+/**
+ * 3x3 convolution over rows [y0, y1) of src into dst (RGBX).
+ * Border pixels are copied, matching Pillow's ImageFilter behaviour.
+ * If lut is non-null it is applied to every source sample first.
+ *
+ * @return false if the LUT's row window could not be allocated (dst rows
+ *         are then left unwritten)
+ */
+bool filter3x3_rows(const FrameView& src, const FrameView& dst,
+                    const float kernel[9], const uint8_t* lut, int y0, int y1);
+
+// Sum of ITU-R 601 luma over rows [y0, y1)
+uint64_t luma_sum_rows(const FrameView& src, int y0, int y1);
+
+// Pillow-compatible contrast table: mean + factor * (v - mean), clipped
+void build_contrast_lut(int mean, float factor, uint8_t lut[256]);
+
+/**
+ * Run sharpness -> edge enhance -> contrast -> smooth.
+ * `a` holds the input (unless params.source is set); `b` is scratch of the
+ * same geometry.
+ *
+ * @return 0 if the result ended up in `a`, 1 if in `b`, -1 if out of memory
+ */
+int run_enhance_chain(const FrameView& a, const FrameView& b, const EnhanceParams& params);
+
+/**
+ * Halve src into dst with a rounded 2x2 box average.
+ * dst must be ceil(width / 2) x ceil(height / 2); an odd last column/row
+ * is averaged with itself.
+ */
+void reduce2x(const FrameView& src, const FrameView& dst);
+
+/**
+ * Separable Lanczos-3 resample of src into dst. When shrinking, the kernel
+ * widens with the scale factor (antialiased, like Pillow's LANCZOS).
+ * `tmp` is scratch of dst.width x src.height.
+ */
+void resample_lanczos(const FrameView& src, const FrameView& tmp, const FrameView& dst);
+
+} // namespace planter
+
+#endif
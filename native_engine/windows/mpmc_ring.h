@@ -0,0 +1,132 @@
+/**
+ * @file mpmc_ring.h
+ * @brief Planter Pressure - Bounded Lock-Free MPMC Ring
+ *
+ * OPTIMIZATIONS:
+ * - Producers and consumers claim cells with one CAS on their own
+ *   cursor; no lock is taken on the submit or dispatch path
+ * - Per-cell sequence numbers hand each value over exactly once, so
+ *   values are moved in and out without copying
+ * - Cursors sit on separate cache lines; producers and consumers don't
+ *   invalidate each other's line on every operation
+ */
+
+#ifndef PLANTER_PRESSURE_MPMC_RING_H
+#define PLANTER_PRESSURE_MPMC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace planter {
+
+/**
+ * Fixed-capacity FIFO for any number of producers and consumers
+ * (Vyukov's bounded queue). try_push()/try_pop() never block; callers
+ * that want to wait for room or data build that on top.
+ *
+ * Each value may carry a caller-defined tag that try_pop_if() tests
+ * before taking the oldest value, without touching the value itself.
+ */
+template <typename T>
+class MpmcRing {
+public:
+    explicit MpmcRing(size_t capacity) { reset(capacity); }
+
+    /**
+     * Drop everything and resize to `capacity` rounded up to a power of two.
+     * Not thread-safe: only while no other thread uses the ring.
+     */
+    void reset(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        cells_.reset(new Cell[size]);
+        for (size_t i = 0; i < size; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        mask_ = size - 1;
+        enqueue_pos_.store(0, std::memory_order_relaxed);
+        dequeue_pos_.store(0, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+    // Moves from `value` only on success
+    bool try_push(T&& value, uint64_t tag = 0) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.tag.store(tag, std::memory_order_relaxed);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;   // full: the cell still holds a value from one lap ago
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_pop(T& value) {
+        return try_pop_if(value, [](uint64_t) { return true; });
+    }
+
+    /**
+     * Take the oldest value only if accept(its tag) holds; false if the
+     * ring is empty or the oldest value was refused (it stays first).
+     */
+    template <typename Accept>
+    bool try_pop_if(T& value, Accept accept) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                // The tag is published with the value; if another consumer
+                // takes this cell first, the CAS below fails and we retry
+                if (!accept(cell.tag.load(std::memory_order_relaxed))) return false;
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.value = T();
+                    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;   // empty
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Snapshot; may be stale by the time it is read
+    size_t size_approx() const {
+        size_t tail = enqueue_pos_.load(std::memory_order_relaxed);
+        size_t head = dequeue_pos_.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        std::atomic<uint64_t> tag{0};
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+};
+
+} // namespace planter
+
+#endif
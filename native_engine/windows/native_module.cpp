@@ -0,0 +1,807 @@
+/**
+ * @file native_module.cpp
+ * @brief Planter Pressure - Built-in `planter_native` Python Module
+ *
+ * OPTIMIZATIONS:
+ * - Frames are pooled engine memory, not Python/Pillow allocations
+ * - GIL released while kernels run
+ * - Buffer protocol so Pillow can map frames without copying, and numpy /
+ *   memoryview get a strided (height, width, 4) view for Python hooks
+ * - Native decoders fill frames directly; Pillow only sees formats they skip
+ * - Plug-in filters run on the tile pool straight from Python ops lists
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "native_module.h"
+#include "decoder.h"
+#include "frame_pool.h"
+#include "kernels.h"
+#include "plugins.h"
+#include "prefetch.h"
+#include "progress.h"
+
+namespace planter {
+
+namespace {
+
+// =============================================================================
+// Frame Object
+// =============================================================================
+
+    struct FrameObject {
+        PyObject_HEAD
+        FrameBuffer* buffer;
+        int width;
+        int height;
+        Py_ssize_t stride;
+        Py_ssize_t exports;
+        Py_ssize_t shape[3];    // (height, width, channels) for N-d consumers
+        Py_ssize_t strides[3];
+    };
+
+    PyTypeObject FrameType = { PyVarObject_HEAD_INIT(nullptr, 0) };
+
+    FrameView frame_view(FrameObject* frame) {
+        FrameView view;
+        view.data = frame->buffer->data;
+        view.width = frame->width;
+        view.height = frame->height;
+        view.stride = static_cast<size_t>(frame->stride);
+        return view;
+    }
+
+    bool check_live(FrameObject* frame) {
+        if (!frame->buffer) {
+            PyErr_SetString(PyExc_ValueError, "Frame already released");
+            return false;
+        }
+        return true;
+    }
+
+    void release_buffer(FrameObject* frame) {
+        if (frame->buffer) {
+            FramePool::instance().release(frame->buffer);
+            frame->buffer = nullptr;
+        }
+    }
+
+    void Frame_dealloc(FrameObject* self) {
+        release_buffer(self);
+        Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+    }
+
+    PyObject* Frame_release(FrameObject* self, PyObject*) {
+        if (self->exports > 0) {
+            PyErr_SetString(PyExc_BufferError, "Frame has active buffer exports");
+            return nullptr;
+        }
+        release_buffer(self);
+        Py_RETURN_NONE;
+    }
+
+    PyObject* Frame_enter(FrameObject* self, PyObject*) {
+        Py_INCREF(self);
+        return reinterpret_cast<PyObject*>(self);
+    }
+
+    PyObject* Frame_exit(FrameObject* self, PyObject*) {
+        // Views still alive (e.g. a mapped Pillow image) keep the buffer until dealloc
+        if (self->exports == 0) {
+            release_buffer(self);
+        }
+        Py_RETURN_FALSE;
+    }
+
+    // Row layouts Frame.load accepts, as Pillow names them
+    enum class LoadMode { RGBX, RGBA, L, LA, P };
+
+    bool parse_load_mode(const char* name, LoadMode& mode, int& bytes_per_pixel) {
+        static const struct { const char* name; LoadMode mode; int bpp; } MODES[] = {
+            {"RGBX", LoadMode::RGBX, 4}, {"RGBA", LoadMode::RGBA, 4},
+            {"L", LoadMode::L, 1}, {"LA", LoadMode::LA, 2}, {"P", LoadMode::P, 1},
+        };
+        for (const auto& m : MODES) {
+            if (strcmp(name, m.name) == 0) {
+                mode = m.mode;
+                bytes_per_pixel = m.bpp;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Copy packed rows into the frame starting at row y, converting to
+     * RGBX on the way: RGBA and LA are flattened onto white, L is
+     * replicated, P is looked up in `palette` (packed RGB, as getpalette()).
+     * Loading in bands keeps the caller's temporaries small.
+     */
+    PyObject* Frame_load(FrameObject* self, PyObject* args, PyObject* kwargs) {
+        static const char* keywords[] = {"data", "alpha", "mode", "palette", "y", nullptr};
+        PyObject* data = nullptr;
+        int alpha = 0;
+        const char* mode_name = nullptr;
+        PyObject* palette_obj = Py_None;
+        int y0 = 0;
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|pzOi", const_cast<char**>(keywords),
+                                         &data, &alpha, &mode_name, &palette_obj, &y0)) {
+            return nullptr;
+        }
+        if (!check_live(self)) return nullptr;
+
+        LoadMode mode = alpha ? LoadMode::RGBA : LoadMode::RGBX;
+        int bpp = FRAME_CHANNELS;
+        if (mode_name && !parse_load_mode(mode_name, mode, bpp)) {
+            PyErr_Format(PyExc_ValueError, "Unsupported load mode: %s", mode_name);
+            return nullptr;
+        }
+
+        // Palette as RGBX words; unused entries stay black
+        uint32_t palette[256] = {};
+        if (mode == LoadMode::P) {
+            Py_buffer pal;
+            if (palette_obj == Py_None || PyObject_GetBuffer(palette_obj, &pal, PyBUF_SIMPLE) != 0) {
+                if (!PyErr_Occurred()) PyErr_SetString(PyExc_ValueError, "Mode P needs a palette");
+                return nullptr;
+            }
+            const uint8_t* rgb = static_cast<const uint8_t*>(pal.buf);
+            Py_ssize_t entries = std::min<Py_ssize_t>(256, pal.len / 3);
+            for (Py_ssize_t i = 0; i < entries; ++i) {
+                uint8_t px[FRAME_CHANNELS] = {rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2], 0xFF};
+                memcpy(&palette[i], px, FRAME_CHANNELS);
+            }
+            PyBuffer_Release(&pal);
+        }
+
+        Py_buffer src;
+        if (PyObject_GetBuffer(data, &src, PyBUF_SIMPLE) != 0) return nullptr;
+
+        const size_t row_bytes = static_cast<size_t>(self->width) * bpp;
+        const size_t rows = row_bytes ? static_cast<size_t>(src.len) / row_bytes : 0;
+        if (y0 < 0 || rows * row_bytes != static_cast<size_t>(src.len) ||
+            rows > static_cast<size_t>(self->height - y0)) {
+            PyBuffer_Release(&src);
+            PyErr_SetString(PyExc_ValueError, "Data size does not match frame geometry");
+            return nullptr;
+        }
+
+        const uint8_t* in = static_cast<const uint8_t*>(src.buf);
+        FrameView view = frame_view(self);
+
+        Py_BEGIN_ALLOW_THREADS
+        for (size_t i = 0; i < rows; ++i) {
+            const uint8_t* row_in = in + row_bytes * i;
+            uint8_t* out = view.row(y0 + static_cast<int>(i));
+            switch (mode) {
+                case LoadMode::RGBX:
+                    memcpy(out, row_in, row_bytes);
+                    break;
+                case LoadMode::RGBA:
+                    memcpy(out, row_in, row_bytes);
+                    flatten_alpha_row(out, view.width);
+                    break;
+                case LoadMode::L:
+                case LoadMode::LA:
+                    expand_gray_row(row_in, out, view.width, mode == LoadMode::LA);
+                    break;
+                case LoadMode::P:
+                    expand_palette_row(row_in, out, view.width, palette);
+                    break;
+            }
+        }
+        Py_END_ALLOW_THREADS
+
+        PyBuffer_Release(&src);
+        Py_RETURN_NONE;
+    }
+
+    /**
+     * Simple consumers (Pillow's frombuffer) get the padded rows as flat
+     * bytes. Shape-aware ones (memoryview, numpy) get a writable
+     * (height, width, 4) uint8 view with the row stride, still zero-copy.
+     */
+    int Frame_getbuffer(FrameObject* self, Py_buffer* view, int flags) {
+        if (!check_live(self)) {
+            view->obj = nullptr;
+            return -1;
+        }
+
+        if ((flags & PyBUF_ND) != PyBUF_ND) {
+            Py_ssize_t len = self->stride * self->height;
+            if (PyBuffer_FillInfo(view, reinterpret_cast<PyObject*>(self),
+                                  self->buffer->data, len, 0, flags) != 0) {
+                return -1;
+            }
+            self->exports++;
+            return 0;
+        }
+
+        const Py_ssize_t row_bytes = static_cast<Py_ssize_t>(self->width) * FRAME_CHANNELS;
+        const bool padded = self->stride != row_bytes;
+        const bool wants_strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES;
+        const bool wants_f = (flags & PyBUF_F_CONTIGUOUS) == PyBUF_F_CONTIGUOUS;
+        const bool wants_c = (flags & PyBUF_C_CONTIGUOUS) == PyBUF_C_CONTIGUOUS ||
+                             (flags & PyBUF_ANY_CONTIGUOUS) == PyBUF_ANY_CONTIGUOUS;
+        if (wants_f || (padded && (!wants_strides || wants_c))) {
+            PyErr_SetString(PyExc_BufferError, "Frame rows are padded; request a strided buffer");
+            view->obj = nullptr;
+            return -1;
+        }
+
+        self->shape[0] = self->height;
+        self->shape[1] = self->width;
+        self->shape[2] = FRAME_CHANNELS;
+        self->strides[0] = self->stride;
+        self->strides[1] = FRAME_CHANNELS;
+        self->strides[2] = 1;
+
+        view->obj = reinterpret_cast<PyObject*>(self);
+        Py_INCREF(self);
+        view->buf = self->buffer->data;
+        view->len = row_bytes * self->height;
+        view->readonly = 0;
+        view->itemsize = 1;
+        view->format = (flags & PyBUF_FORMAT) ? const_cast<char*>("B") : nullptr;
+        view->ndim = 3;
+        view->shape = self->shape;
+        view->strides = wants_strides ? self->strides : nullptr;
+        view->suboffsets = nullptr;
+        view->internal = nullptr;
+        self->exports++;
+        return 0;
+    }
+
+    void Frame_releasebuffer(FrameObject* self, Py_buffer*) {
+        self->exports--;
+    }
+
+    PyObject* Frame_get_width(FrameObject* self, void*) { return PyLong_FromLong(self->width); }
+    PyObject* Frame_get_height(FrameObject* self, void*) { return PyLong_FromLong(self->height); }
+    PyObject* Frame_get_stride(FrameObject* self, void*) { return PyLong_FromSsize_t(self->stride); }
+
+    PyMethodDef Frame_methods[] = {
+        {"release", reinterpret_cast<PyCFunction>(Frame_release), METH_NOARGS,
+         "Return the buffer to the engine pool."},
+        {"load", reinterpret_cast<PyCFunction>(Frame_load), METH_VARARGS | METH_KEYWORDS,
+         "load(data, alpha=False, mode=None, palette=None, y=0): copy packed rows into the\n"
+         "frame from row y. mode is RGBX (default), RGBA (same as alpha=True), L, LA or P;\n"
+         "alpha is flattened onto white and P needs palette (packed RGB) as they are copied."},
+        {"__enter__", reinterpret_cast<PyCFunction>(Frame_enter), METH_NOARGS, nullptr},
+        {"__exit__", reinterpret_cast<PyCFunction>(Frame_exit), METH_VARARGS, nullptr},
+        {nullptr, nullptr, 0, nullptr}
+    };
+
+    PyGetSetDef Frame_getset[] = {
+        {"width", reinterpret_cast<getter>(Frame_get_width), nullptr, nullptr, nullptr},
+        {"height", reinterpret_cast<getter>(Frame_get_height), nullptr, nullptr, nullptr},
+        {"stride", reinterpret_cast<getter>(Frame_get_stride), nullptr, nullptr, nullptr},
+        {nullptr, nullptr, nullptr, nullptr, nullptr}
+    };
+
+    PyBufferProcs Frame_as_buffer = {
+        reinterpret_cast<getbufferproc>(Frame_getbuffer),
+        reinterpret_cast<releasebufferproc>(Frame_releasebuffer),
+    };
+
+// =============================================================================
+// Module Functions
+// =============================================================================
+
+    FrameObject* wrap_buffer(FrameBuffer* buffer, int width, int height, size_t stride) {
+        FrameObject* frame = PyObject_New(FrameObject, &FrameType);
+        if (!frame) {
+            FramePool::instance().release(buffer);
+            return nullptr;
+        }
+        frame->buffer = buffer;
+        frame->width = width;
+        frame->height = height;
+        frame->stride = static_cast<Py_ssize_t>(stride);
+        frame->exports = 0;
+        return frame;
+    }
+
+    FrameObject* new_frame(int width, int height) {
+        if (width <= 0 || height <= 0) {
+            PyErr_SetString(PyExc_ValueError, "Frame dimensions must be positive");
+            return nullptr;
+        }
+
+        size_t stride = frame_stride(width);
+        FrameBuffer* buffer = FramePool::instance().acquire(stride * static_cast<size_t>(height));
+        if (!buffer) {
+            PyErr_NoMemory();
+            return nullptr;
+        }
+
+        return wrap_buffer(buffer, width, height, stride);
+    }
+
+    PyObject* acquire_frame(PyObject*, PyObject* args) {
+        int width = 0, height = 0;
+        if (!PyArg_ParseTuple(args, "ii", &width, &height)) return nullptr;
+        return reinterpret_cast<PyObject*>(new_frame(width, height));
+    }
+
+    /**
+     * Decode a file straight into a pooled frame.
+     * Returns (frame, info) or None when no native decoder handles it.
+     */
+    PyObject* decode(PyObject*, PyObject* args, PyObject* kwargs) {
+        static const char* keywords[] = {"path", "max_dim", nullptr};
+        const char* path = nullptr;
+        int max_dim = 0;
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|i", const_cast<char**>(keywords),
+                                         &path, &max_dim)) {
+            return nullptr;
+        }
+
+        DecodeOptions options;
+        options.max_dim = max_dim;
+        DecodedImage image;
+        std::string error;
+        DecodeStatus status;
+
+        // A frame decoded ahead by engine_prefetch is taken over as is
+        Py_BEGIN_ALLOW_THREADS
+        if (Prefetcher::instance().adopt_decoded(decode_key(path, max_dim), image)) {
+            status = DecodeStatus::Ok;
+        } else {
+            status = decode_image(path, options, image, error);
+        }
+        Py_END_ALLOW_THREADS
+
+        if (status == DecodeStatus::Unsupported) Py_RETURN_NONE;
+        if (status == DecodeStatus::Error) {
+            PyErr_SetString(PyExc_ValueError, error.c_str());
+            return nullptr;
+        }
+
+        PyObject* frame = reinterpret_cast<PyObject*>(
+            wrap_buffer(image.buffer, image.width, image.height, image.stride));
+        if (!frame) return nullptr;
+
+        return Py_BuildValue("N{s:s,s:s,s:i,s:i,s:i}", frame,
+                             "format", image.format.c_str(),
+                             "mode", image.mode.c_str(),
+                             "width", image.original_width,
+                             "height", image.original_height,
+                             "scale", image.scale_denom);
+    }
+
+    PyObject* enhance(PyObject*, PyObject* args, PyObject* kwargs) {
+        static const char* keywords[] = {"front", "back", "sharpness", "contrast", "src", "mean",
+                                         nullptr};
+        PyObject* front_obj = nullptr;
+        PyObject* back_obj = nullptr;
+        PyObject* src_obj = Py_None;
+        EnhanceParams params;
+
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O!|ffOi", const_cast<char**>(keywords),
+                                         &FrameType, &front_obj, &FrameType, &back_obj,
+                                         &params.sharpness, &params.contrast, &src_obj,
+                                         &params.contrast_mean)) {
+            return nullptr;
+        }
+        if (params.contrast_mean > 255) {
+            PyErr_SetString(PyExc_ValueError, "mean must be at most 255");
+            return nullptr;
+        }
+
+        auto* front = reinterpret_cast<FrameObject*>(front_obj);
+        auto* back = reinterpret_cast<FrameObject*>(back_obj);
+        if (!check_live(front) || !check_live(back)) return nullptr;
+
+        if (front == back || front->width != back->width || front->height != back->height) {
+            PyErr_SetString(PyExc_ValueError, "Frames must be distinct and equally sized");
+            return nullptr;
+        }
+
+        FrameView a = frame_view(front);
+        FrameView b = frame_view(back);
+        FrameView source;
+        if (src_obj != Py_None) {
+            if (!PyObject_TypeCheck(src_obj, &FrameType)) {
+                PyErr_SetString(PyExc_TypeError, "src must be a Frame");
+                return nullptr;
+            }
+            auto* src = reinterpret_cast<FrameObject*>(src_obj);
+            if (!check_live(src)) return nullptr;
+            if (src == front || src == back || src->width != front->width || src->height != front->height) {
+                PyErr_SetString(PyExc_ValueError, "src must be a third frame of the same size");
+                return nullptr;
+            }
+            source = frame_view(src);
+            params.source = &source;
+        }
+        int which = 0;
+
+        // Tile workers report bands through the caller's sink
+        ProgressSink sink = current_progress();
+        if (sink) {
+            params.progress = [](void* ctx, int done, int total) {
+                static_cast<const ProgressSink*>(ctx)->report(ENGINE_STAGE_FILTER, done, total);
+            };
+            params.progress_ctx = &sink;
+        }
+
+        Py_BEGIN_ALLOW_THREADS
+        which = run_enhance_chain(a, b, params);
+        Py_END_ALLOW_THREADS
+
+        // Bands that could not get scratch left stale pooled rows behind
+        if (which < 0) return PyErr_NoMemory();
+
+        PyObject* result = which == 0 ? front_obj : back_obj;
+        Py_INCREF(result);
+        return result;
+    }
+
+    /**
+     * Half-size copy of a frame (2x2 box average) in a new pooled frame.
+     */
+    PyObject* reduce2x(PyObject*, PyObject* arg) {
+        if (!PyObject_TypeCheck(arg, &FrameType)) {
+            PyErr_SetString(PyExc_TypeError, "reduce2x() expects a Frame");
+            return nullptr;
+        }
+        auto* src = reinterpret_cast<FrameObject*>(arg);
+        if (!check_live(src)) return nullptr;
+
+        FrameObject* dst = new_frame((src->width + 1) / 2, (src->height + 1) / 2);
+        if (!dst) return nullptr;
+
+        FrameView from = frame_view(src);
+        FrameView to = frame_view(dst);
+
+        Py_BEGIN_ALLOW_THREADS
+        planter::reduce2x(from, to);
+        Py_END_ALLOW_THREADS
+
+        return reinterpret_cast<PyObject*>(dst);
+    }
+
+    /**
+     * Resampled copy of a frame in a new pooled frame. Large reductions
+     * halve with reduce2x first (exact area average) until Lanczos has
+     * less than 4x left to do.
+     */
+    PyObject* resize(PyObject*, PyObject* args) {
+        PyObject* src_obj = nullptr;
+        int width = 0, height = 0;
+        if (!PyArg_ParseTuple(args, "O!ii", &FrameType, &src_obj, &width, &height)) return nullptr;
+
+        auto* src = reinterpret_cast<FrameObject*>(src_obj);
+        if (!check_live(src)) return nullptr;
+
+        FrameObject* dst = new_frame(width, height);
+        if (!dst) return nullptr;
+
+        // Pre-reduced levels and the horizontal-pass scratch are dropped on return
+        FrameObject* level = src;
+        while (level->width / 2 >= width * 2 && level->height / 2 >= height * 2) {
+            FrameObject* half = new_frame((level->width + 1) / 2, (level->height + 1) / 2);
+            if (!half) {
+                if (level != src) Py_DECREF(reinterpret_cast<PyObject*>(level));
+                Py_DECREF(reinterpret_cast<PyObject*>(dst));
+                return nullptr;
+            }
+
+            FrameView from = frame_view(level);
+            FrameView to = frame_view(half);
+            Py_BEGIN_ALLOW_THREADS
+            planter::reduce2x(from, to);
+            Py_END_ALLOW_THREADS
+
+            if (level != src) Py_DECREF(reinterpret_cast<PyObject*>(level));
+            level = half;
+        }
+
+        FrameObject* tmp = new_frame(width, level->height);
+        if (tmp) {
+            FrameView from = frame_view(level);
+            FrameView mid = frame_view(tmp);
+            FrameView to = frame_view(dst);
+            Py_BEGIN_ALLOW_THREADS
+            resample_lanczos(from, mid, to);
+            Py_END_ALLOW_THREADS
+        }
+
+        if (level != src) Py_DECREF(reinterpret_cast<PyObject*>(level));
+        if (!tmp) {
+            Py_DECREF(reinterpret_cast<PyObject*>(dst));
+            return nullptr;
+        }
+        Py_DECREF(reinterpret_cast<PyObject*>(tmp));
+        return reinterpret_cast<PyObject*>(dst);
+    }
+
+    /**
+     * Run a plug-in filter from src into dst. params maps parameter names
+     * to numbers; missing ones take their defaults.
+     */
+    PyObject* run_op(PyObject*, PyObject* args) {
+        const char* name = nullptr;
+        PyObject* src_obj = nullptr;
+        PyObject* dst_obj = nullptr;
+        PyObject* params = nullptr;
+        if (!PyArg_ParseTuple(args, "sO!O!|O!", &name, &FrameType, &src_obj, &FrameType, &dst_obj,
+                              &PyDict_Type, &params)) {
+            return nullptr;
+        }
+
+        const PlanterFilterDesc* filter = PluginRegistry::instance().find(name);
+        if (!filter) {
+            PyErr_Format(PyExc_ValueError, "Unknown op: %s", name);
+            return nullptr;
+        }
+
+        auto* src = reinterpret_cast<FrameObject*>(src_obj);
+        auto* dst = reinterpret_cast<FrameObject*>(dst_obj);
+        if (!check_live(src) || !check_live(dst)) return nullptr;
+        if (src == dst || src->width != dst->width || src->height != dst->height) {
+            PyErr_SetString(PyExc_ValueError, "Frames must be distinct and equally sized");
+            return nullptr;
+        }
+
+        std::vector<float> values(filter->param_count);
+        Py_ssize_t matched = 0;
+        for (uint32_t i = 0; i < filter->param_count; ++i) {
+            const PlanterParamSpec& spec = filter->params[i];
+            values[i] = spec.default_value;
+            PyObject* value = params ? PyDict_GetItemString(params, spec.name) : nullptr;
+            if (!value) continue;
+
+            ++matched;
+            double v = PyFloat_AsDouble(value);
+            if (v == -1.0 && PyErr_Occurred()) return nullptr;
+            if (!(v >= spec.min_value && v <= spec.max_value)) {
+                char message[256];
+                snprintf(message, sizeof(message), "%s: %s must be within [%g, %g]", name, spec.name,
+                         static_cast<double>(spec.min_value), static_cast<double>(spec.max_value));
+                PyErr_SetString(PyExc_ValueError, message);
+                return nullptr;
+            }
+            values[i] = static_cast<float>(v);
+        }
+        if (params && PyDict_Size(params) != matched) {
+            PyErr_Format(PyExc_ValueError, "%s: unknown parameter", name);
+            return nullptr;
+        }
+
+        FrameView from = frame_view(src);
+        FrameView to = frame_view(dst);
+        std::string error;
+        bool ok;
+
+        Py_BEGIN_ALLOW_THREADS
+        ok = run_plugin_filter(*filter, from, to, values.data(), error);
+        Py_END_ALLOW_THREADS
+
+        if (!ok) {
+            PyErr_SetString(PyExc_RuntimeError, error.c_str());
+            return nullptr;
+        }
+        Py_RETURN_NONE;
+    }
+
+    // {name: {"description", "halo", "params": {name: (default, min, max)}}}
+    PyObject* ops(PyObject*, PyObject*) {
+        PyObject* result = PyDict_New();
+        if (!result) return nullptr;
+
+        for (const PlanterFilterDesc* filter : PluginRegistry::instance().filters()) {
+            PyObject* params = PyDict_New();
+            if (!params) {
+                Py_DECREF(result);
+                return nullptr;
+            }
+            for (uint32_t i = 0; i < filter->param_count; ++i) {
+                const PlanterParamSpec& spec = filter->params[i];
+                PyObject* range = Py_BuildValue("(fff)", spec.default_value, spec.min_value, spec.max_value);
+                if (!range || PyDict_SetItemString(params, spec.name, range) != 0) {
+                    Py_XDECREF(range);
+                    Py_DECREF(params);
+                    Py_DECREF(result);
+                    return nullptr;
+                }
+                Py_DECREF(range);
+            }
+
+            PyObject* info = Py_BuildValue("{s:s,s:i,s:N}",
+                                           "description", filter->description ? filter->description : "",
+                                           "halo", filter->halo,
+                                           "params", params);
+            if (!info || PyDict_SetItemString(result, filter->name, info) != 0) {
+                Py_XDECREF(info);
+                Py_DECREF(result);
+                return nullptr;
+            }
+            Py_DECREF(info);
+        }
+        return result;
+    }
+
+    PyObject* progress(PyObject*, PyObject* args) {
+        int stage = 0;
+        int done = 1;
+        int total = 1;
+        if (!PyArg_ParseTuple(args, "i|ii", &stage, &done, &total)) {
+            return nullptr;
+        }
+        if (stage < 0 || stage >= ENGINE_STAGE_COUNT) {
+            PyErr_SetString(PyExc_ValueError, "Unknown stage");
+            return nullptr;
+        }
+
+        ProgressSink sink = current_progress();
+        if (sink) {
+            // The callback may block briefly; don't hold other threads off
+            Py_BEGIN_ALLOW_THREADS
+            sink.report(stage, done, total);
+            Py_END_ALLOW_THREADS
+        }
+        if (sink.cancelled()) {
+            PyErr_SetString(PyExc_RuntimeError, "Cancelled");
+            return nullptr;
+        }
+        Py_RETURN_NONE;
+    }
+
+    constexpr const char* CALL_CAPSULE = "planter_native.call";
+
+    /**
+     * The engine call running on this thread, for handing to run_in_call()
+     * on another thread. Only valid while that call is in flight.
+     */
+    PyObject* current_call(PyObject*, PyObject*) {
+        auto* sink = new ProgressSink(current_progress());
+        PyObject* capsule = PyCapsule_New(sink, CALL_CAPSULE, [](PyObject* obj) {
+            delete static_cast<ProgressSink*>(PyCapsule_GetPointer(obj, CALL_CAPSULE));
+        });
+        if (!capsule) delete sink;
+        return capsule;
+    }
+
+    // fn(*args) with the captured call's progress sink (and cancel flag) installed
+    PyObject* run_in_call(PyObject*, PyObject* args) {
+        Py_ssize_t count = PyTuple_GET_SIZE(args);
+        if (count < 2) {
+            PyErr_SetString(PyExc_TypeError, "run_in_call(call, fn, *args)");
+            return nullptr;
+        }
+        auto* sink = static_cast<ProgressSink*>(
+                PyCapsule_GetPointer(PyTuple_GET_ITEM(args, 0), CALL_CAPSULE));
+        if (!sink) return nullptr;
+        if (sink->cancelled()) {
+            PyErr_SetString(PyExc_RuntimeError, "Cancelled");
+            return nullptr;
+        }
+
+        PyObject* fn_args = PyTuple_GetSlice(args, 2, count);
+        if (!fn_args) return nullptr;
+        ProgressScope scope(*sink);
+        PyObject* result = PyObject_Call(PyTuple_GET_ITEM(args, 1), fn_args, nullptr);
+        Py_DECREF(fn_args);
+        return result;
+    }
+
+    PyObject* cancelled(PyObject*, PyObject*) {
+        return PyBool_FromLong(current_progress().cancelled());
+    }
+
+    PyObject* pool_stats(PyObject*, PyObject*) {
+        FramePoolStats s = FramePool::instance().stats();
+        return Py_BuildValue("{s:K,s:K,s:K,s:K,s:K,s:K,s:K,s:K}",
+                             "acquires", static_cast<unsigned long long>(s.acquires),
+                             "hits", static_cast<unsigned long long>(s.hits),
+                             "misses", static_cast<unsigned long long>(s.misses),
+                             "bytes_live", static_cast<unsigned long long>(s.bytes_live),
+                             "bytes_idle", static_cast<unsigned long long>(s.bytes_idle),
+                             "buffers_idle", static_cast<unsigned long long>(s.buffers_idle),
+                             "huge_page_bytes", static_cast<unsigned long long>(s.huge_page_bytes),
+                             "hugetlb_bytes", static_cast<unsigned long long>(s.hugetlb_bytes));
+    }
+
+    PyMethodDef module_methods[] = {
+        {"acquire_frame", acquire_frame, METH_VARARGS,
+         "acquire_frame(width, height) -> Frame from the engine pool."},
+        {"decode", reinterpret_cast<PyCFunction>(decode), METH_VARARGS | METH_KEYWORDS,
+         "decode(path, max_dim=0) -> (Frame, info) or None if no native decoder applies."},
+        {"enhance", reinterpret_cast<PyCFunction>(enhance), METH_VARARGS | METH_KEYWORDS,
+         "enhance(front, back, sharpness=1.5, contrast=1.2, src=None, mean=-1) -> frame holding the result.\n"
+         "With src, the chain reads src (left untouched) and front is scratch.\n"
+         "mean >= 0 sets the luma contrast is relative to (default: the frame's own)."},
+        {"reduce2x", reduce2x, METH_O,
+         "reduce2x(frame) -> new half-size Frame (2x2 box average)."},
+        {"resize", resize, METH_VARARGS,
+         "resize(frame, width, height) -> new Frame (area + Lanczos-3 resample)."},
+        {"run_op", run_op, METH_VARARGS,
+         "run_op(name, src, dst, params=None) -> run a native plug-in filter from src into dst."},
+        {"ops", ops, METH_NOARGS, "Plug-in filters loaded from the engine's plugin_dir."},
+        {"progress", progress, METH_VARARGS,
+         "progress(stage, done=1, total=1) -> report progress of the current engine call.\n"
+         "Raises RuntimeError if the call has been cancelled."},
+        {"current_call", current_call, METH_NOARGS,
+         "current_call() -> handle of the engine call on this thread, for run_in_call()."},
+        {"run_in_call", run_in_call, METH_VARARGS,
+         "run_in_call(call, fn, *args) -> fn(*args) reporting progress to that call.\n"
+         "Raises RuntimeError if the call has been cancelled."},
+        {"cancelled", cancelled, METH_NOARGS,
+         "cancelled() -> True if the current engine call has been cancelled."},
+        {"pool_stats", pool_stats, METH_NOARGS, "Frame pool counters."},
+        {nullptr, nullptr, 0, nullptr}
+    };
+
+    PyModuleDef module_def = {
+        PyModuleDef_HEAD_INIT,
+        "planter_native",
+        "Planter Pressure native frame buffers and stage kernels.",
+        -1,
+        module_methods,
+    };
+
+    PyObject* init_module() {
+        FrameType.tp_name = "planter_native.Frame";
+        FrameType.tp_basicsize = sizeof(FrameObject);
+        FrameType.tp_flags = Py_TPFLAGS_DEFAULT;
+        FrameType.tp_doc = "Pooled RGBX frame buffer owned by the engine.";
+        FrameType.tp_dealloc = reinterpret_cast<destructor>(Frame_dealloc);
+        FrameType.tp_methods = Frame_methods;
+        FrameType.tp_getset = Frame_getset;
+        FrameType.tp_as_buffer = &Frame_as_buffer;
+
+        if (PyType_Ready(&FrameType) < 0) return nullptr;
+
+        PyObject* module = PyModule_Create(&module_def);
+        if (!module) return nullptr;
+
+        Py_INCREF(&FrameType);
+        if (PyModule_AddObject(module, "Frame", reinterpret_cast<PyObject*>(&FrameType)) < 0) {
+            Py_DECREF(&FrameType);
+            Py_DECREF(module);
+            return nullptr;
+        }
+        PyModule_AddIntConstant(module, "CHANNELS", FRAME_CHANNELS);
+        PyModule_AddIntConstant(module, "STAGE_DECODE", ENGINE_STAGE_DECODE);
+        PyModule_AddIntConstant(module, "STAGE_FILTER", ENGINE_STAGE_FILTER);
+        PyModule_AddIntConstant(module, "STAGE_OVERLAY", ENGINE_STAGE_OVERLAY);
+        PyModule_AddIntConstant(module, "STAGE_ENCODE", ENGINE_STAGE_ENCODE);
+        return module;
+    }
+
+} // anonymous namespace
+
+int register_native_module() {
+    return PyImport_AppendInittab("planter_native", &init_module);
+}
+
+FrameBuffer* detach_frame(PyObject* obj, int* width, int* height, size_t* stride) {
+    if (!PyObject_TypeCheck(obj, &FrameType)) {
+        PyErr_SetString(PyExc_TypeError, "Expected a planter_native.Frame");
+        return nullptr;
+    }
+
+    auto* frame = reinterpret_cast<FrameObject*>(obj);
+    if (!check_live(frame)) return nullptr;
+    if (frame->exports > 0) {
+        PyErr_SetString(PyExc_BufferError, "Frame has active buffer exports");
+        return nullptr;
+    }
+
+    FrameBuffer* buffer = frame->buffer;
+    frame->buffer = nullptr;
+    *width = frame->width;
+    *height = frame->height;
+    *stride = static_cast<size_t>(frame->stride);
+    return buffer;
+}
+
+} // namespace planter
@@ -0,0 +1,39 @@
+/**
+ * @file native_module.h
+ * @brief Planter Pressure - Built-in `planter_native` Python Module
+ *
+ * Exposes pooled frame buffers and native stage kernels to process.py.
+ */
+
+#ifndef PLANTER_PRESSURE_NATIVE_MODULE_H
+#define PLANTER_PRESSURE_NATIVE_MODULE_H
+
+#include <cstddef>
+
+typedef struct _object PyObject;
+
+namespace planter {
+
+struct FrameBuffer;
+
+/**
+ * Register `planter_native` as a built-in module.
+ * MUST be called before the interpreter is initialized.
+ *
+ * @return 0 on success, non-zero on failure
+ */
+int register_native_module();
+
+/**
+ * Take ownership of a `planter_native.Frame`'s pooled buffer, leaving the
+ * Frame released. The caller returns the buffer with FramePool::release().
+ * Requires the GIL.
+ *
+ * @return nullptr with a Python error set if obj is not a live frame
+ *         or still has buffer exports
+ */
+FrameBuffer* detach_frame(PyObject* obj, int* width, int* height, size_t* stride);
+
+} // namespace planter
+
+#endif
@@ -0,0 +1,96 @@
+/**
+ * @file planter_plugin.h
+ * @brief Planter Pressure - Native Filter Plug-in ABI
+ *
+ * Plain C, no engine headers needed. A plug-in is a shared library in the
+ * engine's plugin_dir exporting planter_plugin_filters():
+ *
+ *   static const PlanterParamSpec params[] = {{"strength", 0.5f, 0.0f, 1.0f}};
+ *   static int32_t denoise_tile(const PlanterTile* tile, const float* values) { ... }
+ *   static const PlanterFilterDesc filters[] = {{
+ *       PLANTER_PLUGIN_ABI_VERSION, "denoise", "Pressure-plate denoiser",
+ *       1, params, 1, denoise_tile}};
+ *
+ *   PLANTER_PLUGIN_EXPORT const PlanterFilterDesc* planter_plugin_filters(uint32_t* count) {
+ *       *count = 1;
+ *       return filters;
+ *   }
+ *
+ * Requests then name filters in "ops": [{"op": "denoise", "strength": 0.8}].
+ *
+ * OPTIMIZATIONS:
+ * - Tiles run on the engine's tile pool, like the built-in kernels
+ * - Frames are passed as pointers into pooled memory (no copies, no Python)
+ */
+
+#ifndef PLANTER_PRESSURE_PLUGIN_H
+#define PLANTER_PRESSURE_PLUGIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PLANTER_PLUGIN_ABI_VERSION 1
+#define PLANTER_PLUGIN_ENTRY "planter_plugin_filters"
+
+#ifdef _WIN32
+#define PLANTER_PLUGIN_EXPORT_ATTR __declspec(dllexport)
+#else
+#define PLANTER_PLUGIN_EXPORT_ATTR __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+#define PLANTER_PLUGIN_EXPORT extern "C" PLANTER_PLUGIN_EXPORT_ATTR
+extern "C" {
+#else
+#define PLANTER_PLUGIN_EXPORT PLANTER_PLUGIN_EXPORT_ATTR
+#endif
+
+/**
+ * One band of rows to produce. Pixels are RGBX (4 bytes, X = 255).
+ * `src` is the whole input frame, so reads up to `halo` rows/columns
+ * outside the band are valid within the frame; clamp at its edges.
+ * Write only rows [y0, y1) of `dst`. Bands run concurrently.
+ */
+typedef struct PlanterTile {
+    const uint8_t* src;
+    size_t src_stride;
+    uint8_t* dst;
+    size_t dst_stride;
+    int32_t width;
+    int32_t height;
+    int32_t y0;
+    int32_t y1;
+} PlanterTile;
+
+/* A float parameter; requests outside [min_value, max_value] are rejected */
+typedef struct PlanterParamSpec {
+    const char* name;
+    float default_value;
+    float min_value;
+    float max_value;
+} PlanterParamSpec;
+
+/**
+ * Process one tile. `values` holds one entry per PlanterParamSpec, in
+ * declaration order. Return 0 on success; anything else fails the request.
+ */
+typedef int32_t (*PlanterProcessTileFn)(const PlanterTile* tile, const float* values);
+
+typedef struct PlanterFilterDesc {
+    uint32_t abi_version;        /* PLANTER_PLUGIN_ABI_VERSION */
+    const char* name;            /* op name used in requests; [A-Za-z0-9_-] */
+    const char* description;
+    int32_t halo;                /* pixels read beyond the output on each side */
+    const PlanterParamSpec* params;
+    uint32_t param_count;
+    PlanterProcessTileFn process_tile;
+} PlanterFilterDesc;
+
+/* Exported as PLANTER_PLUGIN_ENTRY; descriptors must stay valid while loaded */
+typedef const PlanterFilterDesc* (*PlanterPluginFiltersFn)(uint32_t* count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
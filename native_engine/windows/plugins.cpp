@@ -0,0 +1,238 @@
+/**
+ * @file plugins.cpp
+ * @brief Planter Pressure - Native Filter Plug-in Registry
+ */
+
+#include "plugins.h"
+#include "kernels.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace planter {
+
+namespace {
+
+    // Same band height as the built-in kernels
+    constexpr int ROW_GRAIN = 32;
+
+#ifdef _WIN32
+    const char* const LIBRARY_EXTENSIONS[] = {".dll"};
+#else
+    const char* const LIBRARY_EXTENSIONS[] = {".so", ".dylib"};
+#endif
+
+    bool is_library(const std::filesystem::path& path) {
+        const std::string ext = path.extension().string();
+        for (const char* candidate : LIBRARY_EXTENSIONS) {
+            if (ext == candidate) return true;
+        }
+        return false;
+    }
+
+    void* open_library(const std::filesystem::path& path, std::string& error) {
+#ifdef _WIN32
+        HMODULE handle = LoadLibraryW(path.wstring().c_str());
+        if (!handle) error = "LoadLibrary failed (" + std::to_string(GetLastError()) + ")";
+        return reinterpret_cast<void*>(handle);
+#else
+        void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!handle) error = dlerror();
+        return handle;
+#endif
+    }
+
+    void* find_symbol(void* handle, const char* name) {
+#ifdef _WIN32
+        return reinterpret_cast<void*>(GetProcAddress(reinterpret_cast<HMODULE>(handle), name));
+#else
+        return dlsym(handle, name);
+#endif
+    }
+
+    void close_library(void* handle) {
+#ifdef _WIN32
+        FreeLibrary(reinterpret_cast<HMODULE>(handle));
+#else
+        dlclose(handle);
+#endif
+    }
+
+    bool valid_name(const char* name) {
+        if (!name || !name[0]) return false;
+        for (const char* c = name; *c; ++c) {
+            if (!std::isalnum(static_cast<unsigned char>(*c)) && *c != '_' && *c != '-') return false;
+        }
+        return true;
+    }
+
+    bool validate(const PlanterFilterDesc& desc, std::string& error) {
+        if (desc.abi_version != PLANTER_PLUGIN_ABI_VERSION) {
+            error = "ABI version " + std::to_string(desc.abi_version) + ", engine expects " +
+                    std::to_string(PLANTER_PLUGIN_ABI_VERSION);
+            return false;
+        }
+        if (!valid_name(desc.name)) {
+            error = "invalid filter name";
+            return false;
+        }
+        if (!desc.process_tile || desc.halo < 0 || (desc.param_count && !desc.params)) {
+            error = std::string("filter '") + desc.name + "' has an incomplete descriptor";
+            return false;
+        }
+        for (uint32_t i = 0; i < desc.param_count; ++i) {
+            const PlanterParamSpec& spec = desc.params[i];
+            if (!valid_name(spec.name) || strcmp(spec.name, "op") == 0 ||
+                !(spec.min_value <= spec.default_value && spec.default_value <= spec.max_value)) {
+                error = std::string("filter '") + desc.name + "' has an invalid parameter spec";
+                return false;
+            }
+        }
+        return true;
+    }
+
+} // anonymous namespace
+
+// =============================================================================
+// Registry
+// =============================================================================
+
+PluginRegistry& PluginRegistry::instance() {
+    static PluginRegistry registry;
+    return registry;
+}
+
+PluginRegistry::~PluginRegistry() {
+    unload();
+}
+
+bool PluginRegistry::load_directory(const std::string& directory, std::string& error) {
+    std::error_code ec;
+    std::vector<std::filesystem::path> libraries;
+    for (const auto& entry : std::filesystem::directory_iterator(std::filesystem::u8path(directory), ec)) {
+        if (entry.is_regular_file(ec) && is_library(entry.path())) {
+            libraries.push_back(entry.path());
+        }
+    }
+    if (ec) {
+        error = "Cannot read plug-in directory " + directory + ": " + ec.message();
+        return false;
+    }
+    std::sort(libraries.begin(), libraries.end());
+
+    for (const auto& path : libraries) {
+        std::string reason;
+        if (!load_library(path, reason)) {
+            error = path.filename().string() + ": " + reason;
+            unload();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PluginRegistry::load_library(const std::filesystem::path& path, std::string& error) {
+    void* handle = open_library(path, error);
+    if (!handle) return false;
+
+    auto entry = reinterpret_cast<PlanterPluginFiltersFn>(find_symbol(handle, PLANTER_PLUGIN_ENTRY));
+    if (!entry) {
+        close_library(handle);
+        error = std::string("missing ") + PLANTER_PLUGIN_ENTRY;
+        return false;
+    }
+
+    uint32_t count = 0;
+    const PlanterFilterDesc* descs = entry(&count);
+    if (count && !descs) {
+        close_library(handle);
+        error = "no filter descriptors";
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!validate(descs[i], error)) {
+            close_library(handle);
+            return false;
+        }
+        bool duplicate = find(descs[i].name) != nullptr;
+        for (uint32_t j = 0; j < i; ++j) {
+            duplicate = duplicate || strcmp(descs[i].name, descs[j].name) == 0;
+        }
+        if (duplicate) {
+            // descs lives in the library; format before closing it
+            error = std::string("filter '") + descs[i].name + "' is already registered";
+            close_library(handle);
+            return false;
+        }
+    }
+
+    handles_.push_back(handle);
+    for (uint32_t i = 0; i < count; ++i) {
+        filters_.push_back(&descs[i]);
+    }
+    return true;
+}
+
+const PlanterFilterDesc* PluginRegistry::find(const std::string& name) const {
+    for (const PlanterFilterDesc* desc : filters_) {
+        if (name == desc->name) return desc;
+    }
+    return nullptr;
+}
+
+void PluginRegistry::unload() {
+    filters_.clear();
+    for (auto it = handles_.rbegin(); it != handles_.rend(); ++it) {
+        close_library(*it);
+    }
+    handles_.clear();
+}
+
+// =============================================================================
+// Execution
+// =============================================================================
+
+bool run_plugin_filter(const PlanterFilterDesc& filter, const FrameView& src,
+                       const FrameView& dst, const float* values, std::string& error) {
+    std::atomic<int32_t> failure{0};
+
+    TilePool::instance().parallel_for(0, src.height, ROW_GRAIN, [&](int y0, int y1) {
+        if (failure.load(std::memory_order_relaxed) != 0) return;
+
+        PlanterTile tile;
+        tile.src = src.data;
+        tile.src_stride = src.stride;
+        tile.dst = dst.data;
+        tile.dst_stride = dst.stride;
+        tile.width = src.width;
+        tile.height = src.height;
+        tile.y0 = y0;
+        tile.y1 = y1;
+
+        int32_t status = filter.process_tile(&tile, values);
+        if (status != 0) {
+            int32_t expected = 0;
+            failure.compare_exchange_strong(expected, status);
+        }
+    });
+
+    int32_t status = failure.load();
+    if (status != 0) {
+        error = std::string("Filter '") + filter.name + "' failed with status " + std::to_string(status);
+        return false;
+    }
+    return true;
+}
+
+} // namespace planter
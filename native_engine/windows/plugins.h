@@ -0,0 +1,67 @@
+/**
+ * @file plugins.h
+ * @brief Planter Pressure - Native Filter Plug-in Registry
+ *
+ * OPTIMIZATIONS:
+ * - Libraries are opened once at init; lookups afterwards are lock-free reads
+ * - Plug-in tiles run on the shared tile pool in ROW_GRAIN bands
+ */
+
+#ifndef PLANTER_PRESSURE_PLUGINS_H
+#define PLANTER_PRESSURE_PLUGINS_H
+
+#include "planter_plugin.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace planter {
+
+struct FrameView;
+
+/**
+ * Filters exported by the plug-ins in the engine's plugin_dir.
+ * Populated by engine_init_ex, read-only until engine_shutdown unloads it.
+ */
+class PluginRegistry {
+public:
+    static PluginRegistry& instance();
+
+    /**
+     * Open every shared library (.dll / .so / .dylib) in `directory`, in
+     * name order, and register its filters. On the first invalid library
+     * or duplicate filter name, everything is unloaded and false returned.
+     */
+    bool load_directory(const std::string& directory, std::string& error);
+
+    // nullptr if no plug-in registered `name`
+    const PlanterFilterDesc* find(const std::string& name) const;
+
+    const std::vector<const PlanterFilterDesc*>& filters() const { return filters_; }
+
+    void unload();
+
+private:
+    PluginRegistry() = default;
+    ~PluginRegistry();
+    PluginRegistry(const PluginRegistry&) = delete;
+    PluginRegistry& operator=(const PluginRegistry&) = delete;
+
+    bool load_library(const std::filesystem::path& path, std::string& error);
+
+    std::vector<void*> handles_;
+    std::vector<const PlanterFilterDesc*> filters_;
+};
+
+/**
+ * Run `filter` from src into dst (same geometry) on the tile pool.
+ * `values` has one entry per parameter spec.
+ * @return false with `error` set if any tile reported failure
+ */
+bool run_plugin_filter(const PlanterFilterDesc& filter, const FrameView& src,
+                       const FrameView& dst, const float* values, std::string& error);
+
+} // namespace planter
+
+#endif
@@ -0,0 +1,313 @@
+/**
+ * @file prefetch.cpp
+ * @brief Planter Pressure - Speculative Prefetch at Idle Priority
+ */
+
+#include "prefetch.h"
+#include "frame_pool.h"
+#include "singleflight.h"
+
+#include <filesystem>
+#include <system_error>
+
+namespace planter {
+
+namespace {
+
+    // Hints go stale fast (the pointer moved on); keep only the latest few
+    constexpr size_t MAX_QUEUED = 8;
+
+    // Stashed results hold pooled frames; bound what idle work may pin
+    constexpr size_t MAX_STASHED = 4;
+
+    // Hidden, so file browsers watching the output directory skip it
+    const char STAGING_PREFIX[] = ".planter-prefetch-";
+
+    void erase_all(std::string& text, const std::string& needle) {
+        for (size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at)) {
+            text.erase(at, needle.size());
+        }
+    }
+
+} // anonymous namespace
+
+std::string prefetch_staging_dir(const std::string& output_dir, uint64_t id) {
+    std::string dir = output_dir;
+    if (dir.empty()) {
+        // Where Python puts outputs without an output_dir
+        std::error_code ec;
+        dir = std::filesystem::temp_directory_path(ec).u8string();
+    }
+    char last = dir.empty() ? '\0' : dir.back();
+    if (last != '/' && last != '\\') {
+        dir += dir.find('\\') != std::string::npos && dir.find('/') == std::string::npos ? '\\' : '/';
+    }
+    return dir + STAGING_PREFIX + std::to_string(id);
+}
+
+std::string decode_key(const std::string& path, int max_dim) {
+    std::string identity = input_identity(path);
+    if (identity.empty()) return identity;
+    return "decode|" + std::to_string(max_dim) + "|" + identity;
+}
+
+Prefetcher& Prefetcher::instance() {
+    static Prefetcher prefetcher;
+    return prefetcher;
+}
+
+void Prefetcher::configure(Executor executor, IdleWait wait_idle) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    executor_ = std::move(executor);
+    wait_idle_ = std::move(wait_idle);
+}
+
+uint64_t Prefetcher::submit(std::shared_ptr<PrefetchTask> task) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!executor_ || stopping_) return 0;
+
+    // Repeated hints (hover jitter) attach to the work already planned
+    if (running_ && running_->key == task->key && !running_->cancelled) return running_->id;
+    for (const auto& queued : queue_) {
+        if (queued->key == task->key) return queued->id;
+    }
+    for (const auto& stashed : stash_) {
+        if (stashed.key == task->key) return stashed.id;
+    }
+
+    task->id = next_id_++;
+    if (queue_.size() >= MAX_QUEUED) {
+        queue_.pop_front();
+        ++stats_.cancelled;
+    }
+    queue_.push_back(std::move(task));
+    ++stats_.submitted;
+
+    if (!worker_.joinable()) {
+        worker_ = std::thread(&Prefetcher::worker_loop, this);
+    }
+    wake_.notify_one();
+    return queue_.back()->id;
+}
+
+bool Prefetcher::cancel(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = queue_.begin(); it != queue_.end(); ++it) {
+        if ((*it)->id == id) {
+            queue_.erase(it);
+            ++stats_.cancelled;
+            return true;
+        }
+    }
+    for (auto it = stash_.begin(); it != stash_.end(); ++it) {
+        if (it->id == id) {
+            release(it->result);
+            stash_.erase(it);
+            ++stats_.cancelled;
+            return true;
+        }
+    }
+    // A task a real request is waiting on is no longer speculative
+    if (running_ && running_->id == id && !running_->claimed) {
+        running_->cancelled = true;
+        return true;
+    }
+    return false;
+}
+
+bool Prefetcher::adopt_result(const std::string& key, std::string& json) {
+    if (key.empty()) return false;
+    std::unique_lock<std::mutex> lock(mutex_);
+    PrefetchResult result;
+    if (!adopt_locked(lock, key, false, result)) return false;
+    lock.unlock();
+
+    // A stashed result is ours alone now; a claimed one was published already
+    publish(result);
+    json = std::move(result.json);
+    return true;
+}
+
+bool Prefetcher::adopt_decoded(const std::string& key, DecodedImage& image) {
+    if (key.empty()) return false;
+    std::unique_lock<std::mutex> lock(mutex_);
+    PrefetchResult result;
+    if (!adopt_locked(lock, key, true, result)) return false;
+    image = std::move(result.image);
+    return true;
+}
+
+bool Prefetcher::adopt_locked(std::unique_lock<std::mutex>& lock, const std::string& key,
+                              bool take_frame, PrefetchResult& result) {
+    for (auto it = stash_.begin(); it != stash_.end(); ++it) {
+        if (it->key == key) {
+            result = std::move(it->result);
+            stash_.erase(it);
+            ++stats_.hits;
+            return true;
+        }
+    }
+
+    // Queued hints for this key would only repeat the caller's own work
+    for (auto it = queue_.begin(); it != queue_.end();) {
+        if ((*it)->key == key) {
+            it = queue_.erase(it);
+            ++stats_.cancelled;
+        } else {
+            ++it;
+        }
+    }
+
+    if (!running_ || running_->key != key || running_->cancelled) return false;
+
+    std::shared_ptr<PrefetchTask> task = running_;
+    task->claimed = true;
+    finished_.wait(lock, [&] { return task->done; });
+    if (!task->ok) return false;
+
+    if (take_frame) {
+        // One frame, one owner; later adopters decode for themselves
+        if (!task->result.image.buffer) return false;
+        result.image = task->result.image;
+        task->result.image.buffer = nullptr;
+    } else {
+        result.json = task->result.json;
+    }
+    ++stats_.hits;
+    return true;
+}
+
+void Prefetcher::stash_locked(const PrefetchTask& task, PrefetchResult&& result) {
+    if (stash_.size() >= MAX_STASHED) {
+        release(stash_.front().result);
+        stash_.pop_front();
+        ++stats_.cancelled;
+    }
+    stash_.push_back({task.id, task.key, std::move(result)});
+}
+
+void Prefetcher::publish(PrefetchResult& result) {
+    if (result.staging_dir.empty()) return;
+    namespace fs = std::filesystem;
+
+    std::error_code ec;
+    const fs::path staging = fs::u8path(result.staging_dir);
+    const fs::path target = staging.parent_path();
+    bool moved = true;
+    for (const auto& entry : fs::directory_iterator(staging, ec)) {
+        std::error_code move_ec;
+        fs::rename(entry.path(), target / entry.path().filename(), move_ec);
+        if (move_ec) moved = false;
+    }
+    if (ec || !moved) {
+        // Leave everything where the result says it is
+        result.staging_dir.clear();
+        return;
+    }
+    fs::remove(staging, ec);
+
+    // Python wrote "<staging>/<name>": dropping "/<staging name>" gives
+    // the path it would have written without staging ('\' escaped in JSON)
+    const std::string name = staging.filename().u8string();
+    erase_all(result.json, "/" + name);
+    erase_all(result.json, "\\\\" + name);
+    result.staging_dir.clear();
+}
+
+void Prefetcher::release(PrefetchResult& result) {
+    if (result.image.buffer) {
+        FramePool::instance().release(result.image.buffer);
+        result.image.buffer = nullptr;
+    }
+    if (!result.staging_dir.empty()) {
+        std::error_code ec;
+        std::filesystem::remove_all(std::filesystem::u8path(result.staging_dir), ec);
+        result.staging_dir.clear();
+    }
+}
+
+void Prefetcher::worker_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (stopping_) return;
+
+        // Wait for idle before taking a task: a running task may be adopted,
+        // and its adopter (a call in flight) must not wait on idleness itself
+        IdleWait wait_idle = wait_idle_;
+        lock.unlock();
+        bool idle = wait_idle();
+        lock.lock();
+        if (!idle) {
+            wake_.wait(lock, [this] { return stopping_; });
+            return;
+        }
+        if (stopping_) return;
+        if (queue_.empty()) continue;
+
+        // Newest hint first: it is what the user is looking at now
+        std::shared_ptr<PrefetchTask> task = queue_.back();
+        queue_.pop_back();
+        running_ = task;
+        Executor executor = executor_;
+        lock.unlock();
+
+        PrefetchResult result;
+        bool ok = executor(*task, result);
+
+        lock.lock();
+        running_.reset();
+        task->ok = ok && !task->cancelled;
+        if (task->ok && task->claimed) {
+            // No new claims once running_ is reset; move outputs before waking adopters
+            lock.unlock();
+            publish(result);
+            lock.lock();
+        }
+        if (task->ok) {
+            ++stats_.completed;
+            if (task->claimed) {
+                task->result = std::move(result);
+            } else {
+                stash_locked(*task, std::move(result));
+            }
+        } else {
+            if (task->cancelled) ++stats_.cancelled;
+            release(result);
+        }
+        task->done = true;
+        finished_.notify_all();
+    }
+}
+
+PrefetchStats Prefetcher::stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void Prefetcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        stats_.cancelled += queue_.size();
+        queue_.clear();
+        if (running_ && !running_->claimed) running_->cancelled = true;
+    }
+    wake_.notify_all();
+}
+
+void Prefetcher::shutdown() {
+    stop();
+    if (worker_.joinable()) worker_.join();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& stashed : stash_) {
+        release(stashed.result);
+    }
+    stash_.clear();
+    executor_ = nullptr;
+    wait_idle_ = nullptr;
+    stopping_ = false;
+}
+
+} // namespace planter
@@ -0,0 +1,143 @@
+/**
+ * @file prefetch.h
+ * @brief Planter Pressure - Speculative Prefetch at Idle Priority
+ *
+ * OPTIMIZATIONS:
+ * - Hinted inputs are decoded (or fully processed) while the engine is
+ *   idle, so the real request starts from a pooled frame or a finished result
+ * - A real request arriving mid-prefetch waits for that work instead of
+ *   repeating it; queued hints for the same work are dropped
+ * - Stale hints stay cheap: the queue is short and sheds its oldest entry,
+ *   and cancel() stops a running pipeline at its next stage boundary
+ * - Speculative outputs are staged out of sight and only moved into the
+ *   output directory when a real request adopts them
+ */
+
+#ifndef PLANTER_PRESSURE_PREFETCH_H
+#define PLANTER_PRESSURE_PREFETCH_H
+
+#include "decoder.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace planter {
+
+// What a prefetch produced: a decoded frame, or a request's result JSON
+struct PrefetchResult {
+    DecodedImage image;
+    std::string json;
+    // Speculative outputs are written here, beside the request's output_dir,
+    // and moved into it only when adopted; deleted with an unused result
+    std::string staging_dir;
+};
+
+struct PrefetchTask {
+    uint64_t id = 0;
+    std::string path;
+    std::string key;            // decode_key() or the request's coalescing key
+    std::string request_json;   // request to run speculatively; empty = decode only
+    int max_dim = 0;            // decode only: preview size the request will ask for
+    std::atomic<bool> cancelled{false};
+
+    // Guarded by the Prefetcher's mutex
+    bool claimed = false;       // a real request is waiting on this task
+    bool done = false;
+    bool ok = false;
+    PrefetchResult result;
+};
+
+struct PrefetchStats {
+    uint64_t submitted = 0;
+    uint64_t completed = 0;     // finished with a usable result
+    uint64_t cancelled = 0;     // cancelled, dropped from the queue, or evicted unused
+    uint64_t hits = 0;          // real requests served from prefetched work
+};
+
+// Key under which a decode of `path` for `max_dim` is stashed; empty if unstat-able
+std::string decode_key(const std::string& path, int max_dim);
+
+// Staging directory for task `id` inside `output_dir` (empty = temp directory)
+std::string prefetch_staging_dir(const std::string& output_dir, uint64_t id);
+
+/**
+ * One idle-priority worker plus a small stash of finished work. Real
+ * requests adopt() by key: a stashed result is taken (once), a running
+ * task is waited for, and queued tasks for the key are dropped.
+ */
+class Prefetcher {
+public:
+    // Runs one task on the prefetch thread; false if it produced nothing usable
+    using Executor = std::function<bool(PrefetchTask& task, PrefetchResult& result)>;
+
+    // Blocks until the engine is idle; false once it is shutting down
+    using IdleWait = std::function<bool()>;
+
+    static Prefetcher& instance();
+
+    void configure(Executor executor, IdleWait wait_idle);
+
+    /**
+     * Queue a task (id assigned here). A task whose key is already queued,
+     * running or stashed is not repeated; that task's id is returned.
+     * @return id (> 0), or 0 if not configured
+     */
+    uint64_t submit(std::shared_ptr<PrefetchTask> task);
+
+    // Drop a queued or stashed task, or stop a running one nobody waits on
+    bool cancel(uint64_t id);
+
+    // Drop queued tasks, stop the running one and take no more; shutdown() joins
+    void stop();
+
+    // Take prefetched work for `key`; false means the caller does it itself
+    bool adopt_result(const std::string& key, std::string& json);
+    bool adopt_decoded(const std::string& key, DecodedImage& image);
+
+    PrefetchStats stats();
+
+    // Stop the worker (after its current task) and free everything held
+    void shutdown();
+
+private:
+    struct Stashed {
+        uint64_t id;
+        std::string key;
+        PrefetchResult result;
+    };
+
+    Prefetcher() = default;
+
+    void worker_loop();
+    // Shared body of adopt_*; on true, `result` holds the task's output
+    bool adopt_locked(std::unique_lock<std::mutex>& lock, const std::string& key,
+                      bool take_frame, PrefetchResult& result);
+    void stash_locked(const PrefetchTask& task, PrefetchResult&& result);
+    // Move staged outputs into the real output_dir and fix the paths in json
+    static void publish(PrefetchResult& result);
+    static void release(PrefetchResult& result);
+
+    std::mutex mutex_;
+    std::condition_variable wake_;       // worker: queue non-empty or stopping
+    std::condition_variable finished_;   // adopters: running task done
+    std::deque<std::shared_ptr<PrefetchTask>> queue_;
+    std::shared_ptr<PrefetchTask> running_;
+    std::deque<Stashed> stash_;
+    Executor executor_;
+    IdleWait wait_idle_;
+    std::thread worker_;
+    bool stopping_ = false;
+    uint64_t next_id_ = 1;
+    PrefetchStats stats_;
+};
+
+} // namespace planter
+
+#endif
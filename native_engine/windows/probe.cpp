@@ -0,0 +1,296 @@
+/**
+ * @file probe.cpp
+ * @brief Planter Pressure - Header-Only Image Probe
+ */
+
+#include "probe.h"
+#include "json_util.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace planter {
+
+namespace {
+
+    // Longest prefix any signature check needs
+    constexpr size_t PROBE_PREFIX = 32;
+
+    // Give up on JPEGs whose frame header isn't within this many segments
+    constexpr int MAX_JPEG_SEGMENTS = 64;
+
+    class HeaderFile {
+    public:
+        explicit HeaderFile(const std::string& path) : f_(fopen(path.c_str(), "rb")) {}
+        ~HeaderFile() { if (f_) fclose(f_); }
+        HeaderFile(const HeaderFile&) = delete;
+        HeaderFile& operator=(const HeaderFile&) = delete;
+
+        bool is_open() const { return f_ != nullptr; }
+
+        // Read exactly n bytes at offset
+        bool read_at(uint64_t offset, uint8_t* out, size_t n) {
+            if (fseek(f_, static_cast<long>(offset), SEEK_SET) != 0) return false;
+            return fread(out, 1, n, f_) == n;
+        }
+
+        // Read up to n bytes at offset; returns the count read
+        size_t read_some(uint64_t offset, uint8_t* out, size_t n) {
+            if (fseek(f_, static_cast<long>(offset), SEEK_SET) != 0) return 0;
+            return fread(out, 1, n, f_);
+        }
+
+    private:
+        FILE* f_;
+    };
+
+    inline uint32_t be16(const uint8_t* p) { return (p[0] << 8) | p[1]; }
+    inline uint32_t be32(const uint8_t* p) {
+        return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+    }
+    inline uint32_t le16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+    inline uint32_t le24(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16); }
+    inline uint32_t le32(const uint8_t* p) {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    bool fail(std::string& error, const char* message) {
+        error = message;
+        return false;
+    }
+
+    bool set_size(ImageInfo& info, uint64_t width, uint64_t height, std::string& error) {
+        if (width == 0 || height == 0 || width > INT32_MAX || height > INT32_MAX) {
+            return fail(error, "Invalid image dimensions");
+        }
+        info.width = static_cast<int>(width);
+        info.height = static_cast<int>(height);
+        return true;
+    }
+
+// =============================================================================
+// Formats
+// =============================================================================
+
+    bool probe_png(const uint8_t* h, size_t n, ImageInfo& info, std::string& error) {
+        // Signature (8) + IHDR length (4) + "IHDR" (4) + 13 bytes of data
+        if (n < 29 || memcmp(h + 12, "IHDR", 4) != 0) return fail(error, "Missing PNG IHDR");
+
+        info.format = "PNG";
+        info.bit_depth = h[24];
+        switch (h[25]) {
+            case 0: info.channels = 1; info.mode = info.bit_depth == 1 ? "1"
+                                                 : info.bit_depth == 16 ? "I;16" : "L"; break;
+            case 2: info.channels = 3; info.mode = "RGB"; break;
+            case 3: info.channels = 1; info.mode = "P"; break;
+            case 4: info.channels = 2; info.mode = "LA"; break;
+            case 6: info.channels = 4; info.mode = "RGBA"; break;
+            default: return fail(error, "Unknown PNG color type");
+        }
+        return set_size(info, be32(h + 16), be32(h + 20), error);
+    }
+
+    bool probe_jpeg(HeaderFile& file, ImageInfo& info, std::string& error) {
+        uint64_t pos = 2;  // after SOI
+        uint8_t seg[10];
+        for (int i = 0; i < MAX_JPEG_SEGMENTS; ++i) {
+            if (!file.read_at(pos, seg, 4)) break;
+            if (seg[0] != 0xFF) return fail(error, "Corrupt JPEG marker");
+
+            // Fill bytes before a marker
+            if (seg[1] == 0xFF) { ++pos; continue; }
+
+            const uint8_t marker = seg[1];
+            if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) { pos += 2; continue; }
+            if (marker == 0xD9 || marker == 0xDA) break;  // EOI / SOS before any frame header
+
+            const uint32_t length = be16(seg + 2);
+            const bool sof = marker >= 0xC0 && marker <= 0xCF &&
+                             marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+            if (sof) {
+                if (length < 8 || !file.read_at(pos + 4, seg, 6)) return fail(error, "Truncated JPEG SOF");
+                info.format = "JPEG";
+                info.bit_depth = seg[0];
+                info.channels = seg[5];
+                info.mode = info.channels == 1 ? "L" : info.channels == 4 ? "CMYK" : "RGB";
+                return set_size(info, be16(seg + 3), be16(seg + 1), error);
+            }
+            pos += 2 + length;
+        }
+        return fail(error, "No JPEG frame header");
+    }
+
+    bool probe_tiff(HeaderFile& file, const uint8_t* h, ImageInfo& info, std::string& error) {
+        const bool le = h[0] == 'I';
+        auto u16 = [le](const uint8_t* p) { return le ? le16(p) : be16(p); };
+        auto u32 = [le](const uint8_t* p) { return le ? le32(p) : be32(p); };
+
+        if (u16(h + 2) == 43) return fail(error, "BigTIFF not supported by probe");
+
+        const uint32_t ifd = u32(h + 4);
+        uint8_t count_bytes[2];
+        if (!file.read_at(ifd, count_bytes, 2)) return fail(error, "Truncated TIFF IFD");
+        const uint32_t count = u16(count_bytes);
+
+        uint64_t width = 0, height = 0;
+        uint32_t photometric = 1, samples = 1, bits = 1;
+        uint8_t entry[12];
+        for (uint32_t i = 0; i < count; ++i) {
+            if (!file.read_at(ifd + 2 + 12ull * i, entry, 12)) return fail(error, "Truncated TIFF IFD");
+            const uint32_t tag = u16(entry);
+            const uint32_t type = u16(entry + 2);
+            const uint32_t n = u32(entry + 4);
+
+            // SHORT or LONG, first value (inline when it fits in 4 bytes)
+            uint32_t value = type == 3 ? u16(entry + 8) : u32(entry + 8);
+            if (tag == 258 && type == 3 && n > 2) {
+                uint8_t first[2];
+                if (!file.read_at(u32(entry + 8), first, 2)) return fail(error, "Truncated TIFF IFD");
+                value = u16(first);
+            }
+
+            switch (tag) {
+                case 256: width = value; break;
+                case 257: height = value; break;
+                case 258: bits = value; break;
+                case 262: photometric = value; break;
+                case 277: samples = value; break;
+                default: break;
+            }
+        }
+
+        info.format = "TIFF";
+        info.bit_depth = static_cast<int>(bits);
+        info.channels = static_cast<int>(samples);
+        switch (photometric) {
+            case 0:
+            case 1: info.mode = bits == 1 ? "1" : bits == 16 ? "I;16" : samples == 2 ? "LA" : "L"; break;
+            case 3: info.mode = "P"; break;
+            case 5: info.mode = "CMYK"; break;
+            default: info.mode = samples >= 4 ? "RGBA" : "RGB"; break;
+        }
+        return set_size(info, width, height, error);
+    }
+
+    bool probe_webp(const uint8_t* h, size_t n, ImageInfo& info, std::string& error) {
+        if (n < 30) return fail(error, "Truncated WebP header");
+
+        info.format = "WEBP";
+        info.bit_depth = 8;
+        bool alpha = false;
+        uint64_t width = 0, height = 0;
+
+        if (memcmp(h + 12, "VP8X", 4) == 0) {
+            alpha = (h[20] & 0x10) != 0;
+            width = le24(h + 24) + 1ull;
+            height = le24(h + 27) + 1ull;
+        } else if (memcmp(h + 12, "VP8L", 4) == 0) {
+            if (h[20] != 0x2F) return fail(error, "Corrupt WebP lossless header");
+            const uint32_t bits = le32(h + 21);
+            width = (bits & 0x3FFF) + 1ull;
+            height = ((bits >> 14) & 0x3FFF) + 1ull;
+            alpha = ((bits >> 28) & 1) != 0;
+        } else if (memcmp(h + 12, "VP8 ", 4) == 0) {
+            if (h[23] != 0x9D || h[24] != 0x01 || h[25] != 0x2A) return fail(error, "Corrupt WebP lossy header");
+            width = le16(h + 26) & 0x3FFF;
+            height = le16(h + 28) & 0x3FFF;
+        } else {
+            return fail(error, "Unknown WebP chunk");
+        }
+
+        info.channels = alpha ? 4 : 3;
+        info.mode = alpha ? "RGBA" : "RGB";
+        return set_size(info, width, height, error);
+    }
+
+    bool probe_gif(const uint8_t* h, size_t n, ImageInfo& info, std::string& error) {
+        if (n < 10) return fail(error, "Truncated GIF header");
+        info.format = "GIF";
+        info.mode = "P";
+        info.bit_depth = 8;
+        info.channels = 1;
+        return set_size(info, le16(h + 6), le16(h + 8), error);
+    }
+
+    bool probe_bmp(const uint8_t* h, size_t n, ImageInfo& info, std::string& error) {
+        if (n < 26) return fail(error, "Truncated BMP header");
+        info.format = "BMP";
+
+        uint64_t width = 0, height = 0;
+        uint32_t bpp = 0;
+        if (le32(h + 14) == 12) {
+            // OS/2 core header: 16-bit dimensions
+            width = le16(h + 18);
+            height = le16(h + 20);
+            bpp = le16(h + 24);
+        } else {
+            if (n < 30) return fail(error, "Truncated BMP header");
+            const int32_t w = static_cast<int32_t>(le32(h + 18));
+            const int32_t hgt = static_cast<int32_t>(le32(h + 22));  // negative = top-down
+            width = w < 0 ? 0 : static_cast<uint64_t>(w);
+            height = hgt < 0 ? static_cast<uint64_t>(-static_cast<int64_t>(hgt)) : static_cast<uint64_t>(hgt);
+            bpp = le16(h + 28);
+        }
+
+        // 32-bit BMPs decode as RGB unless they carry an alpha bitfield
+        info.bit_depth = bpp <= 8 ? static_cast<int>(bpp) : 8;
+        info.channels = bpp > 8 ? 3 : 1;
+        info.mode = bpp > 8 ? "RGB" : bpp == 1 ? "1" : "P";
+        return set_size(info, width, height, error);
+    }
+
+} // anonymous namespace
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+bool probe_image(const std::string& path, ImageInfo& info, std::string& error) {
+    HeaderFile file(path);
+    if (!file.is_open()) return fail(error, "Cannot open file");
+
+    uint8_t h[PROBE_PREFIX] = {};
+    const size_t n = file.read_some(0, h, sizeof(h));
+
+    static const uint8_t PNG_SIG[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (n >= 8 && memcmp(h, PNG_SIG, 8) == 0) return probe_png(h, n, info, error);
+    if (n >= 3 && h[0] == 0xFF && h[1] == 0xD8 && h[2] == 0xFF) return probe_jpeg(file, info, error);
+    if (n >= 8 && ((h[0] == 'I' && h[1] == 'I') || (h[0] == 'M' && h[1] == 'M'))) {
+        return probe_tiff(file, h, info, error);
+    }
+    if (n >= 16 && memcmp(h, "RIFF", 4) == 0 && memcmp(h + 8, "WEBP", 4) == 0) {
+        return probe_webp(h, n, info, error);
+    }
+    if (n >= 6 && (memcmp(h, "GIF87a", 6) == 0 || memcmp(h, "GIF89a", 6) == 0)) {
+        return probe_gif(h, n, info, error);
+    }
+    if (n >= 2 && h[0] == 'B' && h[1] == 'M') return probe_bmp(h, n, info, error);
+
+    return fail(error, "Unrecognised image format");
+}
+
+bool admit_image(const std::string& path, uint64_t max_pixels, uint64_t& pixels, std::string& error) {
+    ImageInfo info;
+    std::string probe_error;
+    pixels = 0;
+    if (!probe_image(path, info, probe_error)) return true;
+
+    pixels = info.pixels();
+    if (max_pixels && pixels > max_pixels) {
+        error = "Image too large: " + std::to_string(info.width) + "x" + std::to_string(info.height) +
+                " exceeds the " + std::to_string(max_pixels) + " pixel limit";
+        return false;
+    }
+    return true;
+}
+
+std::string image_info_json(const ImageInfo& info) {
+    return "\"format\":\"" + json_escape(info.format) + "\"" +
+           ",\"width\":" + std::to_string(info.width) +
+           ",\"height\":" + std::to_string(info.height) +
+           ",\"mode\":\"" + json_escape(info.mode) + "\"" +
+           ",\"bit_depth\":" + std::to_string(info.bit_depth) +
+           ",\"channels\":" + std::to_string(info.channels);
+}
+
+} // namespace planter
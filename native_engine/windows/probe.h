@@ -0,0 +1,53 @@
+/**
+ * @file probe.h
+ * @brief Planter Pressure - Header-Only Image Probe
+ *
+ * OPTIMIZATIONS:
+ * - Reads only the container header (PNG IHDR, JPEG SOF, TIFF IFD, WebP VP8X/VP8/VP8L,
+ *   GIF screen descriptor, BMP DIB header); no pixel data, no Python
+ * - JPEG segments and TIFF IFDs are reached by seeking, not reading through
+ * - Lets the scheduler reject oversized inputs before a worker decodes them
+ */
+
+#ifndef PLANTER_PRESSURE_PROBE_H
+#define PLANTER_PRESSURE_PROBE_H
+
+#include <cstdint>
+#include <string>
+
+namespace planter {
+
+struct ImageInfo {
+    std::string format;   // "PNG", "JPEG", "TIFF", "WEBP", "GIF", "BMP"
+    std::string mode;     // Pillow mode the decoder would produce ("RGB", "L", "P", ...)
+    int width = 0;
+    int height = 0;
+    int bit_depth = 0;    // bits per sample
+    int channels = 0;
+
+    uint64_t pixels() const {
+        return static_cast<uint64_t>(width) * static_cast<uint64_t>(height);
+    }
+};
+
+/**
+ * Parse the image header at `path`.
+ * @return false with `error` set if the file can't be read or the format
+ *         is not recognised
+ */
+bool probe_image(const std::string& path, ImageInfo& info, std::string& error);
+
+/**
+ * Admission check before decoding: false (with `error`) only when the
+ * header parses and the image has more than max_pixels pixels (0 = no
+ * limit). Unreadable or unrecognised files are admitted; the decoder
+ * reports those. `pixels` receives the probed size, 0 if unknown.
+ */
+bool admit_image(const std::string& path, uint64_t max_pixels, uint64_t& pixels, std::string& error);
+
+// JSON members for `info` without braces: "format":"PNG","width":...
+std::string image_info_json(const ImageInfo& info);
+
+} // namespace planter
+
+#endif
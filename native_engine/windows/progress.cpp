@@ -0,0 +1,28 @@
+/**
+ * @file progress.cpp
+ * @brief Planter Pressure - Progress Events for the Call in Flight
+ */
+
+#include "progress.h"
+
+namespace planter {
+
+namespace {
+
+    thread_local ProgressSink t_current;
+
+} // anonymous namespace
+
+ProgressSink current_progress() {
+    return t_current;
+}
+
+ProgressScope::ProgressScope(const ProgressSink& sink) : previous_(t_current) {
+    t_current = sink;
+}
+
+ProgressScope::~ProgressScope() {
+    t_current = previous_;
+}
+
+} // namespace planter
@@ -0,0 +1,60 @@
+/**
+ * @file progress.h
+ * @brief Planter Pressure - Progress Events for the Call in Flight
+ *
+ * OPTIMIZATIONS:
+ * - Sink is a plain function pointer; no allocation or locking per event
+ * - Installed per calling thread, so Python code reports without plumbing
+ * - Tile events throttled to a bounded count per stage
+ * - Cancellation rides on the same sink: one relaxed load per stage
+ */
+
+#ifndef PLANTER_PRESSURE_PROGRESS_H
+#define PLANTER_PRESSURE_PROGRESS_H
+
+#include "engine.h"
+
+#include <atomic>
+
+namespace planter {
+
+struct ProgressSink {
+    EngineProgressCallback fn = nullptr;
+    void* user_data = nullptr;
+
+    // Set by whoever may abandon the call; checked at stage boundaries
+    const std::atomic<bool>* cancel = nullptr;
+
+    explicit operator bool() const { return fn != nullptr; }
+
+    void report(int stage, int done, int total) const {
+        if (fn) fn(user_data, stage, done, total);
+    }
+
+    bool cancelled() const {
+        return cancel && cancel->load(std::memory_order_relaxed);
+    }
+};
+
+// Sink of the engine call running on this thread (empty if none)
+ProgressSink current_progress();
+
+/**
+ * Installs a sink as the current thread's for the scope of one call.
+ * Worker threads never see it; capture current_progress() before fanning out.
+ */
+class ProgressScope {
+public:
+    explicit ProgressScope(const ProgressSink& sink);
+    ~ProgressScope();
+
+    ProgressScope(const ProgressScope&) = delete;
+    ProgressScope& operator=(const ProgressScope&) = delete;
+
+private:
+    ProgressSink previous_;
+};
+
+} // namespace planter
+
+#endif
@@ -0,0 +1,222 @@
+/**
+ * @file resources.cpp
+ * @brief Planter Pressure - CPU and Memory Limits of the Host Process
+ */
+
+#include "resources.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace planter {
+
+namespace {
+
+#ifdef _WIN32
+
+    void read_platform_limits(ResourceLimits& limits) {
+        DWORD_PTR process_mask = 0;
+        DWORD_PTR system_mask = 0;
+        if (GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)) {
+            int count = 0;
+            for (; process_mask; process_mask &= process_mask - 1) ++count;
+            limits.affinity_cpus = count;
+        }
+
+        // Limits of the job object the process runs in (NULL = its own job)
+        JOBOBJECT_CPU_RATE_CONTROL_INFORMATION rate = {};
+        if (QueryInformationJobObject(nullptr, JobObjectCpuRateControlInformation,
+                                      &rate, sizeof(rate), nullptr) &&
+            (rate.ControlFlags & JOB_OBJECT_CPU_RATE_CONTROL_ENABLE) &&
+            (rate.ControlFlags & JOB_OBJECT_CPU_RATE_CONTROL_HARD_CAP)) {
+            // CpuRate is in 1/100 of a percent of all processors
+            limits.quota_cpus = rate.CpuRate / 10000.0 * limits.hardware_cpus;
+        }
+
+        JOBOBJECT_EXTENDED_LIMIT_INFORMATION extended = {};
+        if (QueryInformationJobObject(nullptr, JobObjectExtendedLimitInformation,
+                                      &extended, sizeof(extended), nullptr)) {
+            DWORD flags = extended.BasicLimitInformation.LimitFlags;
+            uint64_t limit = 0;
+            if (flags & JOB_OBJECT_LIMIT_JOB_MEMORY) {
+                limit = extended.JobMemoryLimit;
+            }
+            if ((flags & JOB_OBJECT_LIMIT_PROCESS_MEMORY) &&
+                (limit == 0 || extended.ProcessMemoryLimit < limit)) {
+                limit = extended.ProcessMemoryLimit;
+            }
+            limits.memory_limit = limit;
+        }
+    }
+
+#elif defined(__linux__)
+
+    bool read_line(const std::string& path, std::string& line) {
+        FILE* f = fopen(path.c_str(), "rb");
+        if (!f) return false;
+        char buffer[256];
+        bool ok = fgets(buffer, sizeof(buffer), f) != nullptr;
+        fclose(f);
+        if (ok) line.assign(buffer, strcspn(buffer, "\n"));
+        return ok;
+    }
+
+    // Unified (v2) hierarchy path of this process, e.g. "/user.slice/app.scope"
+    bool cgroup_path(std::string& path) {
+        FILE* f = fopen("/proc/self/cgroup", "rb");
+        if (!f) return false;
+        char buffer[4096];
+        bool found = false;
+        while (fgets(buffer, sizeof(buffer), f)) {
+            if (strncmp(buffer, "0::", 3) == 0) {
+                path.assign(buffer + 3, strcspn(buffer + 3, "\n"));
+                found = true;
+                break;
+            }
+        }
+        fclose(f);
+        return found;
+    }
+
+    /**
+     * cgroup v2 limits are enforced at every level, so the effective one
+     * is the tightest between our group and the root of the mount (which,
+     * inside a container, is the container's own group).
+     */
+    void read_cgroup_limits(ResourceLimits& limits) {
+        std::string path;
+        if (!cgroup_path(path)) return;
+
+        static const char ROOT[] = "/sys/fs/cgroup";
+        for (;;) {
+            std::string dir = ROOT + (path == "/" ? std::string() : path);
+            std::string line;
+
+            // "max 100000" or "<quota> <period>" (microseconds)
+            if (read_line(dir + "/cpu.max", line) && line.compare(0, 3, "max") != 0) {
+                double quota = 0.0;
+                double period = 0.0;
+                if (sscanf(line.c_str(), "%lf %lf", &quota, &period) == 2 && quota > 0 && period > 0) {
+                    double cpus = quota / period;
+                    if (limits.quota_cpus == 0.0 || cpus < limits.quota_cpus) limits.quota_cpus = cpus;
+                }
+            }
+
+            if (read_line(dir + "/memory.max", line) && line != "max") {
+                uint64_t bytes = strtoull(line.c_str(), nullptr, 10);
+                if (bytes && (limits.memory_limit == 0 || bytes < limits.memory_limit)) {
+                    limits.memory_limit = bytes;
+                }
+            }
+
+            if (path.empty() || path == "/") break;
+            size_t slash = path.rfind('/');
+            path = slash == 0 || slash == std::string::npos ? "/" : path.substr(0, slash);
+        }
+    }
+
+    void read_platform_limits(ResourceLimits& limits) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            limits.affinity_cpus = CPU_COUNT(&set);
+        }
+        read_cgroup_limits(limits);
+    }
+
+#else
+
+    void read_platform_limits(ResourceLimits&) {
+    }
+
+#endif
+
+} // anonymous namespace
+
+ResourceLimits read_resource_limits() {
+    ResourceLimits limits;
+    limits.hardware_cpus = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    read_platform_limits(limits);
+
+    int cpus = limits.hardware_cpus;
+    if (limits.affinity_cpus > 0) cpus = std::min(cpus, limits.affinity_cpus);
+    // A 1.5-CPU quota still runs two threads usefully; round up
+    if (limits.quota_cpus > 0.0) cpus = std::min(cpus, static_cast<int>(std::ceil(limits.quota_cpus)));
+    limits.cpus = std::max(1, cpus);
+    return limits;
+}
+
+// =============================================================================
+// ResourceMonitor
+// =============================================================================
+
+ResourceMonitor& ResourceMonitor::instance() {
+    static ResourceMonitor monitor;
+    return monitor;
+}
+
+ResourceMonitor::~ResourceMonitor() {
+    stop();
+}
+
+ResourceLimits ResourceMonitor::start(std::chrono::milliseconds interval, Listener listener) {
+    stop();
+
+    ResourceLimits limits = read_resource_limits();
+    listener(limits);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    limits_ = limits;
+    listener_ = std::move(listener);
+    stopping_ = false;
+    thread_ = std::thread(&ResourceMonitor::monitor_loop, this, interval);
+    return limits;
+}
+
+void ResourceMonitor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) thread_.join();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    listener_ = nullptr;
+}
+
+ResourceLimits ResourceMonitor::current() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return limits_;
+}
+
+void ResourceMonitor::monitor_loop(std::chrono::milliseconds interval) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        if (wake_.wait_for(lock, interval, [this] { return stopping_; })) return;
+
+        lock.unlock();
+        ResourceLimits limits = read_resource_limits();
+        lock.lock();
+        if (stopping_) return;
+        if (limits == limits_) continue;
+
+        limits_ = limits;
+        Listener listener = listener_;
+        lock.unlock();
+        listener(limits);
+        lock.lock();
+    }
+}
+
+} // namespace planter
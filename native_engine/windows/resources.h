@@ -0,0 +1,74 @@
+/**
+ * @file resources.h
+ * @brief Planter Pressure - CPU and Memory Limits of the Host Process
+ *
+ * OPTIMIZATIONS:
+ * - Thread counts follow the CPUs the process may actually use (affinity
+ *   mask, cgroup v2 cpu.max or a job object CPU cap), not the host's cores,
+ *   so containers and shared VDI hosts don't oversubscribe their quota
+ * - Memory budgets shrink under cgroup memory.max / job memory limits
+ * - Limits are re-read periodically; changes are applied while running
+ */
+
+#ifndef PLANTER_PRESSURE_RESOURCES_H
+#define PLANTER_PRESSURE_RESOURCES_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace planter {
+
+struct ResourceLimits {
+    int hardware_cpus = 1;       // std::thread::hardware_concurrency
+    int affinity_cpus = 0;       // CPUs in the process affinity mask; 0 = unknown
+    double quota_cpus = 0.0;     // CPU time quota in CPUs (cpu.max, job CPU cap); 0 = none
+    uint64_t memory_limit = 0;   // bytes (memory.max, job memory limit); 0 = none
+    int cpus = 1;                // usable CPUs: the tightest of the above, at least 1
+
+    bool operator==(const ResourceLimits& other) const {
+        return affinity_cpus == other.affinity_cpus && quota_cpus == other.quota_cpus &&
+               memory_limit == other.memory_limit && cpus == other.cpus;
+    }
+    bool operator!=(const ResourceLimits& other) const { return !(*this == other); }
+};
+
+// Read the current limits (a few small file reads / system calls)
+ResourceLimits read_resource_limits();
+
+/**
+ * Re-reads the limits on a background thread and reports changes.
+ * The listener runs once from start() and then on the monitor thread.
+ */
+class ResourceMonitor {
+public:
+    using Listener = std::function<void(const ResourceLimits&)>;
+
+    static ResourceMonitor& instance();
+
+    // @return the limits the listener was first called with
+    ResourceLimits start(std::chrono::milliseconds interval, Listener listener);
+    void stop();
+
+    ResourceLimits current() const;
+
+private:
+    ResourceMonitor() = default;
+    ~ResourceMonitor();
+
+    void monitor_loop(std::chrono::milliseconds interval);
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::thread thread_;
+    Listener listener_;
+    ResourceLimits limits_;
+    bool stopping_ = false;
+};
+
+} // namespace planter
+
+#endif
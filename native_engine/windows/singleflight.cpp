@@ -0,0 +1,28 @@
+/**
+ * @file singleflight.cpp
+ * @brief Planter Pressure - Coalescing of Identical In-Flight Requests
+ */
+
+#include "singleflight.h"
+
+#include <filesystem>
+
+namespace planter {
+
+std::string input_identity(const std::string& path) {
+    std::error_code ec;
+    const std::filesystem::path absolute =
+            std::filesystem::absolute(std::filesystem::u8path(path), ec).lexically_normal();
+    if (ec) return std::string();
+
+    const uintmax_t size = std::filesystem::file_size(absolute, ec);
+    if (ec) return std::string();
+
+    const auto mtime = std::filesystem::last_write_time(absolute, ec);
+    if (ec) return std::string();
+
+    return absolute.u8string() + "|" + std::to_string(size) + "|" +
+           std::to_string(mtime.time_since_epoch().count());
+}
+
+} // namespace planter
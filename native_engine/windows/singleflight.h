@@ -0,0 +1,126 @@
+/**
+ * @file singleflight.h
+ * @brief Planter Pressure - Coalescing of Identical In-Flight Requests
+ *
+ * OPTIMIZATIONS:
+ * - A request identical to one already running (same input file contents
+ *   identity, same parameters) waits for that call and shares its result
+ *   instead of decoding, filtering and encoding a second time
+ * - Keys live only while their call runs; nothing is cached afterwards
+ */
+
+#ifndef PLANTER_PRESSURE_SINGLEFLIGHT_H
+#define PLANTER_PRESSURE_SINGLEFLIGHT_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace planter {
+
+/**
+ * "absolute path|size|mtime" of an input file, so a rewritten file never
+ * joins a call still working on the old contents. Empty if the file can't
+ * be stat'ed; callers then run without coalescing.
+ */
+std::string input_identity(const std::string& path);
+
+struct SingleFlightStats {
+    uint64_t leaders = 0;     // calls that did the work
+    uint64_t followers = 0;   // calls that attached to a running one
+};
+
+/**
+ * Runs at most one call per key at a time; callers arriving while it runs
+ * block until it finishes and receive a copy of its Result. Result must be
+ * copyable. If the leading call throws, each follower runs fn itself.
+ */
+template <typename Result>
+class SingleFlight {
+public:
+    // `follower` reports whether this caller got a shared result
+    template <typename Fn>
+    Result run(const std::string& key, Fn&& fn, bool* follower = nullptr) {
+        if (follower) *follower = false;
+        if (key.empty()) return fn();
+
+        std::shared_ptr<Call> call;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = calls_.find(key);
+            if (it != calls_.end()) {
+                call = it->second;
+                ++stats_.followers;
+            } else {
+                calls_.emplace(key, std::make_shared<Call>());
+                ++stats_.leaders;
+            }
+        }
+
+        if (call) {
+            std::unique_lock<std::mutex> lock(call->mutex);
+            call->finished.wait(lock, [&] { return call->done; });
+            if (call->failed) {
+                lock.unlock();
+                return fn();
+            }
+            if (follower) *follower = true;
+            return call->result;
+        }
+
+        try {
+            Result result = fn();
+            finish(key, &result);
+            return result;
+        } catch (...) {
+            finish(key, nullptr);
+            throw;
+        }
+    }
+
+    SingleFlightStats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+private:
+    struct Call {
+        std::mutex mutex;
+        std::condition_variable finished;
+        bool done = false;
+        bool failed = false;
+        Result result{};
+    };
+
+    // Unpublish the key first, so later arrivals start a fresh call
+    void finish(const std::string& key, const Result* result) {
+        std::shared_ptr<Call> call;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = calls_.find(key);
+            call = std::move(it->second);
+            calls_.erase(it);
+        }
+        {
+            std::lock_guard<std::mutex> lock(call->mutex);
+            if (result) {
+                call->result = *result;
+            } else {
+                call->failed = true;
+            }
+            call->done = true;
+        }
+        call->finished.notify_all();
+    }
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<Call>> calls_;
+    SingleFlightStats stats_;
+};
+
+} // namespace planter
+
+#endif
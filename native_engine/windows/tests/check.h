@@ -0,0 +1,53 @@
+/**
+ * @file check.h
+ * @brief Planter Pressure - Minimal Checks for the Native Unit Tests
+ *
+ * Each test is a plain executable run by ctest: a failed CHECK prints
+ * where and keeps going, and finish() turns any failure into exit code 1.
+ */
+
+#ifndef PLANTER_PRESSURE_TESTS_CHECK_H
+#define PLANTER_PRESSURE_TESTS_CHECK_H
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+namespace planter_test {
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+inline int finish(const char* name) {
+    if (failures()) {
+        std::fprintf(stderr, "%s: %d check(s) failed\n", name, failures());
+        return 1;
+    }
+    std::printf("%s: ok\n", name);
+    return 0;
+}
+
+// Poll `done` until it holds or `seconds` pass; false on timeout
+template <typename Done>
+bool wait_until(Done done, int seconds = 10) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+} // namespace planter_test
+
+#define CHECK(cond)                                                                   \
+    do {                                                                              \
+        if (!(cond)) {                                                                \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++planter_test::failures();                                               \
+        }                                                                             \
+    } while (0)
+
+#endif
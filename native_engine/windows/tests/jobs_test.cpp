@@ -0,0 +1,232 @@
+/**
+ * @file jobs_test.cpp
+ * @brief Planter Pressure - Job Queue Full-Queue Policy Tests
+ *
+ * One worker is held inside the executor by a gate while manifests are
+ * submitted, so the queue fills deterministically; opening the gate lets
+ * everything drain. Input paths don't exist: the probe admits them at
+ * cost 0 and the executor never opens them.
+ */
+
+#include "check.h"
+#include "jobs.h"
+
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+using namespace planter;
+namespace fs = std::filesystem;
+
+namespace {
+
+    constexpr size_t QUEUE_CAPACITY = 2;
+
+    // Holds every executor call until opened
+    struct Gate {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool open = false;
+        int entered = 0;
+
+        JobOutcome run(const Job& job) {
+            std::unique_lock<std::mutex> lock(mutex);
+            ++entered;
+            cv.notify_all();
+            cv.wait(lock, [this] { return open; });
+            JobOutcome outcome;
+            outcome.ok = true;
+            outcome.output_path = job.input_path;
+            return outcome;
+        }
+
+        void wait_entered(int count) {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&] { return entered >= count; });
+        }
+
+        void release() {
+            std::lock_guard<std::mutex> lock(mutex);
+            open = true;
+            cv.notify_all();
+        }
+    };
+
+    fs::path g_dir;
+
+    std::string write_manifest(const std::string& name, int entries) {
+        fs::path path = g_dir / (name + ".json");
+        std::ofstream out(path, std::ios::binary);
+        out << "{\"output_dir\":\"out\",\"items\":[";
+        for (int i = 0; i < entries; ++i) {
+            if (i) out << ",";
+            out << "{\"input_image_path\":\"" << name << "_" << i << ".png\"}";
+        }
+        out << "]}";
+        return path.string();
+    }
+
+    std::string read_file(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        std::stringstream text;
+        text << in.rdbuf();
+        return text.str();
+    }
+
+    size_t count_of(const std::string& text, const std::string& needle) {
+        size_t count = 0;
+        for (size_t pos = text.find(needle); pos != std::string::npos;
+             pos = text.find(needle, pos + needle.size())) {
+            ++count;
+        }
+        return count;
+    }
+
+    bool has(const std::string& status, const std::string& field) {
+        return status.find(field) != std::string::npos;
+    }
+
+    bool wait_done(uint64_t batch) {
+        return planter_test::wait_until(
+            [&] { return has(JobSystem::instance().batch_status(batch), "\"done\":true"); });
+    }
+
+    bool wait_parsed(uint64_t batch) {
+        return planter_test::wait_until(
+            [&] { return has(JobSystem::instance().batch_status(batch), "\"parsing\":false"); });
+    }
+
+    // Start one worker under `policy` and park it in the executor on a single job
+    uint64_t occupy_worker(Gate& gate, QueueFullPolicy policy) {
+        JobSystem& jobs = JobSystem::instance();
+        jobs.configure_queue(QUEUE_CAPACITY, policy);
+        jobs.configure(1, 0, [&gate](const Job& job) { return gate.run(job); });
+
+        Job job;
+        job.input_path = "occupant.png";
+        std::string error;
+        uint64_t batch = jobs.submit_job(job, error);
+        CHECK(batch != 0);
+        gate.wait_entered(1);
+        return batch;
+    }
+
+    void test_block() {
+        Gate gate;
+        JobSystem& jobs = JobSystem::instance();
+        uint64_t occupant = occupy_worker(gate, QueueFullPolicy::Block);
+        JobQueueStats before = jobs.queue_stats();
+
+        std::string error;
+        std::string results = (g_dir / "block.jsonl").string();
+        uint64_t batch = jobs.submit_manifest(write_manifest("block", 6), results, error);
+        CHECK(batch != 0);
+
+        // The reader fills the queue, then waits instead of failing entries
+        CHECK(planter_test::wait_until([&] { return jobs.queue_stats().blocked > before.blocked; }));
+        CHECK(jobs.queue_stats().depth == QUEUE_CAPACITY);
+        CHECK(has(jobs.batch_status(batch), "\"parsing\":true"));
+
+        // Follow-ups never wait: a full queue rejects them even under Block
+        Job follow_up;
+        follow_up.input_path = "follow_up.png";
+        CHECK(jobs.submit_job(follow_up, error) == 0);
+        CHECK(error.find("retry after") != std::string::npos);
+
+        gate.release();
+        CHECK(wait_done(batch));
+        CHECK(wait_done(occupant));
+        CHECK(has(jobs.batch_status(batch), "\"completed\":6,\"failed\":0"));
+
+        JobQueueStats after = jobs.queue_stats();
+        CHECK(after.policy == QueueFullPolicy::Block);
+        CHECK(after.dropped == before.dropped);
+        CHECK(after.rejected == before.rejected + 1);   // the follow-up only
+        CHECK(count_of(read_file(results), "\"status\":\"success\"") == 6);
+        jobs.shutdown();
+    }
+
+    void test_reject() {
+        Gate gate;
+        JobSystem& jobs = JobSystem::instance();
+        uint64_t occupant = occupy_worker(gate, QueueFullPolicy::Reject);
+        JobQueueStats before = jobs.queue_stats();
+
+        std::string error;
+        std::string results = (g_dir / "reject.jsonl").string();
+        uint64_t batch = jobs.submit_manifest(write_manifest("reject", 6), results, error);
+        CHECK(batch != 0);
+
+        // Entries beyond the queue's room fail at once, with a retry hint
+        CHECK(wait_parsed(batch));
+        CHECK(has(jobs.batch_status(batch), "\"completed\":0,\"failed\":4"));
+        CHECK(jobs.queue_stats().rejected == before.rejected + 4);
+        CHECK(jobs.queue_stats().blocked == before.blocked);
+
+        gate.release();
+        CHECK(wait_done(batch));
+        CHECK(wait_done(occupant));
+        CHECK(has(jobs.batch_status(batch), "\"completed\":2,\"failed\":4"));
+
+        std::string lines = read_file(results);
+        CHECK(count_of(lines, "\"status\":\"success\"") == 2);
+        CHECK(count_of(lines, "\"retry_after_ms\":") == 4);
+        // Queue order is manifest order: the first two entries got in
+        CHECK(has(lines, "\"input_image_path\":\"reject_0.png\",\"status\":\"success\""));
+        CHECK(has(lines, "\"input_image_path\":\"reject_1.png\",\"status\":\"success\""));
+        jobs.shutdown();
+    }
+
+    void test_drop_oldest() {
+        Gate gate;
+        JobSystem& jobs = JobSystem::instance();
+        uint64_t occupant = occupy_worker(gate, QueueFullPolicy::DropOldest);
+        JobQueueStats before = jobs.queue_stats();
+
+        std::string error;
+        std::string old_results = (g_dir / "old.jsonl").string();
+        std::string new_results = (g_dir / "new.jsonl").string();
+
+        // The first manifest fills the queue exactly and finishes reading
+        uint64_t old_batch = jobs.submit_manifest(write_manifest("old", 2), old_results, error);
+        CHECK(old_batch != 0);
+        CHECK(wait_parsed(old_batch));
+        CHECK(jobs.queue_stats().dropped == before.dropped);
+
+        // The second evicts both of the first's entries, then meets its own
+        // entry at the head and waits rather than dropping it
+        uint64_t new_batch = jobs.submit_manifest(write_manifest("new", 4), new_results, error);
+        CHECK(new_batch != 0);
+        CHECK(wait_done(old_batch));
+        CHECK(planter_test::wait_until([&] { return jobs.queue_stats().blocked > before.blocked; }));
+        CHECK(jobs.queue_stats().dropped == before.dropped + 2);
+        CHECK(has(jobs.batch_status(old_batch), "\"completed\":0,\"failed\":2"));
+        CHECK(count_of(read_file(old_results), "Dropped: job queue full") == 2);
+
+        gate.release();
+        CHECK(wait_done(new_batch));
+        CHECK(wait_done(occupant));
+        CHECK(has(jobs.batch_status(new_batch), "\"completed\":4,\"failed\":0"));
+        CHECK(jobs.queue_stats().dropped == before.dropped + 2);
+        CHECK(jobs.queue_stats().rejected == before.rejected);
+        jobs.shutdown();
+    }
+
+} // anonymous namespace
+
+int main() {
+    g_dir = fs::temp_directory_path() / "planter_jobs_test";
+    std::error_code ec;
+    fs::remove_all(g_dir, ec);
+    fs::create_directories(g_dir);
+
+    test_block();
+    test_reject();
+    test_drop_oldest();
+
+    fs::remove_all(g_dir, ec);
+    return planter_test::finish("jobs_test");
+}
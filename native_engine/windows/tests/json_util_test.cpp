@@ -0,0 +1,145 @@
+/**
+ * @file json_util_test.cpp
+ * @brief Planter Pressure - JsonReader and canonical_json Tests
+ */
+
+#include "check.h"
+#include "json_util.h"
+
+#include <cstring>
+#include <string>
+
+using namespace planter;
+
+namespace {
+
+    bool read_string(const std::string& json, std::string& out) {
+        JsonReader r(json.data(), json.size());
+        return r.read_string(out);
+    }
+
+    bool canonical(const std::string& json, std::string& out, const char* skip_key = nullptr) {
+        std::string error;
+        out.clear();
+        return canonical_json(json.data(), json.size(), out, error, skip_key);
+    }
+
+    std::string nested(int depth) {
+        return std::string(depth, '[') + std::string(depth, ']');
+    }
+
+    void test_surrogate_pairs() {
+        std::string out;
+        CHECK(read_string("\"\\ud83d\\ude00\"", out));
+        CHECK(out == "\xF0\x9F\x98\x80");   // U+1F600
+        CHECK(read_string("\"a\\uD834\\uDD1Eb\"", out));
+        CHECK(out == "a\xF0\x9D\x84\x9E" "b");   // U+1D11E, upper-case hex
+        CHECK(read_string("\"\\u00e9\\u20ac\"", out));
+        CHECK(out == "\xC3\xA9\xE2\x82\xAC");
+    }
+
+    void test_lone_surrogates() {
+        std::string out;
+        CHECK(!read_string("\"\\ud83d\"", out));            // high at end of string
+        CHECK(!read_string("\"\\ud83dx\"", out));           // high followed by text
+        CHECK(!read_string("\"\\ud83d\\u0041\"", out));     // high followed by non-low
+        CHECK(!read_string("\"\\ud83d\\ud83d\"", out));     // two highs
+        CHECK(!read_string("\"\\ude00\"", out));            // low on its own
+
+        JsonReader r("\"\\ude00\"", 8);
+        CHECK(!r.read_string(out));
+        CHECK(r.error().find("surrogate") != std::string::npos);
+    }
+
+    void test_null_numbers() {
+        double value = 0.0;
+        {
+            JsonReader r("null", 4);
+            CHECK(!r.read_number(value));
+        }
+        for (const char* bad : {"nan", "inf", "-", "1e", "--1"}) {
+            JsonReader r(bad, strlen(bad));
+            CHECK(!r.read_number(value));
+        }
+        {
+            JsonReader r("-1.5e2", 6);
+            CHECK(r.read_number(value));
+            CHECK(value == -150.0);
+        }
+
+        // null is still a value: skipped and kept by canonical form
+        std::string out;
+        CHECK(canonical("{\"sharpness\": null}", out));
+        CHECK(out == "{\"sharpness\":null}");
+        CHECK(!canonical("{\"sharpness\": nul}", out));
+    }
+
+    void test_depth_limit() {
+        std::string out;
+        CHECK(canonical(nested(65), out));   // MAX_DEPTH levels below the top
+        CHECK(!canonical(nested(66), out));
+        CHECK(!canonical(nested(100000), out));   // fails without exhausting the stack
+
+        std::string shallow = "{\"a\":" + nested(63) + ",\"b\":1}";
+        std::string deep = "{\"a\":" + nested(100000) + ",\"b\":1}";
+        JsonReader ok(shallow.data(), shallow.size());
+        CHECK(ok.skip_value());
+        CHECK(ok.peek() == 0);
+        JsonReader too_deep(deep.data(), deep.size());
+        CHECK(!too_deep.skip_value());
+    }
+
+    void test_bom() {
+        const std::string json = "\xEF\xBB\xBF{\"b\":2,\"a\":1}";
+        JsonReader r(json.data(), json.size());
+        CHECK(r.peek() == '{');
+        CHECK(r.begin_object());
+        std::string key;
+        bool done = false;
+        CHECK(r.next_key(key, done) && !done && key == "b");
+
+        std::string out;
+        CHECK(canonical(json, out));
+        CHECK(out == "{\"a\":1,\"b\":2}");
+
+        // Only a leading BOM is tolerated
+        CHECK(!canonical("{\"a\":\xEF\xBB\xBF" "1}", out));
+    }
+
+    void test_canonical_key_order() {
+        std::string a;
+        std::string b;
+        CHECK(canonical("{\"b\":1,\"a\":{\"d\":[3,1],\"c\":true},\"e\":null}", a));
+        CHECK(a == "{\"a\":{\"c\":true,\"d\":[3,1]},\"b\":1,\"e\":null}");
+
+        // Order, whitespace and number spelling don't matter; array order does
+        CHECK(canonical(" { \"e\" : null , \"a\" : { \"c\" : true , \"d\" : [ 3.0 , 1e0 ] } , \"b\" : 1 } ", b));
+        CHECK(a == b);
+        CHECK(canonical("{\"b\":1,\"a\":{\"d\":[1,3],\"c\":true},\"e\":null}", b));
+        CHECK(a != b);
+
+        // Keys sort by bytes, so upper case before lower and prefixes first
+        CHECK(canonical("{\"ab\":0,\"a\":0,\"B\":0,\"b\":0}", a));
+        CHECK(a == "{\"B\":0,\"a\":0,\"ab\":0,\"b\":0}");
+
+        // skip_key drops the top-level member only
+        CHECK(canonical("{\"id\":7,\"x\":{\"id\":8}}", a, "id"));
+        CHECK(a == "{\"x\":{\"id\":8}}");
+
+        // Strings are re-escaped the same way however they were written
+        CHECK(canonical("{\"k\":\"\\u0041\\/\"}", a));
+        CHECK(canonical("{\"k\":\"A/\"}", b));
+        CHECK(a == b);
+    }
+
+} // anonymous namespace
+
+int main() {
+    test_surrogate_pairs();
+    test_lone_surrogates();
+    test_null_numbers();
+    test_depth_limit();
+    test_bom();
+    test_canonical_key_order();
+    return planter_test::finish("json_util_test");
+}
@@ -0,0 +1,161 @@
+/**
+ * @file mpmc_ring_test.cpp
+ * @brief Planter Pressure - MpmcRing Tests
+ */
+
+#include "check.h"
+#include "mpmc_ring.h"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using planter::MpmcRing;
+
+namespace {
+
+    void test_capacity_rounding() {
+        CHECK(MpmcRing<int>(0).capacity() == 2);
+        CHECK(MpmcRing<int>(3).capacity() == 4);
+        CHECK(MpmcRing<int>(8).capacity() == 8);
+    }
+
+    void test_full_and_empty() {
+        MpmcRing<int> ring(4);
+        int value = 0;
+        CHECK(!ring.try_pop(value));
+        for (int i = 0; i < 4; ++i) CHECK(ring.try_push(int(i)));
+
+        // A failed push leaves the value with the caller
+        int extra = 99;
+        CHECK(!ring.try_push(std::move(extra)));
+        CHECK(extra == 99);
+        CHECK(ring.size_approx() == 4);
+
+        for (int i = 0; i < 4; ++i) {
+            CHECK(ring.try_pop(value));
+            CHECK(value == i);
+        }
+        CHECK(!ring.try_pop(value));
+        CHECK(ring.size_approx() == 0);
+    }
+
+    void test_wrap_around() {
+        // Cursors run many laps past the capacity; order must hold throughout
+        MpmcRing<uint64_t> ring(4);
+        uint64_t next_in = 0;
+        uint64_t next_out = 0;
+        for (int round = 0; round < 10000; ++round) {
+            int pushes = 1 + round % 4;
+            for (int i = 0; i < pushes; ++i) {
+                uint64_t value = next_in;
+                if (ring.try_push(std::move(value))) ++next_in;
+            }
+            int pops = 1 + (round * 7) % 4;
+            for (int i = 0; i < pops; ++i) {
+                uint64_t value = 0;
+                if (!ring.try_pop(value)) break;
+                CHECK(value == next_out);
+                ++next_out;
+            }
+        }
+        uint64_t value = 0;
+        while (ring.try_pop(value)) {
+            CHECK(value == next_out);
+            ++next_out;
+        }
+        CHECK(next_out == next_in);
+        CHECK(next_in > 10000);
+    }
+
+    void test_pop_if() {
+        MpmcRing<int> ring(4);
+        CHECK(ring.try_push(1, 7));
+        CHECK(ring.try_push(2, 8));
+
+        // A refused head stays first; later values are not looked at
+        int value = 0;
+        CHECK(!ring.try_pop_if(value, [](uint64_t tag) { return tag != 7; }));
+        CHECK(ring.size_approx() == 2);
+        CHECK(ring.try_pop_if(value, [](uint64_t tag) { return tag == 7; }));
+        CHECK(value == 1);
+        CHECK(ring.try_pop_if(value, [](uint64_t tag) { return tag == 8; }));
+        CHECK(value == 2);
+        CHECK(!ring.try_pop_if(value, [](uint64_t) { return true; }));
+    }
+
+    void test_multi_producer_multi_consumer() {
+        constexpr int PRODUCERS = 4;
+        constexpr int CONSUMERS = 4;
+        constexpr uint64_t PER_PRODUCER = 50000;
+        constexpr uint64_t TOTAL = PRODUCERS * PER_PRODUCER;
+
+        // Small ring: producers hit "full" and consumers hit "empty" constantly
+        MpmcRing<uint64_t> ring(8);
+        std::vector<std::atomic<uint8_t>> seen(TOTAL);
+        for (auto& s : seen) s.store(0, std::memory_order_relaxed);
+        std::atomic<uint64_t> consumed{0};
+        std::atomic<int> out_of_order{0};
+
+        std::vector<std::thread> threads;
+        for (int p = 0; p < PRODUCERS; ++p) {
+            threads.emplace_back([&, p] {
+                for (uint64_t i = 0; i < PER_PRODUCER; ++i) {
+                    // Value encodes producer and sequence number
+                    uint64_t value = static_cast<uint64_t>(p) * PER_PRODUCER + i;
+                    while (!ring.try_push(std::move(value))) std::this_thread::yield();
+                }
+            });
+        }
+        for (int c = 0; c < CONSUMERS; ++c) {
+            threads.emplace_back([&] {
+                // Each producer's values reach any one consumer in push order
+                uint64_t last[PRODUCERS];
+                for (auto& l : last) l = UINT64_MAX;
+                while (consumed.load() < TOTAL) {
+                    uint64_t value = 0;
+                    if (!ring.try_pop(value)) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    int producer = static_cast<int>(value / PER_PRODUCER);
+                    uint64_t sequence = value % PER_PRODUCER;
+                    if (last[producer] != UINT64_MAX && sequence <= last[producer]) ++out_of_order;
+                    last[producer] = sequence;
+                    seen[value].fetch_add(1);
+                    consumed.fetch_add(1);
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+
+        CHECK(consumed.load() == TOTAL);
+        CHECK(out_of_order.load() == 0);
+        uint64_t duplicates = 0;
+        uint64_t missing = 0;
+        for (auto& s : seen) {
+            if (s.load() == 0) ++missing;
+            if (s.load() > 1) ++duplicates;
+        }
+        CHECK(missing == 0);
+        CHECK(duplicates == 0);
+
+        // Exhausted: nothing left behind, and the ring is reusable
+        uint64_t value = 0;
+        CHECK(!ring.try_pop(value));
+        CHECK(ring.size_approx() == 0);
+        CHECK(ring.try_push(uint64_t(42)));
+        CHECK(ring.try_pop(value) && value == 42);
+    }
+
+} // anonymous namespace
+
+int main() {
+    test_capacity_rounding();
+    test_full_and_empty();
+    test_wrap_around();
+    test_pop_if();
+    test_multi_producer_multi_consumer();
+    return planter_test::finish("mpmc_ring_test");
+}
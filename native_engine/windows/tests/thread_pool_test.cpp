@@ -0,0 +1,145 @@
+/**
+ * @file thread_pool_test.cpp
+ * @brief Planter Pressure - TilePool Work-Stealing Tests
+ */
+
+#include "check.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using planter::TilePool;
+
+namespace {
+
+    struct Coverage {
+        int begin;
+        int end;
+        int grain;
+        std::vector<std::atomic<int>> hits;
+        std::atomic<int> bad_chunks{0};
+        std::mutex mutex;
+        std::set<std::thread::id> threads;
+
+        Coverage(int b, int e, int g) : begin(b), end(e), grain(g), hits(e - b) {
+            for (auto& h : hits) h.store(0);
+        }
+
+        void run(std::chrono::microseconds per_chunk = std::chrono::microseconds(200)) {
+            TilePool::instance().parallel_for(begin, end, grain, [&](int lo, int hi) {
+                // Chunks start on a grain boundary and are full except the last
+                if ((lo - begin) % grain != 0 || hi != std::min(end, lo + grain)) ++bad_chunks;
+                for (int i = lo; i < hi; ++i) hits[i - begin].fetch_add(1);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    threads.insert(std::this_thread::get_id());
+                }
+                // Long enough that helpers wake up and steal before the caller is done
+                std::this_thread::sleep_for(per_chunk);
+            });
+        }
+
+        bool exactly_once() const {
+            for (const auto& h : hits) {
+                if (h.load() != 1) return false;
+            }
+            return true;
+        }
+    };
+
+    void test_steals_with_helpers() {
+        TilePool& pool = TilePool::instance();
+        pool.set_max_helpers(3);
+
+        uint64_t steals = pool.steal_count();
+        Coverage cover(5, 1005, 7);   // odd offset and a partial last chunk
+        cover.run();
+
+        CHECK(pool.thread_count() == 4);
+        CHECK(cover.exactly_once());
+        CHECK(cover.bad_chunks.load() == 0);
+        CHECK(pool.steal_count() > steals);
+        CHECK(cover.threads.size() > 1);
+        CHECK(cover.threads.size() <= 4);
+    }
+
+    void test_concurrent_callers() {
+        TilePool& pool = TilePool::instance();
+        pool.set_max_helpers(3);
+
+        // Several jobs split tiles at once; each must see all of its own
+        std::vector<std::unique_ptr<Coverage>> covers;
+        for (int i = 0; i < 4; ++i) {
+            covers.emplace_back(new Coverage(0, 300 + i * 50, 3 + i));
+        }
+        uint64_t steals = pool.steal_count();
+        std::vector<std::thread> callers;
+        for (auto& cover : covers) {
+            callers.emplace_back([&cover] { cover->run(std::chrono::microseconds(100)); });
+        }
+        for (auto& t : callers) t.join();
+
+        for (auto& cover : covers) {
+            CHECK(cover->exactly_once());
+            CHECK(cover->bad_chunks.load() == 0);
+        }
+        CHECK(pool.steal_count() > steals);
+    }
+
+    void test_resize() {
+        TilePool& pool = TilePool::instance();
+
+        // Shrinking parks helpers; the rest still finish every tile
+        pool.set_max_helpers(1);
+        CHECK(pool.thread_count() == 2);
+        Coverage shrunk(0, 400, 4);
+        shrunk.run();
+        CHECK(shrunk.exactly_once());
+        CHECK(shrunk.threads.size() <= 2);
+
+        // No helpers: the caller runs everything and nothing is stolen
+        pool.set_max_helpers(0);
+        uint64_t steals = pool.steal_count();
+        Coverage alone(0, 100, 2);
+        alone.run(std::chrono::microseconds(50));
+        CHECK(alone.exactly_once());
+        CHECK(alone.threads.size() == 1);
+        CHECK(pool.steal_count() == steals);
+
+        // Growing again reuses parked workers and starts new ones
+        pool.set_max_helpers(3);
+        steals = pool.steal_count();
+        Coverage regrown(0, 800, 8);
+        regrown.run();
+        CHECK(pool.thread_count() == 4);
+        CHECK(regrown.exactly_once());
+        CHECK(pool.steal_count() > steals);
+    }
+
+    void test_restart_after_shutdown() {
+        TilePool& pool = TilePool::instance();
+        pool.shutdown();
+
+        Coverage cover(0, 200, 5);
+        cover.run();
+        CHECK(cover.exactly_once());
+        CHECK(pool.thread_count() == 4);   // the helper count survives a restart
+        pool.shutdown();
+    }
+
+} // anonymous namespace
+
+int main() {
+    test_steals_with_helpers();
+    test_concurrent_callers();
+    test_resize();
+    test_restart_after_shutdown();
+    return planter_test::finish("thread_pool_test");
+}
@@ -0,0 +1,384 @@
+/**
+ * @file thread_pool.cpp
+ * @brief Planter Pressure - Tile Thread Pool for Native Kernels
+ */
+
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace planter {
+
+namespace {
+
+    // Deques for workers plus concurrent callers (job workers, isolates)
+    constexpr int MAX_SLOTS = 64;
+
+    // Leaves half the deques to callers
+    constexpr int MAX_HELPERS = MAX_SLOTS / 2;
+
+    // Failed scans over all deques before a worker goes to sleep
+    constexpr int IDLE_SCANS = 2;
+
+    /**
+     * One parallel_for call. Lives on the caller's stack: `done` is set
+     * under the mutex by whoever runs the last chunk, so the caller can't
+     * return while that thread still touches the state.
+     */
+    struct ForState {
+        const std::function<void(int, int)>* fn = nullptr;
+        int begin = 0;
+        int end = 0;
+        int grain = 1;
+        std::atomic<int> remaining{0};    // chunks not yet run
+
+        std::mutex mutex;
+        std::condition_variable done_cv;
+        bool done = false;
+
+        void complete(int chunks) {
+            if (remaining.fetch_sub(chunks, std::memory_order_acq_rel) != chunks) return;
+            std::lock_guard<std::mutex> lock(mutex);
+            done = true;
+            done_cv.notify_all();
+        }
+
+        void wait() {
+            std::unique_lock<std::mutex> lock(mutex);
+            done_cv.wait(lock, [this] { return done; });
+        }
+    };
+
+} // anonymous namespace
+
+// Chunks [lo, hi) of one parallel_for
+struct TileTask {
+    ForState* state = nullptr;
+    int lo = 0;
+    int hi = 0;
+};
+
+// =============================================================================
+// WorkDeque (Chase-Lev; fixed capacity, push fails when full)
+// =============================================================================
+
+class WorkDeque {
+public:
+    static constexpr int64_t CAPACITY = 128;
+
+    // Owner only
+    bool push(const TileTask& task) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        if (b - t >= CAPACITY) return false;
+        store(b, task);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Owner only: newest task (LIFO keeps the owner's working set hot)
+    bool take(TileTask& task) {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        load(b, task);
+        if (t == b) {
+            // Last task: race thieves for it
+            bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // Any thread: oldest task, i.e. the largest remaining piece
+    bool steal(TileTask& task) {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) return false;
+
+        load(t, task);
+        return top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                            std::memory_order_relaxed);
+    }
+
+private:
+    // Fields are atomics so a thief reading a slot never races the owner
+    struct Slot {
+        std::atomic<ForState*> state{nullptr};
+        std::atomic<uint64_t> range{0};
+    };
+
+    void store(int64_t index, const TileTask& task) {
+        Slot& slot = slots_[index & (CAPACITY - 1)];
+        slot.state.store(task.state, std::memory_order_relaxed);
+        slot.range.store((static_cast<uint64_t>(static_cast<uint32_t>(task.lo)) << 32) |
+                         static_cast<uint32_t>(task.hi), std::memory_order_relaxed);
+    }
+
+    void load(int64_t index, TileTask& task) const {
+        const Slot& slot = slots_[index & (CAPACITY - 1)];
+        task.state = slot.state.load(std::memory_order_relaxed);
+        uint64_t range = slot.range.load(std::memory_order_relaxed);
+        task.lo = static_cast<int>(range >> 32);
+        task.hi = static_cast<int>(range & 0xffffffffu);
+    }
+
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    Slot slots_[CAPACITY];
+};
+
+// =============================================================================
+// Per-thread deque ownership
+// =============================================================================
+
+// Returns the thread's deque to the pool when the thread exits
+struct SlotHolder {
+    int slot = -1;
+
+    ~SlotHolder() {
+        if (slot >= 0) TilePool::instance().release_slot(slot);
+    }
+};
+
+namespace {
+
+    thread_local SlotHolder t_slot;
+
+} // anonymous namespace
+
+int TilePool::own_slot() {
+    if (t_slot.slot >= 0) return t_slot.slot;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!free_slots_.empty()) {
+        t_slot.slot = free_slots_.back();
+        free_slots_.pop_back();
+    } else if (slot_count_.load(std::memory_order_relaxed) < MAX_SLOTS) {
+        t_slot.slot = slot_count_.load(std::memory_order_relaxed);
+        slot_count_.store(t_slot.slot + 1, std::memory_order_release);
+    }
+    return t_slot.slot;
+}
+
+void TilePool::release_slot(int slot) {
+    // Only ever called with an empty deque: callers wait for their own tasks
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_slots_.push_back(slot);
+}
+
+// =============================================================================
+// TilePool
+// =============================================================================
+
+TilePool& TilePool::instance() {
+    static TilePool pool;
+    return pool;
+}
+
+TilePool::TilePool() : deques_(new WorkDeque[MAX_SLOTS]) {
+}
+
+TilePool::~TilePool() {
+    shutdown();
+}
+
+int TilePool::thread_count() const {
+    return helpers_.load(std::memory_order_relaxed) + 1;
+}
+
+uint64_t TilePool::steal_count() const {
+    return steals_.load(std::memory_order_relaxed);
+}
+
+void TilePool::spawn_locked(int count) {
+    while (static_cast<int>(workers_.size()) < count) {
+        workers_.emplace_back(&TilePool::worker_loop, this, static_cast<int>(workers_.size()));
+    }
+}
+
+void TilePool::start_locked() {
+    unsigned hw = std::thread::hardware_concurrency();
+    int helpers = helper_target_ >= 0 ? helper_target_ : hw > 1 ? static_cast<int>(hw) - 1 : 0;
+    helpers = std::min(helpers, MAX_HELPERS);
+
+    stopping_ = false;
+    helpers_.store(helpers, std::memory_order_relaxed);
+    spawn_locked(helpers);
+    running_.store(true, std::memory_order_release);
+}
+
+void TilePool::set_max_helpers(int helpers) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    helper_target_ = std::max(0, std::min(helpers, MAX_HELPERS));
+    if (!running_.load(std::memory_order_relaxed)) return;
+
+    // Parked workers are reused before new threads are started
+    helpers_.store(helper_target_, std::memory_order_release);
+    spawn_locked(helper_target_);
+    park_cv_.notify_all();
+}
+
+void TilePool::notify_work() {
+    // Pairs with the sleeper's increment-then-check in worker_loop
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cv_.notify_one();
+    }
+}
+
+bool TilePool::find_task(int slot, TileTask& task) {
+    if (deques_[slot].take(task)) return true;
+
+    int count = slot_count_.load(std::memory_order_acquire);
+    for (int i = 1; i < count; ++i) {
+        int victim = (slot + i) % count;
+        if (deques_[victim].steal(task)) {
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TilePool::run(int slot, const TileTask& task) {
+    ForState* state = task.state;
+    int lo = task.lo;
+    int hi = task.hi;
+
+    // Leave the upper halves for thieves, keeping one chunk to run now
+    while (hi - lo > 1) {
+        int mid = lo + (hi - lo) / 2;
+        if (!deques_[slot].push({state, mid, hi})) break;
+        notify_work();
+        hi = mid;
+    }
+
+    for (int chunk = lo; chunk < hi; ++chunk) {
+        int chunk_begin = state->begin + chunk * state->grain;
+        (*state->fn)(chunk_begin, std::min(state->end, chunk_begin + state->grain));
+    }
+    state->complete(hi - lo);
+}
+
+void TilePool::worker_loop(int index) {
+    int slot = own_slot();
+    if (slot < 0) return;
+
+    int idle_scans = 0;
+    for (;;) {
+        if (index >= helpers_.load(std::memory_order_acquire)) {
+            // Surplus after a shrink: finish what we split off, then park
+            TileTask task;
+            if (deques_[slot].take(task)) {
+                run(slot, task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            park_cv_.wait(lock, [&] {
+                return stopping_ || index < helpers_.load(std::memory_order_relaxed);
+            });
+            if (stopping_) return;
+            continue;
+        }
+
+        uint64_t seen = epoch_.load(std::memory_order_seq_cst);
+        TileTask task;
+        if (find_task(slot, task)) {
+            run(slot, task);
+            idle_scans = 0;
+            continue;
+        }
+        if (++idle_scans < IDLE_SCANS) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stopping_) return;
+        sleeping_.fetch_add(1, std::memory_order_seq_cst);
+        cv_.wait(lock, [&] {
+            return stopping_ || epoch_.load(std::memory_order_seq_cst) != seen;
+        });
+        sleeping_.fetch_sub(1, std::memory_order_seq_cst);
+        idle_scans = 0;
+    }
+}
+
+void TilePool::parallel_for(int begin, int end, int grain,
+                            const std::function<void(int, int)>& fn) {
+    if (end <= begin) return;
+    grain = std::max(1, grain);
+
+    int chunk_count = (end - begin + grain - 1) / grain;
+    if (chunk_count == 1) {
+        fn(begin, end);
+        return;
+    }
+
+    if (!running_.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (workers_.empty()) {
+            start_locked();
+        }
+    }
+
+    // Nobody to share with: plain loop, no deque traffic
+    int slot = own_slot();
+    if (slot < 0 || helpers_.load(std::memory_order_relaxed) == 0) {
+        for (int lo = begin; lo < end; lo += grain) {
+            fn(lo, std::min(end, lo + grain));
+        }
+        return;
+    }
+
+    ForState state;
+    state.fn = &fn;
+    state.begin = begin;
+    state.end = end;
+    state.grain = grain;
+    state.remaining.store(chunk_count, std::memory_order_relaxed);
+
+    // Work through our own deque; anything stolen from it is finished by
+    // the thief. Callers never steal, so they only wait on their own tiles
+    // (and on tiles of an enclosing call, when nested inside a worker).
+    run(slot, {&state, 0, chunk_count});
+    TileTask task;
+    while (state.remaining.load(std::memory_order_acquire) > 0 && deques_[slot].take(task)) {
+        run(slot, task);
+    }
+    state.wait();
+}
+
+void TilePool::shutdown() {
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        running_.store(false, std::memory_order_release);
+        helpers_.store(0, std::memory_order_relaxed);
+        workers.swap(workers_);
+    }
+    cv_.notify_all();
+    park_cv_.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = false;
+}
+
+} // namespace planter
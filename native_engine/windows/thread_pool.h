@@ -0,0 +1,99 @@
+/**
+ * @file thread_pool.h
+ * @brief Planter Pressure - Tile Thread Pool for Native Kernels
+ *
+ * OPTIMIZATIONS:
+ * - Persistent workers (no thread creation per stage)
+ * - Caller thread participates, so small ranges run inline
+ * - Safe to call concurrently from several jobs
+ * - Work stealing: every participating thread owns a Chase-Lev deque;
+ *   ranges split in halves, owners work depth-first from the bottom and
+ *   idle workers steal the largest pieces from the top, so tiles from a
+ *   huge image and several small ones share all cores until the last tile
+ * - Helper count follows the CPUs the process may use and can change at
+ *   run time: extra workers are started, surplus ones park
+ */
+
+#ifndef PLANTER_PRESSURE_THREAD_POOL_H
+#define PLANTER_PRESSURE_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace planter {
+
+class WorkDeque;
+struct TileTask;
+struct SlotHolder;
+
+class TilePool {
+public:
+    static TilePool& instance();
+
+    /**
+     * Run fn(chunk_begin, chunk_end) over [begin, end) in chunks of `grain`.
+     * Blocks until every chunk has finished.
+     */
+    void parallel_for(int begin, int end, int grain,
+                      const std::function<void(int, int)>& fn);
+
+    int thread_count() const;
+
+    /**
+     * Helper threads besides the caller (default: hardware threads - 1).
+     * Takes effect immediately if the pool is running.
+     */
+    void set_max_helpers(int helpers);
+
+    // Tasks taken from another thread's deque since start-up
+    uint64_t steal_count() const;
+
+    // Join all workers; the next parallel_for restarts them
+    void shutdown();
+
+private:
+    friend struct SlotHolder;
+
+    TilePool();
+    ~TilePool();
+    TilePool(const TilePool&) = delete;
+    TilePool& operator=(const TilePool&) = delete;
+
+    void start_locked();
+    void spawn_locked(int count);
+    void worker_loop(int index);
+
+    // Deque of the calling thread, claimed on first use; -1 if all are taken
+    int own_slot();
+    void release_slot(int slot);
+
+    bool find_task(int slot, TileTask& task);
+    void run(int slot, const TileTask& task);
+    void notify_work();
+
+    std::unique_ptr<WorkDeque[]> deques_;
+    std::atomic<int> slot_count_{0};     // high-water mark of claimed slots
+    std::vector<int> free_slots_;        // guarded by mutex_
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable park_cv_;    // workers beyond helpers_
+    int helper_target_ = -1;             // set_max_helpers(); -1 = hardware
+    std::atomic<uint64_t> epoch_{0};     // bumped whenever work is published
+    std::atomic<int> sleeping_{0};
+    std::atomic<bool> running_{false};
+    std::atomic<int> helpers_{0};        // active workers
+    std::atomic<uint64_t> steals_{0};
+    std::vector<std::thread> workers_;
+    bool stopping_ = false;
+};
+
+} // namespace planter
+
+#endif
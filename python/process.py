@@ -8,13 +8,24 @@ OPTIMIZATIONS:
 3. No unnecessary copies
 4. Garbage collection hints
 5. Path-only I/O (no Base64)
+6. Filter stages run natively in pooled, ping-pong frame buffers
+7. PNG/JPEG/WebP decode natively into pooled frames (JPEG previews via scaled IDCT)
+8. Palette lookup and alpha-over-white flatten fused into decode, no temporaries
+   (Pillow-decoded L/LA/P/RGBA images too, loaded into the frame band by band)
+9. Python plug-in hooks edit pooled frames in place through the buffer protocol
+10. Native plug-in ops run on the tile pool in the same ping-pong frames
+11. Variants share one decoded source frame and render in parallel
+12. Batch jobs split into decode / filter / encode stages the engine pipelines
 """
 
 import os
+import re
 import sys
 import gc
 import json
 import tempfile
+import time
+from concurrent.futures import ThreadPoolExecutor, wait
 from datetime import datetime
 from pathlib import Path
 
@@ -31,13 +42,121 @@ for p in SITE_PACKAGES:
 # =============================================================================
 
 try:
-    from PIL import Image, ImageFilter, ImageEnhance, ImageDraw, ImageFont
+    from PIL import Image, ImageFilter, ImageEnhance, ImageDraw, ImageFont, ImageStat
     PIL_AVAILABLE = True
     PIL_ERROR = None
 except ImportError as e:
     PIL_AVAILABLE = False
     PIL_ERROR = str(e)
 
+# Built into the engine DLL; absent when run standalone from the command line
+try:
+    import planter_native
+    NATIVE_AVAILABLE = True
+except ImportError:
+    planter_native = None
+    NATIVE_AVAILABLE = False
+
+# Indices into STAGES (and EngineResult.stage_ms)
+STAGE_DECODE, STAGE_FILTER, STAGE_OVERLAY, STAGE_ENCODE = range(4)
+
+# Deep-zoom pyramid geometry
+PYRAMID_TILE = 256
+
+# Downscaled sibling names become file suffixes
+SIBLING_NAME = re.compile(r'^[A-Za-z0-9_-]+$')
+
+# Each variant holds two pooled frames while it renders
+MAX_VARIANTS = 16
+
+# Modes a pooled frame loads directly, and the rows copied per band
+FRAME_MODES = ('RGB', 'RGBA', 'L', 'LA', 'P')
+LOAD_BAND = 64
+
+# Pillow releases the GIL while encoding, so tiles compress in parallel
+_tile_executor = None
+
+
+def _tile_pool():
+    global _tile_executor
+    if _tile_executor is None:
+        _tile_executor = ThreadPoolExecutor(max_workers=min(8, os.cpu_count() or 1),
+                                            thread_name_prefix="planter-tile")
+    return _tile_executor
+
+# Context an ROI needs around it: one pixel per 3x3 pass (sharpen, edge enhance, smooth)
+ROI_HALO = 3
+
+# Longest side of the reduced copy an ROI's contrast mean is taken from
+MEAN_SAMPLE_DIM = 512
+
+
+# Python filter hooks, keyed by stage; see register_hook
+HOOK_STAGES = ('pre_filter', 'post_filter')
+_hooks = {stage: [] for stage in HOOK_STAGES}
+
+
+def register_hook(stage, fn):
+    """
+    Run fn(frame, context) on every image processed by the engine.
+
+    pre_filter hooks see the decoded pixels, post_filter hooks the output of
+    the native filter chain. frame is the pooled engine buffer itself:
+    numpy.asarray(frame) (or memoryview(frame)) is a writable
+    (height, width, 4) uint8 RGBX view with the row stride, so edits
+    happen in place with no copy. Views must not outlive the call.
+    context is {"stage": ..., "input_path": ...}.
+    """
+    if stage not in _hooks:
+        raise ValueError("Unknown hook stage: {}".format(stage))
+    _hooks[stage].append(fn)
+
+
+def load_plugins(directory):
+    """Import every *.py in directory, in name order; returns their names."""
+    import importlib.util
+
+    loaded = []
+    for name in sorted(os.listdir(directory)):
+        stem, ext = os.path.splitext(name)
+        if ext != '.py':
+            continue
+        spec = importlib.util.spec_from_file_location(
+            "planter_plugin_" + stem, os.path.join(directory, name))
+        module = importlib.util.module_from_spec(spec)
+        sys.modules[spec.name] = module
+        spec.loader.exec_module(module)
+        loaded.append(stem)
+    return loaded
+
+
+def _run_hooks(stage, frame, context):
+    for fn in _hooks[stage]:
+        fn(frame, dict(context or {}, stage=stage))
+
+
+def _stage_done(stage):
+    """Report a finished stage to the engine's progress sink, if any."""
+    if NATIVE_AVAILABLE:
+        planter_native.progress(stage)
+
+
+def _check_cancelled():
+    """Raise if the engine call running on this thread was cancelled."""
+    if NATIVE_AVAILABLE and planter_native.cancelled():
+        raise RuntimeError("Cancelled")
+
+
+def _submit_in_call(fn, *args):
+    """
+    Run fn(*args) on the tile pool as part of the calling engine call:
+    the progress sink and cancel flag are per thread, so carry them over.
+    """
+    if NATIVE_AVAILABLE:
+        return _tile_pool().submit(planter_native.run_in_call, planter_native.current_call(),
+                                   fn, *args)
+    return _tile_pool().submit(fn, *args)
+
 
 class ImageProcessor:
     """Memory-efficient image processor."""
@@ -88,7 +207,7 @@ class ImageProcessor:
 
         return True, ""
 
-    def _generate_output_path(self, input_path, output_dir=None):
+    def _generate_output_path(self, input_path, output_dir=None, prefix="processed"):
         if output_dir is None:
             output_dir = tempfile.gettempdir()
 
@@ -96,12 +215,442 @@ class ImageProcessor:
 
         ts = datetime.now().strftime("%Y%m%d_%H%M%S_%f")
         name = Path(input_path).stem
-        return os.path.join(output_dir, "processed_{}_{}.png".format(name, ts))
+        return os.path.join(output_dir, "{}_{}_{}.png".format(prefix, name, ts))
+
+    def _preview_proxy(self, img, max_dim):
+        """
+        Shrink to fit max_dim before any per-pixel work. JPEG decodes at
+        1/2..1/8 scale in the DCT domain (draft); the rest reduce in
+        integer steps before the final filter.
+        """
+        if max(img.size) <= max_dim:
+            return img
+        img.draft('RGB', (max_dim, max_dim))
+        img.thumbnail((max_dim, max_dim), Image.BILINEAR, reducing_gap=2.0)
+        return img
+
+    def _decode_native(self, input_path, preview_max_dim):
+        """
+        Decode into a pooled frame with the engine's codecs, skipping
+        Pillow entirely. Previews shrink in the decoder (JPEG scaled IDCT)
+        and then resample to fit. Returns (frame, info) or None.
+        """
+        decoded = planter_native.decode(input_path, preview_max_dim or 0)
+        if decoded is None:
+            return None
+        frame, info = decoded
+        if preview_max_dim and max(frame.width, frame.height) > preview_max_dim:
+            try:
+                proxy = planter_native.resize(
+                    frame, *self._fit((frame.width, frame.height), preview_max_dim))
+            finally:
+                frame.release()
+            frame = proxy
+        return frame, info
+
+    def _roi_box(self, roi, size):
+        """Clamp [x, y, w, h] to the image; returns (left, top, right, bottom)."""
+        x, y, w, h = roi
+        box = (max(0, x), max(0, y), min(size[0], x + w), min(size[1], y + h))
+        if box[2] <= box[0] or box[3] <= box[1]:
+            raise ValueError("roi {} lies outside the {}x{} image".format(list(roi), *size))
+        return box
+
+    def _contrast_mean(self, img):
+        """
+        Mean luma of the whole of img (alpha flattened onto white), from a
+        reduced copy. The sharpen and edge-enhance kernels sum to one, so
+        this stands in for the mean the full-frame chain takes before
+        contrast, and an ROI gets the same contrast as the full frame.
+        """
+        sample = img.convert('RGB') if img.mode == 'P' else img
+        factor = max(1, max(img.size) // MEAN_SAMPLE_DIM)
+        if factor > 1:
+            sample = sample.reduce(factor)
+        if sample.mode in ('RGBA', 'LA'):
+            flat = Image.new('RGB', sample.size, (255, 255, 255))
+            flat.paste(sample, mask=sample.getchannel('A'))
+            sample = flat
+        gray = sample.convert('L')
+        mean = int(ImageStat.Stat(gray).mean[0] + 0.5)
+        gray.close()
+        if sample is not img:
+            sample.close()
+        return mean
+
+    def _decode_region(self, img, box):
+        """
+        Decode img and crop it to box straight away, so only the region
+        outlives the decode. Pillow has no public way to stop a decoder
+        early, so the whole image is decoded once. Consumes img.
+        """
+        region = img.crop(box)
+        img.close()
+        return region
+
+    def _apply_filters(self, img, sharpness=1.5, contrast=1.2, context=None, ops=None, mean=None):
+        """
+        Sharpness -> edge enhance -> contrast -> smooth [-> ops]. Consumes img.
+        Contrast is relative to mean if given, else to img's own mean.
+        """
+        if NATIVE_AVAILABLE:
+            return self._apply_filters_native(img, sharpness, contrast, context, ops, mean)
+        return self._apply_filters_pillow(img, sharpness, contrast, mean)
+
+    def _apply_filters_native(self, img, sharpness, contrast, context=None, ops=None, mean=None):
+        """
+        Run all stages in two pooled engine frames that ping-pong,
+        so steady-state processing allocates no large blocks.
+        """
+        front = self._load_frame(img)
+        return self._enhance_frame(front, sharpness, contrast, context, ops, mean=mean)
+
+    def _load_frame(self, img):
+        """
+        Copy an RGB, RGBA, L, LA or P image into a pooled frame, band by
+        band; the frame expands grey and palette rows and flattens alpha
+        onto white as it loads, so no converted full-size copy is made.
+        Consumes img.
+        """
+        width, height = img.size
+        palette = bytes(img.getpalette() or ()) if img.mode == 'P' else None
+        frame = planter_native.acquire_frame(width, height)
+        try:
+            for top in range(0, height, LOAD_BAND):
+                band = img.crop((0, top, width, min(height, top + LOAD_BAND)))
+                if img.mode == 'RGB':
+                    frame.load(band.tobytes('raw', 'RGBX'), y=top)
+                else:
+                    frame.load(band.tobytes(), mode=img.mode, palette=palette, y=top)
+                band.close()
+        except BaseException:
+            frame.release()
+            raise
+        img.close()
+        return frame
+
+    def _enhance_frame(self, front, sharpness, contrast, context=None, ops=None, source=None,
+                       mean=None):
+        """
+        Filter chain and plug-in ops on a pooled frame (consumed), with
+        registered hooks either side; returns an RGB image.
+
+        With source, the chain reads that frame instead and front is only
+        scratch; source is left untouched (and its pre_filter hooks are
+        the caller's job), so several variants can share it.
+        """
+        width, height = front.width, front.height
+        try:
+            back = planter_native.acquire_frame(width, height)
+        except BaseException:
+            front.release()
+            raise
+        try:
+            if source is None:
+                _run_hooks('pre_filter', front, context)
+            result = planter_native.enhance(front, back, sharpness=sharpness, contrast=contrast,
+                                            src=source, mean=-1 if mean is None else mean)
+            for op in ops or ():
+                # Keep ping-ponging between the same two frames
+                target = back if result is front else front
+                params = {k: v for k, v in op.items() if k != "op"}
+                planter_native.run_op(op["op"], result, target, params)
+                result = target
+            _run_hooks('post_filter', result, context)
+
+            # Map the pooled frame (no copy) and convert once for drawing/encoding
+            mapped = Image.frombuffer('RGBX', (width, height), result,
+                                      'raw', 'RGBX', result.stride, 1)
+            out = mapped.convert('RGB')
+            mapped.close()
+            del mapped
+            return out
+        finally:
+            front.release()
+            back.release()
+
+    def _apply_filters_pillow(self, img, sharpness, contrast, mean=None):
+        # Sharpness
+        enhancer = ImageEnhance.Sharpness(img)
+        new_img = enhancer.enhance(sharpness)
+        img.close()
+        img = new_img
+
+        # Edge enhance
+        new_img = img.filter(ImageFilter.EDGE_ENHANCE)
+        img.close()
+        img = new_img
+
+        # Contrast
+        if mean is None:
+            new_img = ImageEnhance.Contrast(img).enhance(contrast)
+        else:
+            # ImageEnhance.Contrast's blend, against the given mean
+            degenerate = Image.new('L', img.size, mean).convert(img.mode)
+            new_img = Image.blend(degenerate, img, contrast)
+            degenerate.close()
+        img.close()
+        img = new_img
+
+        # Smooth
+        new_img = img.filter(ImageFilter.SMOOTH)
+        img.close()
+        return new_img
+
+    def _draw_overlay(self, img, origin=(0, 0), canvas_size=None):
+        """
+        Draw the title centred on a canvas_size image (default: img itself).
+        img covers the canvas from origin, so a region gets its part of the
+        full-frame overlay; drawing clips to img.
+        """
+        draw = ImageDraw.Draw(img)
+        width, height = canvas_size or img.size
+
+        # TITLE size font (10% of image height - doubled from before)
+        font_size = max(24, min(300, int(height * 0.10)))
+        font = self._get_font(font_size)
+
+        text = "PLANTER PRESSURE DEMO"
+        bbox = draw.textbbox((0, 0), text, font=font)
+        text_w = bbox[2] - bbox[0]
+        text_h = bbox[3] - bbox[1]
+
+        x = (width - text_w) // 2 - origin[0]
+        y = (height - text_h) // 2 - origin[1]
+
+        # Shadow (black, thicker for title)
+        shadow_off = max(3, font_size // 20)
+        for ox in range(-shadow_off, shadow_off + 1):
+            for oy in range(-shadow_off, shadow_off + 1):
+                if ox != 0 or oy != 0:
+                    draw.text((x + ox, y + oy), text, font=font, fill=(0, 0, 0))
+
+        # Main text - RED color
+        draw.text((x, y), text, font=font, fill=(255, 0, 0))
+
+        del draw  # Release draw object
+
+    def _write_level_tiles(self, level_img, directory, tile_size):
+        """Queue every tile of one level; returns the futures."""
+        os.makedirs(directory, exist_ok=True)
+        width, height = level_img.size
+
+        def save(box, path):
+            tile = level_img.crop(box)
+            rgb = tile.convert('RGB') if tile.mode != 'RGB' else tile
+            rgb.save(path, format='PNG')
+            rgb.close()
+            tile.close()
+
+        return [_tile_pool().submit(save, (x, y, min(x + tile_size, width), min(y + tile_size, height)),
+                                    os.path.join(directory, "{}_{}.png".format(x // tile_size, y // tile_size)))
+                for y in range(0, height, tile_size)
+                for x in range(0, width, tile_size)]
+
+    def _write_pyramid(self, img, output_path, tile_size=PYRAMID_TILE):
+        """
+        Write a deep-zoom pyramid next to output_path:
+        <stem>_tiles/<level>/<col>_<row>.png, level 0 at full resolution,
+        halving until one tile covers the image, plus pyramid.json.
+        Tiles of level N encode while level N + 1 is being reduced.
+        """
+        root = os.path.splitext(output_path)[0] + "_tiles"
+        levels = []
+        pending = []  # (tile futures, level image, source frame) still encoding
+        frame = self._to_frame(img) if NATIVE_AVAILABLE else None
+        level_img = img
+        try:
+            while True:
+                if frame is not None:
+                    level_img = Image.frombuffer('RGBX', (frame.width, frame.height), frame,
+                                                 'raw', 'RGBX', frame.stride, 1)
+                width, height = level_img.size
+                pending.append((self._write_level_tiles(
+                    level_img, os.path.join(root, str(len(levels))), tile_size), level_img, frame))
+                levels.append({"width": width, "height": height,
+                               "columns": -(-width // tile_size), "rows": -(-height // tile_size)})
+                if width <= tile_size and height <= tile_size:
+                    break
+
+                if frame is not None:
+                    frame = planter_native.reduce2x(frame)
+                else:
+                    level_img = level_img.reduce(2)
+        finally:
+            del level_img
+            self._drain_levels(pending, img)
+
+        with open(os.path.join(root, "pyramid.json"), "w") as f:
+            json.dump({"tile_size": tile_size, "format": "png", "levels": levels}, f)
+        return root
+
+    def _drain_levels(self, pending, img):
+        """Wait for each level's tiles, then unmap and release its source."""
+        error = None
+        while pending:
+            futures, level_img, frame = pending.pop(0)
+            for future in futures:
+                if error is None and future.exception() is not None:
+                    # Its traceback would pin the mapped level and block release()
+                    error = future.exception().with_traceback(None)
+            if level_img is not img:
+                level_img.close()
+            del level_img
+            if frame is not None:
+                frame.release()
+        if error is not None:
+            raise error
+
+    def _fit(self, size, max_dim):
+        """Size scaled down (never up) so the longer side is at most max_dim."""
+        scale = min(1.0, max_dim / max(size))
+        return max(1, round(size[0] * scale)), max(1, round(size[1] * scale))
+
+    def _save_png(self, img, path):
+        img.save(path, format='PNG')
+        img.close()
+
+    def _write_siblings(self, img, output_path, siblings):
+        """
+        Write a downscaled copy of img per {name: max_dim} as
+        <output stem>_<name>.png, all resampled from one in-memory frame
+        and encoded in parallel. A size the image already fits reuses
+        output_path. Returns {name: {"path", "width", "height"}}.
+        """
+        stem = os.path.splitext(output_path)[0]
+        written = {}
+        pending = []
+        frame = self._to_frame(img) if NATIVE_AVAILABLE else None
+        try:
+            for name, max_dim in siblings.items():
+                size = self._fit(img.size, max_dim)
+                path = output_path
+                if size != img.size:
+                    path = "{}_{}.png".format(stem, name)
+                    if frame is not None:
+                        small = planter_native.resize(frame, *size)
+                        mapped = Image.frombuffer('RGBX', size, small, 'raw', 'RGBX', small.stride, 1)
+                        resized = mapped.convert('RGB')
+                        mapped.close()
+                        del mapped
+                        small.release()
+                    else:
+                        resized = img.resize(size, Image.LANCZOS, reducing_gap=2.0)
+                    pending.append(_tile_pool().submit(self._save_png, resized, path))
+                written[name] = {"path": path, "width": size[0], "height": size[1]}
+        finally:
+            if frame is not None:
+                frame.release()
+            for future in pending:
+                future.result()
+        return written
+
+    def _render_variant(self, source, variant, input_path, output_dir, prefix, context):
+        """Filter, overlay and encode one variant of the shared source."""
+        t0 = time.perf_counter()
+        if isinstance(source, Image.Image):
+            img = self._apply_filters_pillow(source.copy(), variant["sharpness"],
+                                             variant["contrast"])
+        else:
+            front = planter_native.acquire_frame(source.width, source.height)
+            img = self._enhance_frame(front, variant["sharpness"], variant["contrast"],
+                                      dict(context, variant=variant["name"]), variant["ops"],
+                                      source=source)
+        try:
+            _check_cancelled()
+            t1 = time.perf_counter()
+            if variant["overlay"]:
+                self._draw_overlay(img)
+
+            t2 = time.perf_counter()
+            output_path = self._generate_output_path(
+                input_path, output_dir, "{}-{}".format(prefix, variant["name"]))
+            img.save(output_path, format='PNG', optimize=True)
+            t3 = time.perf_counter()
+
+            return {
+                "name": variant["name"],
+                "output_image_path": output_path,
+                "output_dimensions": list(img.size),
+                "output_size_bytes": os.path.getsize(output_path),
+                "timings_ms": {
+                    "filter": (t1 - t0) * 1000.0,
+                    "overlay": (t2 - t1) * 1000.0,
+                    "encode": (t3 - t2) * 1000.0,
+                },
+            }
+        finally:
+            img.close()
+
+    def _process_variants(self, source, variants, input_path, output_dir, prefix, context):
+        """
+        Render every variant from one decoded source in parallel on the
+        tile pool. source is a pooled frame (a Pillow image without the
+        engine), shared read-only and consumed; pre_filter hooks run on it
+        once. Returns the variant entries in request order.
+        """
+        futures = []
+        try:
+            if not isinstance(source, Image.Image):
+                _run_hooks('pre_filter', source, context)
+            for variant in variants:
+                futures.append(_submit_in_call(self._render_variant, source, variant,
+                                               input_path, output_dir, prefix, context))
+        finally:
+            # Nothing may still be reading the source when it goes back
+            wait(futures)
+            if isinstance(source, Image.Image):
+                source.close()
+            else:
+                source.release()
+        return [future.result() for future in futures]
+
+    def _normalize_mode(self, img):
+        """
+        Convert to RGB if needed; with the engine, RGBA, L, LA and P are
+        left as they are and converted while loaded into the filter
+        frame (alpha flattened onto white). Consumes img.
+        """
+        if img.mode in FRAME_MODES and NATIVE_AVAILABLE:
+            return img
+        if img.mode in ('RGBA', 'LA'):
+            new_img = Image.new('RGB', img.size, (255, 255, 255))
+            new_img.paste(img, mask=img.getchannel('A'))
+            img.close()  # Close original
+            return new_img
+        if img.mode != 'RGB':
+            new_img = img.convert('RGB')
+            img.close()
+            return new_img
+        return img
+
+    def _to_frame(self, img):
+        """Copy the finished image into a pooled RGBX frame the engine can hand out."""
+        frame = planter_native.acquire_frame(*img.size)
+        frame.load(img.tobytes('raw', 'RGBX'))
+        return frame
 
-    def process(self, input_path, output_dir=None):
+    def process(self, input_path, output_dir=None, sharpness=1.5, contrast=1.2, overlay=True,
+                keep_frame=False, encode=True, preview_max_dim=None, roi=None, pyramid=False,
+                siblings=None, ops=None, variants=None):
         """
         Process image with explicit memory management.
         Returns dict with status and output path.
+
+        keep_frame: also return the final pixels as a pooled frame ("frame" key)
+        encode: write the output file (skipping it requires keep_frame)
+        preview_max_dim: run on a proxy whose longer side is at most this
+        roi: [x, y, w, h]; process and write only this region. The chain
+             runs on the region plus ROI_HALO pixels (and each op's halo) so
+             its edges match the full-frame result; contrast is relative to
+             the whole image's mean (see _contrast_mean).
+        pyramid: also write a PYRAMID_TILE deep-zoom pyramid ("pyramid_path")
+        siblings: {name: max_dim}; also write downscaled copies ("siblings")
+        ops: [{"op": name, param: value, ...}]; native plug-in filters run
+             in order after the built-in chain
+        variants: [{"name", "sharpness", "contrast", "overlay", "ops"}];
+             decode once and write one output per variant ("variants"),
+             rendered in parallel. The top-level settings are unused.
         """
         if not PIL_AVAILABLE:
             return {
@@ -113,85 +662,155 @@ class ImageProcessor:
         if not valid:
             return {"status": "error", "error": err}
 
+        if keep_frame and not NATIVE_AVAILABLE:
+            return {"status": "error", "error": "Frame output requires the engine"}
+
+        if roi is not None and preview_max_dim:
+            return {"status": "error", "error": "roi cannot be combined with preview"}
+
+        if variants and (roi is not None or pyramid or siblings or keep_frame):
+            return {"status": "error",
+                    "error": "variants cannot be combined with roi, pyramid, siblings or frames"}
+
+        halo = ROI_HALO
+        requested = list(ops or ())
+        for variant in variants or ():
+            requested.extend(variant["ops"])
+        if requested:
+            available = planter_native.ops() if NATIVE_AVAILABLE else {}
+            for op in requested:
+                if op["op"] not in available:
+                    return {"status": "error", "error": "Unknown op: {}".format(op["op"])}
+            for op in ops or ():
+                halo += available[op["op"]]["halo"]
+
         img = None
+        timings = {}
         try:
             # Load image
-            img = Image.open(input_path)
-            original_size = img.size
-            original_mode = img.mode
-
-            # Convert to RGB if needed
-            if img.mode in ('RGBA', 'LA', 'P'):
-                bg = Image.new('RGB', img.size, (255, 255, 255))
-                if img.mode == 'RGBA':
-                    bg.paste(img, mask=img.split()[3])
-                elif img.mode == 'LA':
-                    bg.paste(img, mask=img.split()[1])
-                else:
-                    bg.paste(img)
-                img.close()  # Close original
-                img = bg
-            elif img.mode != 'RGB':
-                new_img = img.convert('RGB')
-                img.close()
-                img = new_img
+            t0 = time.perf_counter()
+            decoded = None
+            if NATIVE_AVAILABLE and roi is None:
+                decoded = self._decode_native(input_path, preview_max_dim)
 
-            # Apply filters (in-place where possible)
-            # Sharpness
-            enhancer = ImageEnhance.Sharpness(img)
-            new_img = enhancer.enhance(1.5)
-            img.close()
-            img = new_img
+            region = None
+            mean = None
+            if decoded is not None:
+                native_frame, info = decoded
+                original_size = (info["width"], info["height"])
+                original_mode = info["mode"]
+            else:
+                img = Image.open(input_path)
+                original_size = img.size
+                original_mode = img.mode
 
-            # Edge enhance
-            new_img = img.filter(ImageFilter.EDGE_ENHANCE)
-            img.close()
-            img = new_img
-
-            # Contrast
-            enhancer = ImageEnhance.Contrast(img)
-            new_img = enhancer.enhance(1.2)
-            img.close()
-            img = new_img
+                if preview_max_dim:
+                    img = self._preview_proxy(img, preview_max_dim)
 
-            # Smooth
-            new_img = img.filter(ImageFilter.SMOOTH)
-            img.close()
-            img = new_img
-
-            # Add text overlay
-            draw = ImageDraw.Draw(img)
-            width, height = img.size
+                if roi is not None:
+                    region = self._roi_box(roi, original_size)
+                    mean = self._contrast_mean(img)
+                    padded = (max(0, region[0] - halo), max(0, region[1] - halo),
+                              min(original_size[0], region[2] + halo),
+                              min(original_size[1], region[3] + halo))
+                    img = self._decode_region(img, padded)
 
-            # TITLE size font (10% of image height - doubled from before)
-            font_size = max(24, min(300, int(height * 0.10)))
-            font = self._get_font(font_size)
+                img = self._normalize_mode(img)
 
-            text = "PLANTER PRESSURE DEMO"
-            bbox = draw.textbbox((0, 0), text, font=font)
-            text_w = bbox[2] - bbox[0]
-            text_h = bbox[3] - bbox[1]
+            t1 = time.perf_counter()
+            _stage_done(STAGE_DECODE)
+            hook_context = {"input_path": input_path}
+            if variants:
+                if decoded is not None:
+                    source = native_frame
+                elif NATIVE_AVAILABLE:
+                    source = self._load_frame(img)
+                else:
+                    source = img
+                img = None
+                entries = self._process_variants(source, variants, input_path, output_dir,
+                                                 "preview" if preview_max_dim else "processed",
+                                                 hook_context)
+                t2 = time.perf_counter()
+                for stage in (STAGE_FILTER, STAGE_OVERLAY, STAGE_ENCODE):
+                    _stage_done(stage)
 
-            x = (width - text_w) // 2
-            y = (height - text_h) // 2
+                result = {
+                    "status": "success",
+                    "output_image_path": entries[0]["output_image_path"],
+                    "variants": entries,
+                    "metadata": {
+                        "input_path": input_path,
+                        "original_size": list(original_size),
+                        "original_mode": original_mode,
+                        "timings_ms": {
+                            "decode": (t1 - t0) * 1000.0,
+                            "variants": (t2 - t1) * 1000.0,
+                        },
+                        "processed_at": datetime.now().isoformat()
+                    }
+                }
+                if preview_max_dim:
+                    result["metadata"]["preview"] = {"max_dim": preview_max_dim}
+                return result
 
-            # Shadow (black, thicker for title)
-            shadow_off = max(3, font_size // 20)
-            for ox in range(-shadow_off, shadow_off + 1):
-                for oy in range(-shadow_off, shadow_off + 1):
-                    if ox != 0 or oy != 0:
-                        draw.text((x + ox, y + oy), text, font=font, fill=(0, 0, 0))
+            if decoded is not None:
+                img = self._enhance_frame(native_frame, sharpness, contrast, hook_context, ops)
+            else:
+                img = self._apply_filters(img, sharpness, contrast, hook_context, ops, mean)
 
-            # Main text - RED color
-            draw.text((x, y), text, font=font, fill=(255, 0, 0))
+            if region is not None:
+                # Drop the halo
+                inner = (region[0] - padded[0], region[1] - padded[1],
+                         region[2] - padded[0], region[3] - padded[1])
+                new_img = img.crop(inner)
+                img.close()
+                img = new_img
 
-            del draw  # Release draw object
+            # Add text overlay
+            t2 = time.perf_counter()
+            _stage_done(STAGE_FILTER)
+            if overlay:
+                if region is not None:
+                    self._draw_overlay(img, region[:2], original_size)
+                else:
+                    self._draw_overlay(img)
 
             # Save output
-            output_path = self._generate_output_path(input_path, output_dir)
-            img.save(output_path, format='PNG', optimize=True)
+            t3 = time.perf_counter()
+            _stage_done(STAGE_OVERLAY)
+            frame = self._to_frame(img) if keep_frame else None
+
+            output_path = ""
+            output_size = 0
+            pyramid_path = None
+            sibling_paths = None
+            if encode or not keep_frame:
+                prefix = "preview" if preview_max_dim else "region" if region else "processed"
+                output_path = self._generate_output_path(input_path, output_dir, prefix)
+                if pyramid or siblings:
+                    # Full image, tiles and siblings encode side by side
+                    saved = _tile_pool().submit(img.save, output_path, format='PNG', optimize=True)
+                    try:
+                        if pyramid:
+                            pyramid_path = self._write_pyramid(img, output_path)
+                        if siblings:
+                            sibling_paths = self._write_siblings(img, output_path, siblings)
+                    finally:
+                        saved.result()
+                else:
+                    img.save(output_path, format='PNG', optimize=True)
+                output_size = os.path.getsize(output_path)
+            t4 = time.perf_counter()
+            _stage_done(STAGE_ENCODE)
 
-            output_size = os.path.getsize(output_path)
+            timings = {
+                "decode": (t1 - t0) * 1000.0,
+                "filter": (t2 - t1) * 1000.0,
+                "overlay": (t3 - t2) * 1000.0,
+                "encode": (t4 - t3) * 1000.0,
+            }
+            output_dims = img.size
 
             # Close image before returning
             img.close()
@@ -200,17 +819,31 @@ class ImageProcessor:
             # Force garbage collection
             gc.collect()
 
-            return {
+            result = {
                 "status": "success",
                 "output_image_path": output_path,
                 "metadata": {
                     "input_path": input_path,
                     "original_size": list(original_size),
                     "original_mode": original_mode,
+                    "output_dimensions": list(output_dims),
                     "output_size_bytes": output_size,
+                    "timings_ms": timings,
                     "processed_at": datetime.now().isoformat()
                 }
             }
+            if pyramid_path:
+                result["pyramid_path"] = pyramid_path
+            if sibling_paths:
+                result["siblings"] = sibling_paths
+            if preview_max_dim:
+                result["metadata"]["preview"] = {"max_dim": preview_max_dim}
+            if region is not None:
+                result["metadata"]["roi"] = [region[0], region[1],
+                                             region[2] - region[0], region[3] - region[1]]
+            if frame is not None:
+                result["frame"] = frame
+            return result
 
         except Exception as e:
             return {
@@ -228,6 +861,72 @@ class ImageProcessor:
             gc.collect()
 
 
+    # =========================================================================
+    # Pipeline stages (batch jobs)
+    # =========================================================================
+    #
+    # process() for a plain full-resolution request, cut at its stage
+    # boundaries so the engine can decode job N+1, filter N and encode N-1
+    # on different threads. Each stage returns (value, None) or
+    # (None, error) and consumes what it is given.
+
+    def stage_decode(self, input_path):
+        """Validated input as a pooled frame (native codecs) or an RGB/RGBA image."""
+        if not PIL_AVAILABLE:
+            return None, "Pillow not available: {}".format(PIL_ERROR)
+
+        valid, err = self._validate_input(input_path)
+        if not valid:
+            return None, err
+
+        img = None
+        try:
+            if NATIVE_AVAILABLE:
+                decoded = self._decode_native(input_path, None)
+                if decoded is not None:
+                    return decoded[0], None
+            img = Image.open(input_path)
+            img.load()
+            img = self._normalize_mode(img)
+            source, img = img, None
+            return source, None
+        except Exception as e:
+            return None, "Processing failed: {}".format(str(e))
+        finally:
+            if img is not None:
+                img.close()
+
+    def stage_filter(self, input_path, source, sharpness, contrast, overlay):
+        """Filter chain (and overlay) on stage_decode()'s output; returns an RGB image."""
+        try:
+            context = {"input_path": input_path}
+            if NATIVE_AVAILABLE and isinstance(source, planter_native.Frame):
+                img = self._enhance_frame(source, sharpness, contrast, context)
+            else:
+                img = self._apply_filters(source, sharpness, contrast, context)
+        except Exception as e:
+            return None, "Processing failed: {}".format(str(e))
+
+        try:
+            if overlay:
+                self._draw_overlay(img)
+        except Exception as e:
+            img.close()
+            return None, "Processing failed: {}".format(str(e))
+        return img, None
+
+    def stage_encode(self, img, input_path, output_dir):
+        """Write stage_filter()'s image; returns the output path."""
+        try:
+            output_path = self._generate_output_path(input_path, output_dir)
+            img.save(output_path, format='PNG', optimize=True)
+            return output_path, None
+        except Exception as e:
+            return None, "Processing failed: {}".format(str(e))
+        finally:
+            img.close()
+
+
 # Global instance
 _processor = None
 
@@ -243,7 +942,15 @@ def process_image_json(input_json):
     Entry point for C++ engine.
 
     Input:  {"input_image_path": "C:/path/to/image.png"}
+            optional: "output_dir", "sharpness", "contrast", "overlay",
+                      "preview": {"max_dim": 512, "follow_up": false},
+                      "roi": [x, y, w, h], "pyramid": false,
+                      "siblings": {"thumbnail": 256, "display": 1920},
+                      "ops": [{"op": "denoise", "strength": 0.8}],
+                      "variants": [{"name": "soft", "sharpness": 1.0, ...}]
     Output: {"status": "success", "output_image_path": "C:/path/output.png"}
+
+    "follow_up" is handled by the engine (queues the full-resolution job).
     """
     try:
         data = json.loads(input_json)
@@ -256,12 +963,165 @@ def process_image_json(input_json):
 
     output_dir = data.get("output_dir")
 
+    preview = data.get("preview")
+    preview_max_dim = None
+    if preview is not None:
+        try:
+            preview_max_dim = int(preview.get("max_dim", 0))
+        except (AttributeError, TypeError, ValueError):
+            return json.dumps({"status": "error", "error": "Invalid preview options"})
+        if preview_max_dim <= 0:
+            return json.dumps({"status": "error", "error": "preview.max_dim must be positive"})
+
+    roi = data.get("roi")
+    if roi is not None:
+        try:
+            roi = [int(v) for v in roi]
+        except (TypeError, ValueError):
+            return json.dumps({"status": "error", "error": "Invalid roi"})
+        if len(roi) != 4 or roi[2] <= 0 or roi[3] <= 0:
+            return json.dumps({"status": "error", "error": "roi must be [x, y, w, h] with w, h > 0"})
+
+    siblings = data.get("siblings")
+    if siblings is not None:
+        try:
+            siblings = {str(name): int(max_dim) for name, max_dim in siblings.items()}
+        except (AttributeError, TypeError, ValueError):
+            return json.dumps({"status": "error", "error": "Invalid siblings"})
+        for name, max_dim in siblings.items():
+            if not SIBLING_NAME.match(name) or max_dim <= 0:
+                return json.dumps({"status": "error",
+                                   "error": "Invalid sibling {!r}: {}".format(name, max_dim)})
+
+    ops = data.get("ops")
+    if ops is not None:
+        if not _valid_ops(ops):
+            return json.dumps({"status": "error",
+                               "error": "ops must be a list of {\"op\": name, ...} objects"})
+
+    variants = data.get("variants")
+    if variants is not None:
+        variants, err = _parse_variants(variants, data)
+        if err:
+            return json.dumps({"status": "error", "error": err})
+
     processor = get_processor()
-    result = processor.process(input_path, output_dir)
+    result = processor.process(
+        input_path,
+        output_dir,
+        sharpness=float(data.get("sharpness", 1.5)),
+        contrast=float(data.get("contrast", 1.2)),
+        overlay=bool(data.get("overlay", True)),
+        preview_max_dim=preview_max_dim,
+        roi=roi,
+        pyramid=bool(data.get("pyramid", False)),
+        siblings=siblings,
+        ops=ops,
+        variants=variants,
+    )
 
     return json.dumps(result)
 
 
+def _valid_ops(ops):
+    return isinstance(ops, list) and all(
+        isinstance(op, dict) and isinstance(op.get("op"), str) for op in ops)
+
+
+def _parse_variants(variants, data):
+    """
+    Normalise the "variants" list; unset settings default to the top-level
+    ones. Returns (variants, None) or (None, error).
+    """
+    if not isinstance(variants, list) or not 0 < len(variants) <= MAX_VARIANTS:
+        return None, "variants must be a list of 1 to {} objects".format(MAX_VARIANTS)
+
+    parsed = []
+    for variant in variants:
+        if not isinstance(variant, dict):
+            return None, "variants must be a list of 1 to {} objects".format(MAX_VARIANTS)
+        name = variant.get("name")
+        if not isinstance(name, str) or not SIBLING_NAME.match(name):
+            return None, "Invalid variant name: {!r}".format(name)
+        if any(name == other["name"] for other in parsed):
+            return None, "Duplicate variant name: {}".format(name)
+        ops = variant.get("ops", data.get("ops", []))
+        if not _valid_ops(ops):
+            return None, "Variant {}: ops must be a list of {{\"op\": name, ...}} objects".format(name)
+        try:
+            parsed.append({
+                "name": name,
+                "sharpness": float(variant.get("sharpness", data.get("sharpness", 1.5))),
+                "contrast": float(variant.get("contrast", data.get("contrast", 1.2))),
+                "overlay": bool(variant.get("overlay", data.get("overlay", True))),
+                "ops": ops,
+            })
+        except (TypeError, ValueError):
+            return None, "Invalid settings for variant {}".format(name)
+    return parsed, None
+
+
+# Stage order shared with the binary ABI (EngineResult.stage_ms)
+STAGES = ("decode", "filter", "overlay", "encode")
+
+
+def process_image_tuple(input_path, output_dir, sharpness, contrast, overlay):
+    """
+    Entry point for the engine's binary ABI (process_image_binary).
+    Skips JSON entirely; the engine unpacks the tuple into EngineResult.
+
+    Output: (ok, output_path, (orig_w, orig_h), original_mode,
+             (out_w, out_h), output_size_bytes, stage_ms_tuple, error)
+    """
+    result = get_processor().process(input_path, output_dir, sharpness, contrast, overlay)
+    return _result_tuple(result)
+
+
+def process_image_frame(input_path, output_dir, sharpness, contrast, overlay, encode):
+    """
+    Entry point for process_image_pixels: the process_image_tuple result
+    plus the final pixels as a pooled frame, which the engine takes over
+    and hands to the caller without copying.
+
+    Output: (result_tuple, frame_or_None)
+    """
+    result = get_processor().process(input_path, output_dir, sharpness, contrast, overlay,
+                                     keep_frame=True, encode=encode)
+    return _result_tuple(result), result.pop("frame", None)
+
+
+def batch_decode(input_path):
+    """Pipelined batch entry points (engine job stages); see ImageProcessor.stage_*."""
+    return get_processor().stage_decode(input_path)
+
+
+def batch_filter(input_path, source, sharpness, contrast, overlay):
+    return get_processor().stage_filter(input_path, source, sharpness, contrast, overlay)
+
+
+def batch_encode(img, input_path, output_dir):
+    return get_processor().stage_encode(img, input_path, output_dir)
+
+
+def _result_tuple(result):
+    """Flatten a process() result dict into the process_image_tuple shape."""
+    if result.get("status") != "success":
+        return (False, "", (0, 0), "", (0, 0), 0, (0.0,) * len(STAGES), result.get("error", ""))
+
+    meta = result["metadata"]
+    timings = meta["timings_ms"]
+    return (
+        True,
+        result["output_image_path"],
+        tuple(meta["original_size"]),
+        meta["original_mode"],
+        tuple(meta["output_dimensions"]),
+        meta["output_size_bytes"],
+        tuple(timings[name] for name in STAGES),
+        "",
+    )
+
+
 if __name__ == "__main__":
     import argparse
     parser = argparse.ArgumentParser()